@@ -16,6 +16,7 @@
 #define INC_HYLAND_DOCUMENTFILTERSOBJECTS_H
 
 #include "DocumentFilters.h"
+#include <array>
 #include <chrono>
 #include <fstream>
 #include <functional>
@@ -24,8 +25,10 @@
 #include <optional>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <thread>
 #include <type_traits>
 
 namespace Hyland
@@ -76,6 +79,8 @@ namespace Hyland
 		class CompareResultDifferenceDetail;
 		class CompareResultDifference;
 		class DateTime;
+		class Metadata;
+		class DocumentFilters;
 		class Extractor;
 		class FormElement;
 		class Hyperlink;
@@ -85,12 +90,16 @@ namespace Hyland
 		class OcrStyleInfo;
 		class Page;
 		class PageElement;
+		class PageElementTree;
 		class PagePixels;
 		class Point;
+		class Registry;
 		class RenderPageProperties;
 		class Stream;
 		class Subfile;
 		class Word;
+		class WordTable;
+		class WordIndex;
 		struct Color;
 		struct AnnoBind;
 		class JsonWriter;
@@ -280,6 +289,48 @@ namespace Hyland
 			return lhs;
 		}
 
+		/// @brief A non-owning view of a contiguous array, standing in for std::span, which C++17 does not have.
+		/// @tparam T The type of the elements, const-qualified for a read-only view.
+		template <typename T>
+		class span_t
+		{
+		public:
+			typedef T value_type; ///< The type of the elements.
+			typedef T* iterator; ///< Iterator over the elements.
+
+			/// @brief Constructs an empty view.
+			span_t() = default;
+
+			/// @brief Constructs a view of an array.
+			/// @param data The first element.
+			/// @param size The number of elements.
+			span_t(T* data, size_t size) : m_data(data), m_size(size) {}
+
+			/// @brief Gets the first element. @return The pointer to the first element.
+			T* data() const { return m_data; }
+
+			/// @brief Gets the number of elements. @return The number of elements.
+			size_t size() const { return m_size; }
+
+			/// @brief Checks whether the view is empty. @return True if there are no elements.
+			bool empty() const { return m_size == 0; }
+
+			/// @brief Accesses an element without bounds checking.
+			/// @param index The index of the element.
+			/// @return A reference to the element.
+			T& operator[](size_t index) const { return m_data[index]; }
+
+			/// @brief Gets an iterator to the first element. @return The iterator.
+			iterator begin() const { return m_data; }
+
+			/// @brief Gets an iterator past the last element. @return The iterator.
+			iterator end() const { return m_data + m_size; }
+
+		private:
+			T* m_data = nullptr;
+			size_t m_size = 0;
+		};
+
 		/// @brief A class that provides lazy loading of elements by index.
 		/// @tparam T The type of elements to be loaded.
 		template <typename T>
@@ -536,6 +587,25 @@ namespace Hyland
 			ClassicHtml,  ///< Open the document in classic HTML mode.
 		};
 
+		/// @brief Enum representing how files given by name are read by the extractor.
+		enum class FileAccess
+		{
+			Default,      ///< The engine opens and reads the file itself.
+			/// The file is memory-mapped and the engine reads the mapping directly. See MappedFileStream.
+			/// The file must not be truncated while it is open: touching a mapped page past the new end of the file
+			/// raises SIGBUS (or an in-page exception on Windows) and ends the process. Use Default for files that
+			/// other processes may rewrite.
+			MemoryMapped,
+		};
+
+		/// @brief Describes how a file is expected to be accessed, passed on to the operating system.
+		enum class FileAccessHint
+		{
+			Normal,     ///< No particular access pattern.
+			Random,     ///< Reads at scattered offsets; read-ahead is reduced.
+			Sequential, ///< Reads from front to back; read-ahead is increased.
+		};
+
 		/// @brief Enum representing the type of canvas used for rendering.
 		enum class CanvasType
 		{
@@ -587,9 +657,35 @@ namespace Hyland
 		/// @brief Enum representing flags for pixel properties.
 		enum class PixelsFlags
 		{
+			None = 0,                                        ///< Top-down, and minimum value is white where it matters.
 			MinIsBlack = IGR_OPEN_BITMAP_FLAGS_MIN_IS_BLACK, ///< Minimum value is black.
 			BottomUp = IGR_OPEN_BITMAP_FLAGS_BOTTOM_UP       ///< Bitmap is stored bottom-up.
 		};
+		template<> struct EnableBitMaskOperators<PixelsFlags> { static const bool enable = true; };
+
+		/// @brief A raw bitmap in caller-owned memory, opened as a document by DocumentFilters::OpenExtractor.
+		///
+		/// The pixels are handed to the engine as they are, without being copied or encoded. They must stay valid
+		/// and unchanged for as long as the extractor, or any page or subfile obtained from it, is in use. Set owner
+		/// to have the extractor keep the memory alive itself; it is released when the last copy of the extractor is
+		/// destroyed. owner only covers the pixels: the palette must be kept alive by the caller, or live in the
+		/// memory owner holds.
+		struct PixelBufferView
+		{
+			const void* pixels = nullptr;                ///< The first byte of the first scanline.
+			size_t size = 0;                             ///< The size of the buffer in bytes; at least stride * height.
+			uint32_t width = 0;                          ///< The width of the bitmap, in pixels.
+			uint32_t height = 0;                         ///< The height of the bitmap, in pixels.
+			uint32_t stride = 0;                         ///< The number of bytes from one scanline to the next; at least a full row of pixels.
+			PixelType type = PixelType::PixelDefault;    ///< The layout of each pixel.
+			PixelsFlags flags = PixelsFlags::None;       ///< How the scanlines and values are to be read.
+			const IGR_LONG* palette = nullptr;           ///< The palette of an indexed bitmap, or nullptr.
+			uint32_t palette_count = 0;                  ///< The number of entries in the palette.
+			uint32_t dpi_x = 0;                          ///< The horizontal resolution; 0 if unknown.
+			uint32_t dpi_y = 0;                          ///< The vertical resolution; 0 if unknown.
+			uint32_t orientation = IGR_OPEN_BITMAP_ORIENTATION_TOPLEFT; ///< An IGR_OPEN_BITMAP_ORIENTATION value.
+			std::shared_ptr<const void> owner;           ///< Optional owner of the pixels, kept alive by the extractor. Does not cover palette.
+		};
 
 		/// @brief Template class representing a rectangle with various utility functions.
 		/// @tparam RectType The type of the rectangle.
@@ -808,6 +904,110 @@ namespace Hyland
 			static std::chrono::system_clock::time_point from_filetime(IGR_ULONGLONG value);
 		};
 
+		/// @brief A document property, kept as the text the engine reported along with the value it parses as.
+		class MetadataValue
+		{
+		public:
+			/// @brief Enum representing the kind of value a property holds.
+			enum class Type
+			{
+				Text,    ///< Text that is not a number or a date.
+				Integer, ///< A whole number.
+				Number,  ///< A number with a fraction or an exponent.
+				Date,    ///< A date in the engine's "Fri, 01 Jan 2021 10:00:00 GMT" form.
+			};
+
+			/// @brief Constructs a value from the engine's text, parsing it as an integer, a number or a date.
+			/// @param text The text of the value.
+			explicit MetadataValue(const std::wstring& text);
+
+			/// @brief Gets the kind of value the text parsed as.
+			/// @return The type of the value.
+			Type getType() const { return m_type; }
+
+			/// @brief Gets the text of the value as the engine reported it.
+			/// @return The text as a wide string.
+			const std::wstring& getText() const { return m_text; }
+
+			/// @brief Gets the value as a whole number.
+			/// @return The value, or an empty optional if the type is not Integer.
+			std::optional<int64_t> getInteger() const;
+
+			/// @brief Gets the value as a number.
+			/// @return The value, or an empty optional if the type is neither Integer nor Number.
+			std::optional<double> getNumber() const;
+
+			/// @brief Gets the value as a date.
+			/// @return The value, or an empty optional if the type is not Date.
+			std::optional<DateTime> getDate() const;
+
+		private:
+			std::wstring m_text; ///< The text of the value.
+			Type m_type = Type::Text; ///< The kind of value the text parsed as.
+			int64_t m_integer = 0; ///< The value when the type is Integer.
+			double m_number = 0; ///< The value when the type is Integer or Number.
+			DateTime m_date; ///< The value when the type is Date.
+		};
+
+		/// @brief The properties of a document, as returned by Extractor::getMetadata, sorted by name.
+		///
+		/// Property names are interned: each distinct name is stored once for the life of the process and the
+		/// entries refer to it, so harvesting many documents does not allocate the same names over and over.
+		/// The pool never shrinks, so documents with many distinct, made-up property names grow it for good.
+		class Metadata
+		{
+		public:
+			/// @brief A property name and its value.
+			using entry_t = std::pair<std::wstring_view, MetadataValue>;
+
+			/// @brief Iterator over the properties in name order.
+			using const_iterator = std::vector<entry_t>::const_iterator;
+
+			/// @brief Constructs an empty set of properties.
+			Metadata() = default;
+
+			/// @brief Parses a metadata block in the engine's "Name: Value" form, one property per paragraph.
+			/// Start and end of metadata markers are skipped. When a name repeats, the last value is kept.
+			/// @param text The metadata block.
+			/// @return The parsed properties.
+			static Metadata Parse(const std::wstring& text);
+
+			/// @brief Parses a metadata block in the engine's "Name: Value" form, one property per paragraph.
+			/// @param text The metadata block as UTF-16.
+			/// @param length The length of the block in code units.
+			/// @return The parsed properties.
+			static Metadata Parse(const char16_t* text, size_t length);
+
+			/// @brief Finds a property by name. Names are matched exactly.
+			/// @param name The name of the property.
+			/// @return The value, or nullptr if the document does not have the property.
+			const MetadataValue* find(std::wstring_view name) const;
+
+			/// @brief Checks whether the document has a property.
+			/// @param name The name of the property.
+			/// @return True if the property is present.
+			bool contains(std::wstring_view name) const { return find(name) != nullptr; }
+
+			/// @brief Gets the number of properties.
+			/// @return The number of properties.
+			size_t size() const { return m_entries.size(); }
+
+			/// @brief Checks whether there are no properties.
+			/// @return True if there are no properties.
+			bool empty() const { return m_entries.empty(); }
+
+			/// @brief Gets an iterator to the first property.
+			/// @return The iterator.
+			const_iterator begin() const { return m_entries.begin(); }
+
+			/// @brief Gets an iterator past the last property.
+			/// @return The iterator.
+			const_iterator end() const { return m_entries.end(); }
+
+		private:
+			std::vector<entry_t> m_entries; ///< The properties, sorted by name.
+		};
+
 		/// @brief Represents a point in 2D space.
 		class Point
 		{
@@ -843,6 +1043,273 @@ namespace Hyland
 		};
 
 
+		/// @brief Describes a failed call without throwing: the return code, the engine's error text and the function
+		/// that failed.
+		///
+		/// Capturing a failure only copies the engine's fixed-size message; the text DocumentFilters::Error would carry
+		/// is formatted when message() is called.
+		class ErrorInfo
+		{
+		private:
+			IGR_RETURN_CODE m_code = IGR_OK; ///< The error return code.
+			const char* m_function = nullptr; ///< The name of the failed function; must outlive the ErrorInfo, usually a literal.
+			std::array<char, sizeof(Error_Control_Block::Msg)> m_detail = {}; ///< The engine's message, if any.
+
+		public:
+			/// @brief Constructs an empty ErrorInfo, with a return code of IGR_OK.
+			ErrorInfo() = default;
+
+			/// @brief Captures a failed engine call.
+			/// @param code The return code of the call.
+			/// @param ecb The error control block the call filled in.
+			/// @param function The name of the function that failed, kept by pointer.
+			ErrorInfo(IGR_RETURN_CODE code, const Error_Control_Block& ecb, const char* function = nullptr);
+
+			/// @brief Captures a failure with a message of its own.
+			/// @param code The return code.
+			/// @param detail The message, truncated to the size of an Error_Control_Block message.
+			/// @param function The name of the function that failed, kept by pointer.
+			ErrorInfo(IGR_RETURN_CODE code, const char* detail, const char* function = nullptr);
+
+			/// @brief Retrieves the return code associated with the error.
+			/// @return The return code.
+			IGR_RETURN_CODE code() const { return m_code; }
+
+			/// @brief Retrieves the name of the function that failed.
+			/// @return The function name, or an empty string.
+			const char* function() const { return m_function != nullptr ? m_function : ""; }
+
+			/// @brief Retrieves the engine's error text, without the function name.
+			/// @return The error text, or an empty string.
+			const char* detail() const { return m_detail.data(); }
+
+			/// @brief Formats the message DocumentFilters::Error would carry for this failure.
+			/// @return The formatted message.
+			std::string message() const;
+
+			/// @brief Throws the failure as a DocumentFilters::Error.
+			[[noreturn]] void raise() const;
+		};
+
+		/// @brief Holds either the value of a successful call or the ErrorInfo of a failed one.
+		///
+		/// Returned by the Try* members, which report failures of the engine this way instead of throwing. value()
+		/// throws the failure as a DocumentFilters::Error, which is how the throwing members are built on them.
+		///
+		/// @tparam T The type of the value.
+		template <typename T>
+		class Result
+		{
+		private:
+			std::optional<T> m_value;
+			ErrorInfo m_error;
+
+		public:
+			/// @brief Constructs a successful result.
+			/// @param value The value.
+			Result(T value) : m_value(std::move(value)) {}
+
+			/// @brief Constructs a failed result.
+			/// @param error The failure.
+			Result(const ErrorInfo& error) : m_error(error) {}
+
+			/// @brief Checks whether the call succeeded.
+			/// @return true if the result holds a value.
+			bool has_value() const { return m_value.has_value(); }
+
+			/// @brief Checks whether the call succeeded.
+			explicit operator bool() const { return has_value(); }
+
+			/// @brief Retrieves the value.
+			/// @return The value.
+			/// @throws DocumentFilters::Error if the call failed.
+			T& value() & { if (!m_value) m_error.raise(); return *m_value; }
+			const T& value() const& { if (!m_value) m_error.raise(); return *m_value; }
+			T&& value() && { if (!m_value) m_error.raise(); return std::move(*m_value); }
+
+			/// @brief Retrieves the value, or a fallback if the call failed.
+			/// @param fallback The value to return on failure.
+			/// @return The value or the fallback.
+			template <typename U>
+			T value_or(U&& fallback) const& { return m_value.has_value() ? *m_value : static_cast<T>(std::forward<U>(fallback)); }
+
+			/// @brief Accesses the value; the call must have succeeded.
+			T& operator*() { return *m_value; }
+			const T& operator*() const { return *m_value; }
+			T* operator->() { return &*m_value; }
+			const T* operator->() const { return &*m_value; }
+
+			/// @brief Retrieves the failure.
+			/// @return The failure, with a code of IGR_OK if the call succeeded.
+			const ErrorInfo& error() const { return m_error; }
+		};
+
+		/// @brief Holds the outcome of a call that has no value.
+		template <>
+		class Result<void>
+		{
+		private:
+			bool m_ok = true;
+			ErrorInfo m_error;
+
+		public:
+			/// @brief Constructs a successful result.
+			Result() = default;
+
+			/// @brief Constructs a failed result.
+			/// @param error The failure.
+			Result(const ErrorInfo& error) : m_ok(false), m_error(error) {}
+
+			/// @brief Checks whether the call succeeded.
+			/// @return true if the call succeeded.
+			bool has_value() const { return m_ok; }
+
+			/// @brief Checks whether the call succeeded.
+			explicit operator bool() const { return m_ok; }
+
+			/// @brief Does nothing if the call succeeded.
+			/// @throws DocumentFilters::Error if the call failed.
+			void value() const { if (!m_ok) m_error.raise(); }
+
+			/// @brief Retrieves the failure.
+			/// @return The failure, with a code of IGR_OK if the call succeeded.
+			const ErrorInfo& error() const { return m_error; }
+		};
+
+		/// @brief A reusable set of open and render options, kept in the UCS-2 form the engine takes.
+		///
+		/// The entry points that take an options string convert it on every call. An OptionSet is encoded once when
+		/// it is changed, so a profile built at startup costs nothing per document. Names are matched without regard
+		/// to case and keep the order they were first set in; setting a name again replaces its value.
+		///
+		/// A const OptionSet can be shared between threads.
+		class OptionSet
+		{
+		public:
+			typedef std::pair<std::wstring, std::wstring> entry_t;
+
+			/// @brief Constructs an empty option set.
+			OptionSet() = default;
+
+			/// @brief Constructs an option set from name and value pairs.
+			/// @param options The options, applied in order.
+			/// @throws std::invalid_argument if a name is empty or contains '=' or ';', or a value contains ';'.
+			OptionSet(std::initializer_list<entry_t> options);
+
+			/// @brief Parses an options string of the form "NAME=value;NAME=value".
+			/// @param options The options string. Empty entries are skipped and spaces around names are trimmed.
+			/// @throws std::invalid_argument if an entry has no name.
+			explicit OptionSet(const std::wstring& options);
+
+			/// @brief Sets an option, replacing any earlier value.
+			/// @param name The name of the option.
+			/// @param value The value of the option.
+			/// @return A reference to this option set.
+			/// @throws std::invalid_argument if the name is empty or contains '=' or ';', or the value contains ';'.
+			OptionSet& set(const std::wstring& name, const std::wstring& value);
+
+			/// @brief Sets an option, replacing any earlier value.
+			/// @param name The name of the option.
+			/// @param value The value of the option.
+			/// @return A reference to this option set.
+			OptionSet& set(const std::wstring& name, const wchar_t* value) { return set(name, std::wstring(value)); }
+
+			/// @brief Sets an option from a UTF-8 value, replacing any earlier value.
+			/// @param name The name of the option.
+			/// @param value The value of the option, in UTF-8.
+			/// @return A reference to this option set.
+			OptionSet& set(const std::wstring& name, const char* value) { return set(name, u8_to_w(value)); }
+
+			/// @brief Sets an on/off option, replacing any earlier value.
+			/// @param name The name of the option.
+			/// @param value true for "on", false for "off".
+			/// @return A reference to this option set.
+			OptionSet& set(const std::wstring& name, bool value) { return set(name, std::wstring(value ? L"on" : L"off")); }
+
+			/// @brief Sets a numeric option, replacing any earlier value.
+			/// @param name The name of the option.
+			/// @param value The value of the option.
+			/// @return A reference to this option set.
+			OptionSet& set(const std::wstring& name, int value) { return set(name, std::to_wstring(value)); }
+
+			/// @brief Removes an option.
+			/// @param name The name of the option.
+			/// @return A reference to this option set.
+			OptionSet& erase(const std::wstring& name);
+
+			/// @brief Copies every option of another set into this one; the other set's values win.
+			/// @param other The options to merge in.
+			/// @return A reference to this option set.
+			OptionSet& merge(const OptionSet& other);
+
+			/// @brief Returns a copy of this set with another merged into it.
+			/// @param other The options to merge in; its values win.
+			/// @return The merged option set.
+			OptionSet merged(const OptionSet& other) const { OptionSet result(*this); result.merge(other); return result; }
+
+			/// @brief Looks up the value of an option.
+			/// @param name The name of the option.
+			/// @return The value, or nothing if the option is not set.
+			std::optional<std::wstring> get(const std::wstring& name) const;
+
+			/// @brief Checks whether an option is set.
+			/// @param name The name of the option.
+			/// @return true if the option is set.
+			bool contains(const std::wstring& name) const { return find(name) != m_entries.end(); }
+
+			/// @brief Returns the options in the order they were first set.
+			/// @return The name and value pairs.
+			const std::vector<entry_t>& entries() const { return m_entries; }
+
+			/// @brief Returns the number of options.
+			/// @return The number of options.
+			size_t size() const { return m_entries.size(); }
+
+			/// @brief Checks whether the set is empty.
+			/// @return true if no options are set.
+			bool empty() const { return m_entries.empty(); }
+
+			/// @brief Formats the options as a "NAME=value;NAME=value" string.
+			/// @return The options string.
+			std::wstring str() const;
+
+			/// @brief Returns the options in the UCS-2 form passed to the engine.
+			/// @return The encoded options, valid until the set is next changed.
+			const IGR_UCS2* data() const { return reinterpret_cast<const IGR_UCS2*>(m_encoded.c_str()); }
+
+			/// @brief Checks that every option is one the engine knows.
+			/// @param available The options the engine supports, as returned by DocumentFilters::getOptions().
+			/// @throws std::invalid_argument naming the first unknown option.
+			void validate(const std::vector<Option>& available) const;
+
+			/// @brief Checks that every option is one the engine knows.
+			/// @param api The initialized Document Filters instance to check against.
+			/// @throws std::invalid_argument naming the first unknown option.
+			void validate(const DocumentFilters& api) const;
+
+		private:
+			std::vector<entry_t>::const_iterator find(const std::wstring& name) const;
+			void encode();
+
+			std::vector<entry_t> m_entries; ///< The options in the order they were first set.
+			std::u16string m_encoded; ///< The options string in UCS-2, rebuilt whenever the set changes.
+		};
+
+		/// @brief A file-to-file conversion for DocumentFilters::ConvertFiles.
+		struct ConvertJob
+		{
+			std::wstring source;      ///< The document to convert.
+			std::wstring destination; ///< The file to write the output to.
+		};
+
+		/// @brief The outcome of one ConvertJob.
+		struct ConvertJobResult
+		{
+			Result<void> status;                 ///< The outcome of the conversion.
+			std::chrono::nanoseconds elapsed{};  ///< The wall-clock time from when a worker picked up the job until the conversion returned.
+			size_t worker = 0;                   ///< The index of the worker thread that ran the job.
+		};
+
 		/// @brief The `DocumentFilters` class provides functionality for managing document filters, initializing with licenses and paths, and retrieving or opening extractors for various data sources.
 		class DocumentFilters
 		{
@@ -909,6 +1376,20 @@ namespace Hyland
 			/// @return An extractor object for the specified file.
 			Extractor GetExtractor(const std::wstring& filename);
 
+			/// @brief Retrieves an extractor for the specified file using a specific file access method.
+			/// @param filename The name of the file as a string.
+			/// @param access The method used to read the file.
+			/// @param hint The expected access pattern, used with FileAccess::MemoryMapped.
+			/// @return An extractor object for the specified file.
+			Extractor GetExtractor(const std::string& filename, FileAccess access, FileAccessHint hint = FileAccessHint::Random);
+
+			/// @brief Retrieves an extractor for the specified file using a specific file access method.
+			/// @param filename The name of the file as a wide string.
+			/// @param access The method used to read the file.
+			/// @param hint The expected access pattern, used with FileAccess::MemoryMapped.
+			/// @return An extractor object for the specified file.
+			Extractor GetExtractor(const std::wstring& filename, FileAccess access, FileAccessHint hint = FileAccessHint::Random);
+
 			/// @brief Retrieves an extractor for the specified data.
 			/// @param data Pointer to the data.
 			/// @param size Size of the data.
@@ -916,6 +1397,11 @@ namespace Hyland
 			/// @return An extractor object for the specified data.
 			Extractor GetExtractor(const void* data, size_t size, memory_destruct_t deleter = nullptr);
 
+			/// @brief Retrieves an extractor over a raw bitmap, without copying the pixels.
+			/// @param bitmap The bitmap. See PixelBufferView for how long the pixels must stay valid.
+			/// @return An extractor object for the bitmap.
+			Extractor GetExtractor(const PixelBufferView& bitmap);
+
 			/// @brief Retrieves an extractor for the specified stream.
 			/// @param stream Pointer to the IGR_Stream object.
 			/// @return An extractor object for the specified stream.
@@ -939,11 +1425,23 @@ namespace Hyland
 			Extractor GetExtractor(FILE* file, bool own_file);
 
 			/// @brief Retrieves an extractor for the specified stream.
+			///
+			/// The stream is not owned and must outlive the extractor. If it provides a memory view (see
+			/// Stream::get_memory_view), as MemStream and VectorStream do, the engine reads that
+			/// memory directly rather than through the stream, so the stream's contents must not be written,
+			/// resized or released until the extractor is destroyed. Pass ownership with GetExtractor(Stream*, bool)
+			/// to have the extractor keep the stream alive instead.
+			///
 			/// @param stream Reference to the stream object.
 			/// @return An extractor object for the specified stream.
 			Extractor GetExtractor(Stream& stream);
 
 			/// @brief Retrieves an extractor for the specified stream.
+			///
+			/// A stream that provides a memory view is read directly by the engine, as for GetExtractor(Stream&).
+			/// When own_stream is false the same requirements apply: the stream must outlive the extractor and its
+			/// contents must not change until then.
+			///
 			/// @param stream Pointer to the stream object.
 			/// @param own_stream Boolean indicating ownership of the stream.
 			/// @return An extractor object for the specified stream.
@@ -958,6 +1456,15 @@ namespace Hyland
 			/// @return An extractor object for the specified file.
 			Extractor OpenExtractor(const std::string& filename, OpenMode mode, int open_flags = 0, const std::wstring& options = std::wstring(), const open_callback_t& callback = nullptr);
 
+			/// @brief Opens an extractor for the specified file.
+			/// @param filename The name of the file as a string.
+			/// @param mode The mode in which to open the file.
+			/// @param open_flags Flags for opening the file.
+			/// @param options The options to open with.
+			/// @param callback Optional callback function. Defaults to nullptr.
+			/// @return An extractor object for the specified file.
+			Extractor OpenExtractor(const std::string& filename, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback = nullptr);
+
 			/// @brief Opens an extractor for the specified file.
 			/// @param filename The name of the file as a wide string.
 			/// @param mode The mode in which to open the file.
@@ -967,6 +1474,33 @@ namespace Hyland
 			/// @return An extractor object for the specified file.
 			Extractor OpenExtractor(const std::wstring& filename, OpenMode mode, int open_flags = 0, const std::wstring& options = std::wstring(), const open_callback_t& callback = nullptr);
 
+			/// @brief Opens an extractor for the specified file.
+			/// @param filename The name of the file as a wide string.
+			/// @param mode The mode in which to open the file.
+			/// @param open_flags Flags for opening the file.
+			/// @param options The options to open with.
+			/// @param callback Optional callback function. Defaults to nullptr.
+			/// @return An extractor object for the specified file.
+			Extractor OpenExtractor(const std::wstring& filename, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback = nullptr);
+
+			/// @brief Opens an extractor over a raw bitmap, handing the caller's pixels to the engine without
+			/// copying or encoding them. See PixelBufferView for how long the pixels must stay valid.
+			/// @param bitmap The bitmap.
+			/// @param mode The mode in which to open the bitmap.
+			/// @param open_flags Optional flags for opening the bitmap. Defaults to 0.
+			/// @param options Optional additional options as a wide string. Defaults to an empty string.
+			/// @return An extractor object for the bitmap.
+			Extractor OpenExtractor(const PixelBufferView& bitmap, OpenMode mode, int open_flags = 0, const std::wstring& options = std::wstring());
+
+			/// @brief Opens an extractor over a raw bitmap, handing the caller's pixels to the engine without
+			/// copying or encoding them. See PixelBufferView for how long the pixels must stay valid.
+			/// @param bitmap The bitmap.
+			/// @param mode The mode in which to open the bitmap.
+			/// @param open_flags Flags for opening the bitmap.
+			/// @param options The options to open with.
+			/// @return An extractor object for the bitmap.
+			Extractor OpenExtractor(const PixelBufferView& bitmap, OpenMode mode, int open_flags, const OptionSet& options);
+
 			/// @brief Opens an extractor for the specified data.
 			/// @param data Pointer to the data.
 			/// @param size Size of the data.
@@ -978,6 +1512,17 @@ namespace Hyland
 			/// @return An extractor object for the specified data.
 			Extractor OpenExtractor(const void* data, size_t size, memory_destruct_t deleter, OpenMode mode, int open_flags = 0, const std::wstring& options = std::wstring(), const open_callback_t& callback = nullptr);
 
+			/// @brief Opens an extractor for the specified data.
+			/// @param data Pointer to the data.
+			/// @param size Size of the data.
+			/// @param deleter Function to delete the data.
+			/// @param mode The mode in which to open the data.
+			/// @param open_flags Flags for opening the data.
+			/// @param options The options to open with.
+			/// @param callback Optional callback function. Defaults to nullptr.
+			/// @return An extractor object for the specified data.
+			Extractor OpenExtractor(const void* data, size_t size, memory_destruct_t deleter, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback = nullptr);
+
 			/// @brief Opens an extractor for the specified stream.
 			/// @param stream Pointer to the IGR_Stream object.
 			/// @param mode The mode in which to open the stream.
@@ -987,6 +1532,15 @@ namespace Hyland
 			/// @return An extractor object for the specified stream.
 			Extractor OpenExtractor(IGR_Stream* stream, OpenMode mode, int open_flags = 0, const std::wstring& options = std::wstring(), const open_callback_t& callback = nullptr);
 
+			/// @brief Opens an extractor for the specified stream.
+			/// @param stream Pointer to the IGR_Stream object.
+			/// @param mode The mode in which to open the stream.
+			/// @param open_flags Flags for opening the stream.
+			/// @param options The options to open with.
+			/// @param callback Optional callback function. Defaults to nullptr.
+			/// @return An extractor object for the specified stream.
+			Extractor OpenExtractor(IGR_Stream* stream, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback = nullptr);
+
 			/// @brief Opens an extractor for the specified input stream.
 			/// @param stream Reference to the input stream.
 			/// @param mode The mode in which to open the stream.
@@ -996,6 +1550,15 @@ namespace Hyland
 			/// @return An extractor object for the specified input stream.
 			Extractor OpenExtractor(std::istream& stream, OpenMode mode, int open_flags = 0, const std::wstring& options = std::wstring(), const open_callback_t& callback = nullptr);
 
+			/// @brief Opens an extractor for the specified input stream.
+			/// @param stream Reference to the input stream.
+			/// @param mode The mode in which to open the stream.
+			/// @param open_flags Flags for opening the stream.
+			/// @param options The options to open with.
+			/// @param callback Optional callback function. Defaults to nullptr.
+			/// @return An extractor object for the specified input stream.
+			Extractor OpenExtractor(std::istream& stream, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback = nullptr);
+
 			/// @brief Opens an extractor for the specified input stream.
 			/// @param stream Pointer to the input stream.
 			/// @param own_stream Boolean indicating ownership of the stream.
@@ -1006,6 +1569,16 @@ namespace Hyland
 			/// @return An extractor object for the specified input stream.
 			Extractor OpenExtractor(std::istream* stream, bool own_stream, OpenMode mode, int open_flags = 0, const std::wstring& options = std::wstring(), const open_callback_t& callback = nullptr);
 
+			/// @brief Opens an extractor for the specified input stream.
+			/// @param stream Pointer to the input stream.
+			/// @param own_stream Boolean indicating ownership of the stream.
+			/// @param mode The mode in which to open the stream.
+			/// @param open_flags Flags for opening the stream.
+			/// @param options The options to open with.
+			/// @param callback Optional callback function. Defaults to nullptr.
+			/// @return An extractor object for the specified input stream.
+			Extractor OpenExtractor(std::istream* stream, bool own_stream, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback = nullptr);
+
 			/// @brief Opens an extractor for the specified file.
 			/// @param file Pointer to the file.
 			/// @param own_file Boolean indicating ownership of the file.
@@ -1016,6 +1589,16 @@ namespace Hyland
 			/// @return An extractor object for the specified file.
 			Extractor OpenExtractor(FILE* file, bool own_file, OpenMode mode, int open_flags = 0, const std::wstring& options = std::wstring(), const open_callback_t& callback = nullptr);
 
+			/// @brief Opens an extractor for the specified file.
+			/// @param file Pointer to the file.
+			/// @param own_file Boolean indicating ownership of the file.
+			/// @param mode The mode in which to open the file.
+			/// @param open_flags Flags for opening the file.
+			/// @param options The options to open with.
+			/// @param callback Optional callback function. Defaults to nullptr.
+			/// @return An extractor object for the specified file.
+			Extractor OpenExtractor(FILE* file, bool own_file, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback = nullptr);
+
 			/// @brief Opens an extractor for the specified stream.
 			/// @param stream Reference to the stream object.
 			/// @param mode The mode in which to open the stream.
@@ -1025,6 +1608,15 @@ namespace Hyland
 			/// @return An extractor object for the specified stream.
 			Extractor OpenExtractor(Stream& stream, OpenMode mode, int open_flags = 0, const std::wstring& options = std::wstring(), const open_callback_t& callback = nullptr);
 
+			/// @brief Opens an extractor for the specified stream.
+			/// @param stream Reference to the stream object.
+			/// @param mode The mode in which to open the stream.
+			/// @param open_flags Flags for opening the stream.
+			/// @param options The options to open with.
+			/// @param callback Optional callback function. Defaults to nullptr.
+			/// @return An extractor object for the specified stream.
+			Extractor OpenExtractor(Stream& stream, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback = nullptr);
+
 			/// @brief Opens an extractor for the specified stream.
 			/// @param stream Pointer to the stream object.
 			/// @param own_stream Boolean indicating ownership of the stream.
@@ -1035,6 +1627,16 @@ namespace Hyland
 			/// @return An extractor object for the specified stream.
 			Extractor OpenExtractor(Stream* stream, bool own_stream, OpenMode mode, int open_flags = 0, const std::wstring& options = std::wstring(), const open_callback_t& callback = nullptr);
 
+			/// @brief Opens an extractor for the specified stream.
+			/// @param stream Pointer to the stream object.
+			/// @param own_stream Boolean indicating ownership of the stream.
+			/// @param mode The mode in which to open the stream.
+			/// @param open_flags Flags for opening the stream.
+			/// @param options The options to open with.
+			/// @param callback Optional callback function. Defaults to nullptr.
+			/// @return An extractor object for the specified stream.
+			Extractor OpenExtractor(Stream* stream, bool own_stream, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback = nullptr);
+
 			/// @brief Creates an output canvas for the specified file.
 			/// @param filename The name of the file as a string.
 			/// @param getType The getType of the canvas.
@@ -1042,6 +1644,13 @@ namespace Hyland
 			/// @return A canvas object for the specified file.
 			Canvas MakeOutputCanvas(const std::string& filename, CanvasType type, const std::wstring& options = std::wstring());
 
+			/// @brief Creates an output canvas for the specified file.
+			/// @param filename The name of the file as a string.
+			/// @param getType The getType of the canvas.
+			/// @param options The options for the canvas.
+			/// @return A canvas object for the specified file.
+			Canvas MakeOutputCanvas(const std::string& filename, CanvasType type, const OptionSet& options);
+
 			/// @brief Creates an output canvas for the specified file.
 			/// @param filename The name of the file as a wide string.
 			/// @param getType The getType of the canvas.
@@ -1049,6 +1658,13 @@ namespace Hyland
 			/// @return A canvas object for the specified file.
 			Canvas MakeOutputCanvas(const std::wstring& filename, CanvasType type, const std::wstring& options = std::wstring());
 
+			/// @brief Creates an output canvas for the specified file.
+			/// @param filename The name of the file as a wide string.
+			/// @param getType The getType of the canvas.
+			/// @param options The options for the canvas.
+			/// @return A canvas object for the specified file.
+			Canvas MakeOutputCanvas(const std::wstring& filename, CanvasType type, const OptionSet& options);
+
 			/// @brief Creates an output canvas for the specified stream.
 			/// @param stream Reference to the input/output stream.
 			/// @param getType The getType of the canvas.
@@ -1056,6 +1672,13 @@ namespace Hyland
 			/// @return A canvas object for the specified stream.
 			Canvas MakeOutputCanvas(std::iostream& stream, CanvasType type, const std::wstring& options = std::wstring());
 
+			/// @brief Creates an output canvas for the specified stream.
+			/// @param stream Reference to the input/output stream.
+			/// @param getType The getType of the canvas.
+			/// @param options The options for the canvas.
+			/// @return A canvas object for the specified stream.
+			Canvas MakeOutputCanvas(std::iostream& stream, CanvasType type, const OptionSet& options);
+
 			/// @brief Creates an output canvas for the specified stream.
 			/// @param stream Pointer to the input/output stream.
 			/// @param own_stream Boolean indicating ownership of the stream.
@@ -1064,6 +1687,14 @@ namespace Hyland
 			/// @return A canvas object for the specified stream.
 			Canvas MakeOutputCanvas(std::iostream* stream, bool own_stream, CanvasType type, const std::wstring& options = std::wstring());
 
+			/// @brief Creates an output canvas for the specified stream.
+			/// @param stream Pointer to the input/output stream.
+			/// @param own_stream Boolean indicating ownership of the stream.
+			/// @param getType The getType of the canvas.
+			/// @param options The options for the canvas.
+			/// @return A canvas object for the specified stream.
+			Canvas MakeOutputCanvas(std::iostream* stream, bool own_stream, CanvasType type, const OptionSet& options);
+
 			/// @brief Creates an output canvas for the specified file.
 			/// @param file Pointer to the file.
 			/// @param own_file Boolean indicating ownership of the file.
@@ -1072,6 +1703,14 @@ namespace Hyland
 			/// @return A canvas object for the specified file.
 			Canvas MakeOutputCanvas(FILE* file, bool own_file, CanvasType type, const std::wstring& options = std::wstring());
 
+			/// @brief Creates an output canvas for the specified file.
+			/// @param file Pointer to the file.
+			/// @param own_file Boolean indicating ownership of the file.
+			/// @param getType The getType of the canvas.
+			/// @param options The options for the canvas.
+			/// @return A canvas object for the specified file.
+			Canvas MakeOutputCanvas(FILE* file, bool own_file, CanvasType type, const OptionSet& options);
+
 			/// @brief Creates an output canvas for the specified stream.
 			/// @param stream Reference to the stream object.
 			/// @param getType The getType of the canvas.
@@ -1079,6 +1718,13 @@ namespace Hyland
 			/// @return A canvas object for the specified stream.
 			Canvas MakeOutputCanvas(Stream& stream, CanvasType type, const std::wstring& options = std::wstring());
 
+			/// @brief Creates an output canvas for the specified stream.
+			/// @param stream Reference to the stream object.
+			/// @param getType The getType of the canvas.
+			/// @param options The options for the canvas.
+			/// @return A canvas object for the specified stream.
+			Canvas MakeOutputCanvas(Stream& stream, CanvasType type, const OptionSet& options);
+
 			/// @brief Creates an output canvas for the specified stream.
 			/// @param stream Pointer to the stream object.
 			/// @param own_stream Boolean indicating ownership of the stream.
@@ -1087,6 +1733,14 @@ namespace Hyland
 			/// @return A canvas object for the specified stream.
 			Canvas MakeOutputCanvas(Stream* stream, bool own_stream, CanvasType type, const std::wstring& options = std::wstring());
 
+			/// @brief Creates an output canvas for the specified stream.
+			/// @param stream Pointer to the stream object.
+			/// @param own_stream Boolean indicating ownership of the stream.
+			/// @param getType The getType of the canvas.
+			/// @param options The options for the canvas.
+			/// @return A canvas object for the specified stream.
+			Canvas MakeOutputCanvas(Stream* stream, bool own_stream, CanvasType type, const OptionSet& options);
+
 			/// @brief Creates an output canvas for the specified writable stream.
 			/// @param stream Pointer to the writable stream object.
 			/// @param getType The getType of the canvas.
@@ -1094,24 +1748,100 @@ namespace Hyland
 			/// @return A canvas object for the specified writable stream.
 			Canvas MakeOutputCanvas(IGR_Writable_Stream* stream, CanvasType type, const std::wstring& options = std::wstring());
 
+			/// @brief Creates an output canvas for the specified writable stream.
+			/// @param stream Pointer to the writable stream object.
+			/// @param getType The getType of the canvas.
+			/// @param options The options for the canvas.
+			/// @return A canvas object for the specified writable stream.
+			Canvas MakeOutputCanvas(IGR_Writable_Stream* stream, CanvasType type, const OptionSet& options);
+
+			/// @brief Converts a document straight to a plain text or HTML file inside the engine, without reading
+			/// its text through an Extractor.
+			/// @param source The document to convert.
+			/// @param destination The file to write the output to.
+			/// @param flags The open flags, which select the parts of the document and the output format. Defaults to IGR_FORMAT_TEXT.
+			/// @param options Optional additional options as a wide string. Defaults to an empty string.
+			/// @throws DocumentFilters::Error if the conversion fails.
+			void ConvertFile(const std::wstring& source, const std::wstring& destination, uint32_t flags = IGR_FORMAT_TEXT, const std::wstring& options = std::wstring());
+
+			/// @brief Converts a document straight to a plain text or HTML file inside the engine.
+			/// @param source The document to convert.
+			/// @param destination The file to write the output to.
+			/// @param flags The open flags, which select the parts of the document and the output format.
+			/// @param options The options to convert with.
+			/// @throws DocumentFilters::Error if the conversion fails.
+			void ConvertFile(const std::wstring& source, const std::wstring& destination, uint32_t flags, const OptionSet& options);
+
+			/// @brief Converts a document like ConvertFile, reporting a failure of the engine in the result instead of throwing.
+			/// @param source The document to convert.
+			/// @param destination The file to write the output to.
+			/// @param flags The open flags, which select the parts of the document and the output format.
+			/// @param options The options to convert with.
+			/// @return The outcome of the call.
+			Result<void> TryConvertFile(const std::wstring& source, const std::wstring& destination, uint32_t flags, const OptionSet& options);
+
+			/// @brief Converts a batch of documents on a pool of worker threads.
+			///
+			/// The workers are started on first use and kept for the life of this object, so every batch runs on the
+			/// same engine threads; the calling thread joins in as worker 0. Each worker takes the next job as soon
+			/// as it finishes one, so a slow document holds up only its own worker. A failed job is reported in its
+			/// result and does not stop the others.
+			///
+			/// @param jobs The conversions to run.
+			/// @param flags The open flags, which select the parts of the document and the output format.
+			/// @param options The options to convert with, shared by every job.
+			/// @param threads The number of worker threads; 0 uses one per hardware thread. Never more than the number of jobs.
+			/// @return One result per job, in the order of the jobs.
+			/// @throws DocumentFilters::Error if a worker thread cannot be started; the pool is stopped first.
+			std::vector<ConvertJobResult> ConvertFiles(const std::vector<ConvertJob>& jobs, uint32_t flags = IGR_FORMAT_TEXT, const OptionSet& options = OptionSet(), size_t threads = 0);
+
+			/// @brief Sets the file access method used by GetExtractor and OpenExtractor when given a filename.
+			/// Safe to call while other threads open extractors; each call to GetExtractor uses the setting current
+			/// when it starts. See FileAccess::MemoryMapped for what happens if a mapped file is truncated.
+			///
+			/// @param access The method used to read files. Defaults to FileAccess::Default.
+			/// @param hint The expected access pattern, used with FileAccess::MemoryMapped. Defaults to FileAccessHint::Random,
+			/// which suits the scattered reads the engine makes in most formats.
+			void setFileAccess(FileAccess access, FileAccessHint hint = FileAccessHint::Random);
+
+			/// @brief Gets the file access method used by GetExtractor and OpenExtractor when given a filename.
+			/// @return The method used to read files.
+			FileAccess getFileAccess() const;
+
+			/// @brief Gets the access pattern hint used by GetExtractor and OpenExtractor with FileAccess::MemoryMapped.
+			/// @return The expected access pattern.
+			FileAccessHint getFileAccessHint() const;
+
 			/// @brief Retrieves the list of available formats.
 			/// @return A constant reference to a vector of `igr_format` objects representing the available formats.
+			/// Valid until the next successful Registry::LoadFrom.
 			const std::vector<Format>& getFormats() const;
 
 			/// @brief Retrieves the list of supported formats.
 			/// This is an alias for `get_formats()`.
 			/// @return A constant reference to a vector of `igr_format` objects representing the supported formats.
+			/// Valid until the next successful Registry::LoadFrom.
 			const std::vector<Format>& getSupportedFormats() const { return getFormats(); }
 
 			/// @brief Retrieves the list of available options.
 			/// @return A constant reference to a vector of `igr_option` objects representing the available options.
+			/// Valid until the next successful Registry::LoadFrom.
 			const std::vector<Option>& getOptions() const;
 
 			/// @brief Retrieves the list of available options.
 			/// This is an alias for `get_options()`.
 			/// @return A constant reference to a vector of `igr_option` objects representing the available options.
+			/// Valid until the next successful Registry::LoadFrom.
 			const std::vector<Option>& getAvailableOptions() const { return getOptions(); }
 
+			/// @brief Retrieves the indexed registry of formats and options.
+			/// @return A constant reference to the registry, which lives as long as this object.
+			const Registry& getRegistry() const;
+
+			/// @brief Retrieves the indexed registry of formats and options.
+			/// @return A reference to the registry, which lives as long as this object.
+			Registry& getRegistry();
+
 		protected:
 			class impl_t;
 			std::shared_ptr<impl_t> m_impl;
@@ -1123,6 +1853,29 @@ namespace Hyland
 			/// @param own_stream Boolean indicating ownership of the stream.
 			/// @return A canvas object for the specified writable stream.
 			Canvas DoMakeOutputCanvas(IGR_Writable_Stream* stream, CanvasType type, const std::wstring& options, bool own_stream);
+
+			/// @brief Creates an output canvas for the specified writable stream.
+			/// @param stream Pointer to the writable stream object.
+			/// @param type The type of the canvas.
+			/// @param options The options, already encoded for the engine.
+			/// @param own_stream Boolean indicating ownership of the stream.
+			/// @return A canvas object for the specified writable stream.
+			Canvas DoMakeOutputCanvas(IGR_Writable_Stream* stream, CanvasType type, const IGR_UCS2* options, bool own_stream);
+
+			/// @brief Creates an output canvas for the specified file.
+			/// @param filename The name of the file as a wide string.
+			/// @param type The type of the canvas.
+			/// @param options The options, already encoded for the engine.
+			/// @return A canvas object for the specified file.
+			Canvas DoMakeOutputCanvas(const std::wstring& filename, CanvasType type, const IGR_UCS2* options);
+
+			/// @brief Converts a document straight to a file inside the engine.
+			/// @param source The document to convert.
+			/// @param destination The file to write the output to.
+			/// @param flags The open flags.
+			/// @param options The options, already encoded for the engine.
+			/// @return The outcome of the call.
+			Result<void> DoConvertFile(const std::wstring& source, const std::wstring& destination, uint32_t flags, const IGR_UCS2* options);
 		};
 
 		using Api = DocumentFilters;
@@ -1169,6 +1922,28 @@ namespace Hyland
 			/// @return A pointer to the relinquished IGR_Stream.
 			virtual IGR_Stream* relinquish_igr_stream() { return nullptr; };
 
+			/// @brief Gets the entire contents of the stream if they are held in one contiguous buffer.
+			///
+			/// Streams that return true can be handed to the engine with IGR_Make_Stream_From_Memory
+			/// instead of being bridged, which avoids a virtual call and a copy for every read. The
+			/// buffer must stay valid and unchanged for as long as the stream is alive.
+			///
+			/// @param data Receives a pointer to the first byte of the stream.
+			/// @param size Receives the size of the stream in bytes.
+			/// @return True if a view is available, false otherwise (default).
+			virtual bool get_memory_view(const void*& /*data*/, size_t& /*size*/) const { return false; }
+
+			/// @brief Opens another part of a document that spans several files, such as a volume of a split archive.
+			///
+			/// Called when the engine asks the bridged stream for a part (IGR_ACTION_GET_STREAM_PART) while
+			/// processing multi-volume archives, for example .r01, .z01 or .7z.001 volumes.
+			///
+			/// @param part_name The name of the requested part, for example "archive.r01".
+			/// @param full_name The full path of the requested part, as derived by the engine.
+			/// @param index The index of the requested part.
+			/// @return A stream over the part, or nullptr if it is not available (default).
+			virtual std::unique_ptr<Stream> get_stream_part(const std::wstring& /*part_name*/, const std::wstring& /*full_name*/, int /*index*/) { return nullptr; }
+
 			/// @brief Bridges a standard iostream to an IGR_Stream.
 			///
 			/// This function creates a bridge between a standard iostream and an IGR_Stream.
@@ -1209,6 +1984,21 @@ namespace Hyland
 			/// @return A pointer to the bridged IGR_Stream.
 			static IGR_Stream* bridge_stream(Hyland::DocFilters::Stream* stream, bool own_stream, IGR_Stream** igr_stream);
 
+			/// @brief Bridges a hyland::docfilters::stream to a read-only IGR_Stream.
+			///
+			/// If the stream provides a memory view (see get_memory_view), the view is passed directly to
+			/// IGR_Make_Stream_From_Memory and the engine reads it without calling back into the stream.
+			/// When the stream is owned it is deleted once the engine closes the IGR_Stream, which keeps
+			/// any buffer it owns alive until then. A stream that is not owned must keep its view valid and
+			/// unchanged until the engine closes the IGR_Stream. Other streams are bridged as with bridge_stream.
+			///
+			/// The resulting stream cannot be written to; use bridge_stream for output.
+			///
+			/// @param stream A pointer to the hyland::docfilters::stream.
+			/// @param own_stream A boolean indicating whether the function should take ownership of the stream.
+			/// @param igr_stream A pointer to the IGR_Stream to be bridged.
+			/// @return A pointer to the bridged IGR_Stream.
+			static IGR_Stream* bridge_input_stream(Hyland::DocFilters::Stream* stream, bool own_stream, IGR_Stream** igr_stream);
 		};
 
 		/// @brief A memory stream class derived from the stream class.
@@ -1254,6 +2044,12 @@ namespace Hyland
 			/// @brief Gets the memory buffer of the stream.
 			/// @return A constant pointer to the memory buffer.
 			const void* get_memory() const { return m_buffer; }
+
+			/// @brief Gets the contents of the memory stream.
+			/// @param data Receives a pointer to the memory buffer.
+			/// @param size Receives the size of the memory stream in bytes.
+			/// @return True if the stream holds any data, false if it is empty.
+			bool get_memory_view(const void*& data, size_t& size) const override;
 		protected:
 			/// @brief Resizes the memory stream to a new size.
 			/// @param new_size The new size of the memory stream.
@@ -1278,56 +2074,953 @@ namespace Hyland
 			/// @brief Constructs an empty vector stream.
 			VectorStream();
 
-			/// @brief Retrieves the data stored in the vector stream.
-			/// @return A constant reference to a vector of bytes representing the data.
-			const std::vector<uint8_t>& data() const { return m_data; }
-		protected:
-			/// @brief Resizes the buffer to a new size.
-			/// @param buffer Pointer to the buffer.
-			/// @param new_size The new size of the buffer.
-			/// @return A pointer to the resized buffer.
-			void* resize_buffer(void* buffer, size_t new_size) override;
-		private:
-			std::vector<uint8_t> m_data; ///< Vector storing the stream data.
+			/// @brief Retrieves the data stored in the vector stream.
+			/// @return A constant reference to a vector of bytes representing the data.
+			const std::vector<uint8_t>& data() const { return m_data; }
+		protected:
+			/// @brief Resizes the buffer to a new size.
+			/// @param buffer Pointer to the buffer.
+			/// @param new_size The new size of the buffer.
+			/// @return A pointer to the resized buffer.
+			void* resize_buffer(void* buffer, size_t new_size) override;
+		private:
+			std::vector<uint8_t> m_data; ///< Vector storing the stream data.
+		};
+
+		/// @brief A thread-safe pool of fixed-size memory segments used by SegmentedStream.
+		///
+		/// Copies of a SegmentPool share the same underlying pool. Segments are returned to the pool when
+		/// the last owner releases them, and up to max_cached of them are kept for reuse.
+		class SegmentPool
+		{
+			class impl_t;
+		public:
+			/// @brief Deleter that returns a segment to the pool it came from.
+			class Deleter
+			{
+			public:
+				Deleter() = default;
+				void operator()(uint8_t* segment) const;
+			private:
+				friend class SegmentPool;
+				std::shared_ptr<impl_t> m_pool;
+			};
+
+			/// @brief An owned segment of segmentSize() bytes, returned to the pool when destroyed.
+			using segment_ptr = std::unique_ptr<uint8_t[], Deleter>;
+
+			/// @brief Constructs a segment pool.
+			/// @param segment_size The size of each segment in bytes.
+			/// @param max_cached The maximum number of released segments kept for reuse.
+			/// @throws std::invalid_argument if segment_size is zero.
+			explicit SegmentPool(size_t segment_size = 256 * 1024, size_t max_cached = 64);
+
+			/// @brief Gets a segment from the pool, allocating one if none are cached.
+			/// @return An owned segment. Its contents are unspecified.
+			segment_ptr acquire();
+
+			/// @brief Gets the size of the segments handed out by this pool.
+			/// @return The segment size in bytes.
+			size_t segmentSize() const;
+
+			/// @brief Gets the number of released segments currently held for reuse.
+			/// @return The number of cached segments.
+			size_t cachedCount() const;
+
+			/// @brief Frees all cached segments.
+			void trim();
+		private:
+			std::shared_ptr<impl_t> m_impl;
+		};
+
+		/// @brief An output stream that stores its data in a chain of fixed-size segments.
+		///
+		/// Unlike VectorStream, growing a SegmentedStream never reallocates or copies what was already written,
+		/// and no single allocation is larger than a segment. Seeking and overwriting work across segment
+		/// boundaries, so canvases can patch headers after the fact. The data can be consumed without
+		/// flattening it, either by walking the segments or by taking ownership of them.
+		class SegmentedStream : public Stream
+		{
+		public:
+			/// @brief A read-only view of one segment of the stream.
+			struct Segment
+			{
+				const uint8_t* data = nullptr; ///< Start of the segment.
+				size_t size = 0;               ///< Number of valid bytes in the segment.
+			};
+
+			/// @brief A segment whose ownership was taken from the stream.
+			struct OwnedSegment
+			{
+				SegmentPool::segment_ptr data; ///< The segment memory, returned to its pool when released.
+				size_t size = 0;               ///< Number of valid bytes in the segment.
+			};
+
+			/// @brief Constructs an empty stream that draws segments from its own pool of 256 KB segments.
+			SegmentedStream();
+
+			/// @brief Constructs an empty stream that draws segments from the given pool.
+			/// @param pool The pool to take segments from; it may be shared with other streams.
+			explicit SegmentedStream(const SegmentPool& pool);
+			~SegmentedStream() override;
+
+			/// @brief Seeks to a specific position in the stream. Seeking past the end is allowed; a later write fills the gap with zeros.
+			/// @param offset The position to seek to.
+			/// @param way The direction to seek (beginning, current, end).
+			/// @return The new position in the stream, or -1 if the position would be negative.
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
+
+			/// @brief Reads data from the stream into a buffer.
+			/// @param buffer The buffer to read data into.
+			/// @param size The number of bytes to read.
+			/// @return The number of bytes actually read.
+			size_t read(void* buffer, size_t size) override;
+
+			/// @brief Writes data to the stream, overwriting and extending it as needed.
+			/// @param buffer The buffer containing data to write.
+			/// @param size The number of bytes to write.
+			/// @return The number of bytes actually written.
+			size_t write(const void* buffer, size_t size) override;
+
+			/// @brief Provides a memory view when the data fits in a single segment.
+			/// @param data Receives a pointer to the data.
+			/// @param size Receives the size of the data in bytes.
+			/// @return True if the stream holds a single non-empty segment, false otherwise.
+			bool get_memory_view(const void*& data, size_t& size) const override;
+
+			/// @brief Gets the size of the stream.
+			/// @return The size of the stream in bytes.
+			size_t size() const;
+
+			/// @brief Gets views of the segments holding the data, in order. The views are invalidated by writes.
+			/// @return The segments of the stream.
+			std::vector<Segment> getSegments() const;
+
+			/// @brief Takes ownership of the segments holding the data, in order, and resets the stream to empty.
+			/// @return The segments of the stream.
+			std::vector<OwnedSegment> takeSegments();
+
+			/// @brief Copies the data into a single contiguous vector.
+			/// @return The data of the stream.
+			std::vector<uint8_t> toVector() const;
+
+			/// @brief Discards all data and returns the segments to the pool.
+			void clear();
+		protected:
+			class impl_t;
+			std::unique_ptr<impl_t> m_impl;
+		};
+
+		/// @brief An output stream that is held in memory until it grows past a threshold, then moves to a temporary file.
+		///
+		/// Small outputs never touch the disk, while large ones do not have to fit in memory. When a write would take
+		/// the stream past the threshold, the data written so far is copied to an anonymous temporary file (O_TMPFILE
+		/// where available, otherwise a file that is unlinked or marked delete-on-close immediately) and all further
+		/// reads and writes go to that file. The file is removed when the stream is destroyed.
+		class SpillStream : public Stream
+		{
+		public:
+			/// @brief Where the stream's data currently lives.
+			enum class Backing
+			{
+				Memory, ///< The data is held in memory segments.
+				File,   ///< The data has been moved to a temporary file.
+			};
+
+			/// @brief Constructs an empty stream.
+			/// @param memory_threshold The largest size, in bytes, kept in memory. Defaults to 16 MB.
+			/// @param temp_directory Directory for the temporary file. Defaults to the system temporary directory.
+			explicit SpillStream(size_t memory_threshold = 16 * 1024 * 1024, const std::string& temp_directory = std::string());
+
+			/// @brief Constructs an empty stream that takes its memory segments from the given pool.
+			/// @param memory_threshold The largest size, in bytes, kept in memory.
+			/// @param pool The pool to take memory segments from.
+			/// @param temp_directory Directory for the temporary file. Defaults to the system temporary directory.
+			SpillStream(size_t memory_threshold, const SegmentPool& pool, const std::string& temp_directory = std::string());
+			~SpillStream() override;
+
+			/// @brief Seeks to a specific position in the stream.
+			/// @param offset The position to seek to.
+			/// @param way The direction to seek (beginning, current, end).
+			/// @return The new position in the stream, or -1 if the position would be negative.
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
+
+			/// @brief Reads data from the stream into a buffer.
+			/// @param buffer The buffer to read data into.
+			/// @param size The number of bytes to read.
+			/// @return The number of bytes actually read.
+			size_t read(void* buffer, size_t size) override;
+
+			/// @brief Writes data to the stream, moving it to a temporary file first if the threshold would be exceeded.
+			/// @param buffer The buffer containing data to write.
+			/// @param size The number of bytes to write.
+			/// @return The number of bytes actually written.
+			/// @throws std::runtime_error if the temporary file cannot be created.
+			size_t write(const void* buffer, size_t size) override;
+
+			/// @brief Provides a memory view while the data is still in memory and fits in a single segment.
+			/// @param data Receives a pointer to the data.
+			/// @param size Receives the size of the data in bytes.
+			/// @return True if a view is available, false otherwise.
+			bool get_memory_view(const void*& data, size_t& size) const override;
+
+			/// @brief Gets the size of the stream.
+			/// @return The size of the stream in bytes.
+			uint64_t size() const;
+
+			/// @brief Gets where the stream's data currently lives.
+			/// @return The current backing mode.
+			Backing getBacking() const;
+
+			/// @brief Gets the number of bytes written to the temporary file, including the data moved there when spilling.
+			/// @return The number of bytes spilled to disk, 0 while the stream is in memory.
+			uint64_t getSpilledBytes() const;
+
+			/// @brief Gets the configured memory threshold.
+			/// @return The threshold in bytes.
+			size_t getMemoryThreshold() const;
+		protected:
+			class impl_t;
+			std::unique_ptr<impl_t> m_impl;
+		};
+
+		/// @brief Options controlling a PipeStream.
+		struct PipeStreamOptions
+		{
+			size_t capacity = 1024 * 1024;      ///< Size of the ring buffer between the writer and the reader; rounded up to a power of two.
+			size_t rewrite_window = 64 * 1024;  ///< Bytes held back from the reader so the writer can seek back and patch them.
+		};
+
+		/// @brief An output stream that hands its data to a consumer thread while it is still being written.
+		///
+		/// A canvas writes into the pipe on the rendering thread while another thread calls consume() and sends
+		/// the bytes on, for example as an HTTP response, so the first bytes go out long before rendering ends.
+		/// The two threads share a bounded single-producer single-consumer ring buffer; when it is full the writer
+		/// blocks until the consumer catches up.
+		///
+		/// Canvases seek back to patch headers and offsets, so the most recent rewrite_window bytes are held
+		/// back from the consumer until the writer moves past them. A seek to data the consumer may already
+		/// have received fails, and consume() then throws. Setting rewrite_window to
+		/// std::numeric_limits<size_t>::max() buffers the whole output until finish(), which always works but
+		/// gives up the early first byte.
+		///
+		/// @code
+		/// PipeStream pipe;
+		/// std::thread sender([&] { char buf[65536]; while (size_t n = pipe.consume(buf, sizeof(buf))) send(buf, n); });
+		/// auto canvas = api.MakeOutputCanvas(pipe, CanvasType::PDF);
+		/// // ... render pages ...
+		/// canvas.Close();
+		/// pipe.finish();
+		/// sender.join();
+		/// @endcode
+		class PipeStream : public Stream
+		{
+		public:
+			using Options = PipeStreamOptions;
+
+			/// @brief Constructs an empty pipe.
+			/// @param options The buffer configuration.
+			explicit PipeStream(const Options& options = Options());
+			~PipeStream() override;
+
+			/// @brief Seeks the write position. Called by the writer.
+			/// @param offset The position to seek to.
+			/// @param way The direction to seek (beginning, current, end).
+			/// @return The new position, or -1 if it lies before the rewrite window.
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
+
+			/// @brief Reads back data that is still in the rewrite window. Called by the writer.
+			/// @param buffer The buffer to read data into.
+			/// @param size The number of bytes to read.
+			/// @return The number of bytes actually read.
+			size_t read(void* buffer, size_t size) override;
+
+			/// @brief Writes data, blocking while the ring buffer is full. Called by the writer.
+			/// @param buffer The buffer containing data to write.
+			/// @param size The number of bytes to write.
+			/// @return The number of bytes written, or 0 if the pipe was cancelled.
+			size_t write(const void* buffer, size_t size) override;
+
+			/// @brief Marks the end of the output and releases the rewrite window to the consumer. Called by the writer.
+			void finish();
+
+			/// @brief Takes the next bytes of output, blocking until some are available. Called by the consumer.
+			/// @param buffer The buffer to copy data into.
+			/// @param size The size of the buffer.
+			/// @return The number of bytes copied, or 0 once the writer has finished and all data was consumed.
+			/// @throws std::runtime_error if the writer rewrote data that may already have been consumed.
+			size_t consume(void* buffer, size_t size);
+
+			/// @brief Stops the pipe from either side; blocked calls return and later writes fail.
+			void cancel();
+
+			/// @brief Gets the number of bytes handed to the consumer side so far.
+			/// @return The number of bytes that left the rewrite window.
+			uint64_t getPublishedBytes() const;
+
+			/// @brief Gets the number of times the writer waited for the consumer to free space.
+			/// @return The number of stalls.
+			uint64_t getWriterStalls() const;
+		protected:
+			class impl_t;
+			std::unique_ptr<impl_t> m_impl;
+		};
+
+		/// @brief A class for handling file streams, inheriting from the Stream class.
+		class FileStream : public Stream
+		{
+		public:
+			FileStream(std::istream* stream, bool own_stream);
+			FileStream(std::iostream* stream, bool own_stream);
+			FileStream(FILE* stream, bool own_stream);
+			FileStream(const std::string& filename);
+			FileStream(const std::wstring& filename);
+			~FileStream() override;
+
+			/// @brief Seeks to a specific position in the stream.
+			/// @param offset The position to seek to.
+			/// @param way The direction to seek (beginning, current, end).
+			/// @return The new position in the stream.
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
+
+			/// @brief Reads data from the stream into a buffer.
+			/// @param buffer The buffer to read data into.
+			/// @param size The number of bytes to read.
+			/// @return The number of bytes actually read.
+			size_t read(void* buffer, size_t size) override;
+
+			/// @brief Writes data from a buffer to the stream.
+			/// @param buffer The buffer containing data to write.
+			/// @param size The number of bytes to write.
+			/// @return The number of bytes actually written (default is 0).
+			size_t write(const void* buffer, size_t size) override;
+
+			/// @brief Relinquishes ownership of the underlying IGR_Stream.
+			/// @return A pointer to the relinquished IGR_Stream.
+			IGR_Stream* relinquish_igr_stream() override;
+
+			/// @brief Closes the stream.
+			void close();
+		protected:
+			IGR_Writable_Stream* m_inner = nullptr;
+		};
+
+		/// @brief A read-only stream that serves reads from a memory mapping of a file.
+		///
+		/// Reads are copied directly out of the page cache instead of passing through std::ifstream,
+		/// which makes the small random reads performed by the engine much cheaper. If the file cannot
+		/// be mapped (for example on special files, or when address space is exhausted), the stream falls
+		/// back to positional reads against the open file.
+		///
+		/// The file must not be truncated while it is mapped: a read from a page past the new end of the file
+		/// raises SIGBUS (or an in-page exception on Windows), whether it is made by this stream or by the engine
+		/// through get_memory_view.
+		class MappedFileStream : public Stream
+		{
+		public:
+			/// @brief Describes how the file is expected to be accessed, passed on to the operating system.
+			typedef FileAccessHint AccessHint;
+
+			/// @brief Opens and maps the specified file.
+			/// @param filename The name of the file, UTF-8 encoded.
+			/// @param hint The expected access pattern. Defaults to AccessHint::Random, as for DocumentFilters::setFileAccess.
+			/// @throws std::runtime_error if the file cannot be opened.
+			MappedFileStream(const std::string& filename, AccessHint hint = AccessHint::Random);
+
+			/// @brief Opens and maps the specified file.
+			/// @param filename The name of the file.
+			/// @param hint The expected access pattern. Defaults to AccessHint::Random, as for DocumentFilters::setFileAccess.
+			/// @throws std::runtime_error if the file cannot be opened.
+			MappedFileStream(const std::wstring& filename, AccessHint hint = AccessHint::Random);
+			~MappedFileStream() override;
+
+			/// @brief Seeks to a specific position in the stream.
+			/// @param offset The position to seek to.
+			/// @param way The direction to seek (beginning, current, end).
+			/// @return The new position in the stream, or -1 if the position would be negative.
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
+
+			/// @brief Reads data from the stream into a buffer.
+			/// @param buffer The buffer to read data into.
+			/// @param size The number of bytes to read.
+			/// @return The number of bytes actually read.
+			size_t read(void* buffer, size_t size) override;
+
+			/// @brief Gets the size of the file.
+			/// @return The size of the file in bytes.
+			uint64_t size() const;
+
+			/// @brief Indicates if reads are served from a memory mapping rather than positional reads.
+			/// @return True if the file is mapped, false otherwise.
+			bool isMapped() const;
+
+			/// @brief Gets the mapping as a memory view, so the engine can read it without calling back into the stream.
+			/// @param data Receives a pointer to the start of the mapping.
+			/// @param size Receives the size of the file in bytes.
+			/// @return True if the file is mapped, false if reads fall back to positional reads.
+			bool get_memory_view(const void*& data, size_t& size) const override;
+
+			/// @brief Relinquishes ownership of the mapping as an IGR_Stream.
+			///
+			/// The returned stream reads directly from the mapping without any virtual dispatch. After
+			/// this call, the MappedFileStream is closed.
+			///
+			/// @return A pointer to the relinquished IGR_Stream, or nullptr if the stream is closed.
+			IGR_Stream* relinquish_igr_stream() override;
+
+			/// @brief Closes the stream and releases the mapping.
+			void close();
+		protected:
+			class impl_t;
+			std::unique_ptr<impl_t> m_impl;
+		};
+
+		/// @brief Options controlling an AsyncFileStream.
+		struct AsyncFileStreamOptions
+		{
+			size_t read_ahead = 4; ///< Number of blocks queued ahead of a forward scan, 0 to disable.
+		};
+
+		/// @brief Counters describing how reads on an AsyncFileStream were served.
+		struct AsyncFileStreamStats
+		{
+			uint64_t block_hits = 0;       ///< Block lookups served from a completed or in-flight read.
+			uint64_t block_reads = 0;      ///< Blocks read through the ring, including read-ahead.
+			uint64_t submissions = 0;      ///< Calls made to submit reads to the ring; each may carry several reads.
+			uint64_t direct_reads = 0;     ///< Reads served with a positional read instead of the ring.
+		};
+
+		/// @brief A read-only file stream for workers that process many documents at once on Linux.
+		///
+		/// Reads go through an io_uring owned by the calling thread and shared by every AsyncFileStream read on
+		/// that thread. Each ring has a pool of fixed-size buffers registered with the kernel. Forward scans are
+		/// read in blocks: the block that is needed and the read-ahead blocks after it are queued in one
+		/// submission, so later reads are served from memory without a system call. Scattered reads that miss
+		/// the blocks use a positional read straight into the caller's buffer, as that costs one system call
+		/// either way.
+		///
+		/// When io_uring is not available (older kernels, seccomp profiles that block it, other platforms, or
+		/// a ring whose buffers are all in use), the stream falls back to positional reads.
+		class AsyncFileStream : public Stream
+		{
+		public:
+			using Options = AsyncFileStreamOptions;
+			using Stats = AsyncFileStreamStats;
+
+			/// @brief Opens the specified file.
+			/// @param filename The name of the file, UTF-8 encoded.
+			/// @param options The read-ahead configuration.
+			/// @throws std::runtime_error if the file cannot be opened.
+			explicit AsyncFileStream(const std::string& filename, const Options& options = Options());
+
+			/// @brief Opens the specified file.
+			/// @param filename The name of the file.
+			/// @param options The read-ahead configuration.
+			/// @throws std::runtime_error if the file cannot be opened.
+			explicit AsyncFileStream(const std::wstring& filename, const Options& options = Options());
+			~AsyncFileStream() override;
+
+			/// @brief Seeks to a specific position in the stream.
+			/// @param offset The position to seek to.
+			/// @param way The direction to seek (beginning, current, end).
+			/// @return The new position in the stream, or -1 if the position would be negative.
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
+
+			/// @brief Reads data from the stream into a buffer.
+			/// @param buffer The buffer to read data into.
+			/// @param size The number of bytes to read.
+			/// @return The number of bytes actually read.
+			size_t read(void* buffer, size_t size) override;
+
+			/// @brief Gets the size of the file.
+			/// @return The size of the file in bytes.
+			uint64_t size() const;
+
+			/// @brief Gets counters describing how reads were served.
+			/// @return The stream's counters.
+			Stats getStats() const;
+
+			/// @brief Indicates whether the calling thread can read through an io_uring.
+			/// @return True if a ring could be created for this thread, false if streams fall back to positional reads.
+			static bool isAvailable();
+		protected:
+			class impl_t;
+			std::unique_ptr<impl_t> m_impl;
+		};
+
+		/// @brief Options controlling the block cache of a BufferedStream.
+		struct StreamBufferOptions
+		{
+			size_t block_size = 64 * 1024; ///< Size of each cached block in bytes, blocks are aligned to this size.
+			size_t block_count = 16;       ///< Maximum number of blocks held in the cache.
+			size_t read_ahead = 4;         ///< Number of blocks fetched in a single backend read once a forward scan is detected, 0 to disable.
+		};
+
+		/// @brief Counters describing how reads on a BufferedStream were served.
+		struct StreamBufferStats
+		{
+			uint64_t hits = 0;              ///< Block lookups served from the cache.
+			uint64_t misses = 0;            ///< Block lookups that required a backend read.
+			uint64_t read_ahead_blocks = 0; ///< Blocks loaded speculatively by read-ahead.
+			uint64_t bypass_reads = 0;      ///< Large reads passed straight through to the backend.
+			uint64_t backend_reads = 0;     ///< Number of read calls made on the wrapped stream.
+			uint64_t backend_seeks = 0;     ///< Number of seek calls made on the wrapped stream.
+			uint64_t backend_bytes = 0;     ///< Bytes read from the wrapped stream.
+			uint64_t bytes_read = 0;        ///< Bytes returned to the caller.
+		};
+
+		/// @brief A stream decorator that caches aligned blocks of a slower stream.
+		///
+		/// The engine tends to issue many small reads and to seek back and forth within a document. A
+		/// BufferedStream turns those into a small number of block-sized reads on the wrapped stream: blocks
+		/// are kept in an LRU cache, seeks that land inside a cached block are served from memory, and once
+		/// reads are seen moving forward through consecutive blocks the following blocks are fetched in one
+		/// larger read. Writes are passed through and invalidate any cached blocks they overlap.
+		///
+		/// To buffer a single extractor, wrap its source and pass the BufferedStream to GetExtractor.
+		class BufferedStream : public Stream
+		{
+		public:
+			using Options = StreamBufferOptions;
+			using Stats = StreamBufferStats;
+
+			/// @brief Constructs a buffered stream over another stream.
+			/// @param stream The stream to wrap.
+			/// @param own_stream Whether the buffered stream deletes the wrapped stream when destroyed.
+			/// @param options The cache configuration.
+			/// @throws std::invalid_argument if the stream is null or the block size or count is zero.
+			BufferedStream(Stream* stream, bool own_stream, const Options& options = Options());
+
+			/// @brief Constructs a buffered stream over a standard input stream.
+			/// @param stream The stream to wrap.
+			/// @param own_stream Whether the buffered stream deletes the wrapped stream when destroyed.
+			/// @param options The cache configuration.
+			BufferedStream(std::istream* stream, bool own_stream, const Options& options = Options());
+
+			/// @brief Constructs a buffered stream over a C file handle.
+			/// @param file The file to wrap.
+			/// @param own_file Whether the buffered stream closes the file when destroyed.
+			/// @param options The cache configuration.
+			BufferedStream(FILE* file, bool own_file, const Options& options = Options());
+			~BufferedStream() override;
+
+			/// @brief Seeks to a specific position in the stream.
+			/// @param offset The position to seek to.
+			/// @param way The direction to seek (beginning, current, end).
+			/// @return The new position in the stream, or -1 if the position would be negative.
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
+
+			/// @brief Reads data from the stream into a buffer.
+			/// @param buffer The buffer to read data into.
+			/// @param size The number of bytes to read.
+			/// @return The number of bytes actually read.
+			size_t read(void* buffer, size_t size) override;
+
+			/// @brief Forwards part requests to the wrapped stream.
+			/// @param part_name The name of the requested part.
+			/// @param full_name The full path of the requested part.
+			/// @param index The index of the requested part.
+			/// @return The wrapped stream's answer.
+			std::unique_ptr<Stream> get_stream_part(const std::wstring& part_name, const std::wstring& full_name, int index) override;
+
+			/// @brief Writes data through to the wrapped stream.
+			/// @param buffer The buffer containing data to write.
+			/// @param size The number of bytes to write.
+			/// @return The number of bytes actually written.
+			size_t write(const void* buffer, size_t size) override;
+
+			/// @brief Gets the cache counters collected so far.
+			/// @return The cache counters.
+			Stats getStats() const;
+
+			/// @brief Gets the options the stream was created with.
+			/// @return The cache configuration.
+			const Options& getOptions() const;
+
+			/// @brief Drops all cached blocks. The counters are kept.
+			void invalidate();
+		protected:
+			class impl_t;
+			std::unique_ptr<impl_t> m_impl;
+		};
+
+		/// @brief Options controlling a PrefetchStream.
+		struct PrefetchOptions
+		{
+			size_t block_size = 256 * 1024; ///< Size of each block fetched by the I/O thread, in bytes.
+			size_t depth = 4;               ///< Number of blocks fetched ahead of the reader. At most depth + 1 blocks are held in memory.
+		};
+
+		/// @brief Counters describing how much of the wrapped stream's latency a PrefetchStream hid.
+		struct PrefetchStats
+		{
+			uint64_t prefetched_blocks = 0;           ///< Blocks read by the background I/O thread.
+			uint64_t prefetch_hits = 0;               ///< Blocks that were ready by the time the reader reached them.
+			uint64_t prefetch_waits = 0;              ///< Blocks the reader had to wait on while the I/O thread was still reading them.
+			uint64_t demand_reads = 0;                ///< Reads made on the calling thread because nothing had been prefetched.
+			uint64_t wasted_blocks = 0;               ///< Prefetched blocks discarded without being read.
+			std::chrono::nanoseconds stall_time{};      ///< Time the reader spent waiting for the wrapped stream.
+			std::chrono::nanoseconds overlapped_time{}; ///< Background read time of blocks that were ready before the reader needed them.
+			std::chrono::nanoseconds io_time{};         ///< Total time the I/O thread spent reading the wrapped stream.
+		};
+
+		/// @brief A read-only stream decorator that reads ahead on a background thread.
+		///
+		/// Once the reader is seen moving forward through consecutive blocks, a dedicated I/O thread fetches
+		/// the next few blocks while the engine is still working on the current one, so storage latency is
+		/// overlapped with parsing instead of added to it. Reads that do not follow a forward scan are passed
+		/// straight to the wrapped stream on the calling thread.
+		///
+		/// Memory use is bounded by (depth + 1) blocks. Closing or destroying the stream cancels outstanding
+		/// prefetches and joins the I/O thread; a backend read already in progress is allowed to finish.
+		/// The wrapped stream is only ever accessed by one thread at a time, but it is accessed from the
+		/// I/O thread, so it must not be shared with other users while the PrefetchStream is alive.
+		class PrefetchStream : public Stream
+		{
+		public:
+			using Options = PrefetchOptions;
+			using Stats = PrefetchStats;
+
+			/// @brief Constructs a prefetching stream over another stream and starts its I/O thread.
+			/// @param stream The stream to wrap.
+			/// @param own_stream Whether the prefetching stream deletes the wrapped stream when destroyed.
+			/// @param options The prefetch configuration.
+			/// @throws std::invalid_argument if the stream is null, or the block size or depth is zero.
+			PrefetchStream(Stream* stream, bool own_stream, const Options& options = Options());
+			~PrefetchStream() override;
+
+			/// @brief Seeks to a specific position in the stream.
+			/// @param offset The position to seek to.
+			/// @param way The direction to seek (beginning, current, end).
+			/// @return The new position in the stream, or -1 if the position would be negative.
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
+
+			/// @brief Reads data from the stream into a buffer.
+			/// @param buffer The buffer to read data into.
+			/// @param size The number of bytes to read.
+			/// @return The number of bytes actually read.
+			size_t read(void* buffer, size_t size) override;
+
+			/// @brief Forwards part requests to the wrapped stream.
+			/// @param part_name The name of the requested part.
+			/// @param full_name The full path of the requested part.
+			/// @param index The index of the requested part.
+			/// @return The wrapped stream's answer.
+			std::unique_ptr<Stream> get_stream_part(const std::wstring& part_name, const std::wstring& full_name, int index) override;
+
+			/// @brief Gets the counters collected so far.
+			/// @return The prefetch counters.
+			Stats getStats() const;
+
+			/// @brief Cancels outstanding prefetches and stops the I/O thread. Later reads return 0.
+			void close();
+		protected:
+			class impl_t;
+			std::unique_ptr<impl_t> m_impl;
+		};
+
+		/// @brief Enum representing the compression formats understood by CompressedStream.
+		enum class CompressionFormat
+		{
+			Auto, ///< Detect the format from the first bytes of the stream.
+			Gzip, ///< gzip (including concatenated members) or zlib data.
+			Zstd, ///< Zstandard data, made of one or more frames.
+		};
+
+		/// @brief Options controlling the seek index and window cache of a CompressedStream.
+		struct CompressedStreamOptions
+		{
+			size_t window_size = 64 * 1024;         ///< Size of each decompressed window, in bytes.
+			size_t window_count = 32;               ///< Maximum number of decompressed windows kept in the LRU cache.
+			size_t checkpoint_span = 1024 * 1024;   ///< Minimum distance, in decompressed bytes, between checkpoints.
+		};
+
+		/// @brief Counters describing the work done by a CompressedStream.
+		struct CompressedStreamStats
+		{
+			uint64_t window_hits = 0;     ///< Reads served from a cached window.
+			uint64_t window_misses = 0;   ///< Windows that had to be decompressed.
+			uint64_t restarts = 0;        ///< Times the decoder was repositioned to a checkpoint.
+			uint64_t checkpoints = 0;     ///< Entries in the seek index.
+			uint64_t bytes_decoded = 0;   ///< Total decompressed bytes produced, including bytes skipped to reach a window.
+		};
+
+		/// @brief A read-only stream that decompresses gzip or zstd data on the fly, with cheap seeking.
+		///
+		/// The engine seeks all over its input, so the stream builds a seek index while it decompresses: for gzip
+		/// a checkpoint (input position plus the preceding 32 KB of output) is recorded at a deflate block boundary
+		/// every checkpoint_span bytes, and for zstd the first frame start past each checkpoint_span is a checkpoint. A read at an arbitrary offset
+		/// restarts the decoder at the nearest checkpoint before it, and decompressed windows are kept in an LRU cache
+		/// so nearby reads are served from memory. A zstd file written as a single frame can only be restarted
+		/// from its beginning.
+		///
+		/// The size of the decompressed data is not known up front; asking for it (seeking relative to the end)
+		/// decompresses the remainder of the stream once, which also completes the index.
+		///
+		/// Support for each format depends on the libraries available when the bindings were built, see isSupported.
+		class CompressedStream : public Stream
+		{
+		public:
+			using Options = CompressedStreamOptions;
+			using Stats = CompressedStreamStats;
+
+			/// @brief Constructs a decompressing stream.
+			/// @param stream The compressed stream to read from.
+			/// @param own_stream Whether the decompressing stream deletes the compressed stream when destroyed.
+			/// @param format The compression format, or CompressionFormat::Auto to detect it.
+			/// @param options The index and cache configuration.
+			/// @throws std::invalid_argument if the stream is null or the format cannot be detected.
+			/// @throws std::runtime_error if the format is not supported by this build.
+			CompressedStream(Stream* stream, bool own_stream, CompressionFormat format = CompressionFormat::Auto, const Options& options = Options());
+			~CompressedStream() override;
+
+			/// @brief Seeks to a specific position in the decompressed data.
+			/// @param offset The position to seek to.
+			/// @param way The direction to seek (beginning, current, end).
+			/// @return The new position in the stream, or -1 if the position would be negative.
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
+
+			/// @brief Reads decompressed data into a buffer.
+			/// @param buffer The buffer to read data into.
+			/// @param size The number of bytes to read.
+			/// @return The number of bytes actually read. Truncated or corrupt data reads as the end of the stream.
+			size_t read(void* buffer, size_t size) override;
+
+			/// @brief Gets the size of the decompressed data, decompressing the rest of the stream if needed.
+			/// @return The decompressed size in bytes.
+			uint64_t size();
+
+			/// @brief Gets the format of the compressed data.
+			/// @return The detected or specified format.
+			CompressionFormat getFormat() const;
+
+			/// @brief Gets the counters collected so far.
+			/// @return The decompression counters.
+			Stats getStats() const;
+
+			/// @brief Checks if this build of the bindings can decompress the given format.
+			/// @param format The format to check.
+			/// @return True if the format is supported.
+			static bool isSupported(CompressionFormat format);
+		protected:
+			class impl_t;
+			std::unique_ptr<impl_t> m_impl;
+		};
+
+		/// @brief Digests of the bytes of a document, as lowercase hexadecimal strings.
+		struct StreamDigests
+		{
+			std::wstring md5;           ///< MD5 digest.
+			std::wstring sha1;          ///< SHA-1 digest.
+			std::wstring sha256;        ///< SHA-256 digest.
+			std::wstring xxh3;          ///< XXH3 64-bit digest (seed 0), in canonical big-endian form.
+			uint64_t size = 0;          ///< Number of bytes hashed.
+			uint64_t filled_bytes = 0;  ///< Bytes read again at the end to cover ranges that were skipped or read out of order.
+		};
+
+		/// @brief Options controlling a HashingStream.
+		struct HashingStreamOptions
+		{
+			size_t reorder_limit = 4 * 1024 * 1024; ///< Maximum bytes of out-of-order reads kept until the hashes reach them.
+		};
+
+		/// @brief A read-only stream that hashes the data read through it.
+		///
+		/// The stream computes MD5, SHA-1, SHA-256 and XXH3 in one pass while the engine reads the document,
+		/// instead of each digest reading the whole input again. Hashes are sequential, so reads are fed to
+		/// them in file order: reads ahead of the hashed prefix are kept (up to reorder_limit bytes) until
+		/// the prefix reaches them, and any range the engine never read is read from the inner stream
+		/// when the digests are requested.
+		class HashingStream : public Stream
+		{
+		public:
+			using Options = HashingStreamOptions;
+
+			/// @brief Constructs a hashing stream.
+			/// @param stream The stream to read from.
+			/// @param own_stream Whether the hashing stream deletes the inner stream when destroyed.
+			/// @param options The hashing configuration.
+			/// @throws std::invalid_argument if the stream is null.
+			HashingStream(Stream* stream, bool own_stream, const Options& options = Options());
+			~HashingStream() override;
+
+			/// @brief Seeks to a specific position in the stream.
+			/// @param offset The position to seek to.
+			/// @param way The direction to seek (beginning, current, end).
+			/// @return The new position in the stream.
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
+
+			/// @brief Reads data from the inner stream, hashing it on the way through.
+			/// @param buffer The buffer to read data into.
+			/// @param size The number of bytes to read.
+			/// @return The number of bytes actually read.
+			size_t read(void* buffer, size_t size) override;
+
+			/// @brief Forwards part requests to the wrapped stream.
+			/// @param part_name The name of the requested part.
+			/// @param full_name The full path of the requested part.
+			/// @param index The index of the requested part.
+			/// @return The wrapped stream's answer.
+			std::unique_ptr<Stream> get_stream_part(const std::wstring& part_name, const std::wstring& full_name, int index) override;
+
+			/// @brief Completes the hashes and returns the digests.
+			///
+			/// Any part of the stream not yet hashed is read from the inner stream, after which the stream
+			/// position is restored. Once called, later reads are no longer hashed and later calls return
+			/// the same digests.
+			///
+			/// @return The digests of the whole stream.
+			StreamDigests getDigests();
+
+			/// @brief Gets the length of the prefix of the stream that has been hashed so far.
+			/// @return The number of bytes hashed.
+			uint64_t getHashedBytes() const;
+		protected:
+			class impl_t;
+			std::unique_ptr<impl_t> m_impl;
+		};
+
+		/// @brief Options controlling a StreamPartResolver.
+		struct StreamPartResolverOptions
+		{
+			size_t prefetch = 1;    ///< Number of following parts queued for the background worker each time a part is requested, and the most it holds queued; 0 disables prefetching.
+			size_t cache_size = 4;  ///< Maximum number of opened parts kept for reuse.
+		};
+
+		/// @brief Resolves the parts of a multi-volume document, opening neighbouring parts ahead of time.
+		///
+		/// The opener is called with the name, full path and index of a part and returns a stream over it, for
+		/// example a BufferedStream over an object storage download. Opened parts are cached, so a part the engine
+		/// opens again is not fetched again, and each request queues the following parts for a single background
+		/// worker, which opens them one at a time. A requested part that is still queued is opened by the caller
+		/// instead. The names of following parts are derived by incrementing the last number in the file name,
+		/// which covers .r01, .z01, .7z.001 and .part2.rar style volumes.
+		///
+		/// The resolver can be passed to Extractor::setStreamPartCallback or called from an overridden
+		/// Stream::get_stream_part. Copies share the same cache and worker. When the last copy is destroyed,
+		/// queued parts are dropped but a part the worker is already opening is waited for, so destroying the
+		/// resolver, or the Extractor holding it, can block for as long as one call to the opener.
+		class StreamPartResolver
+		{
+		public:
+			using Options = StreamPartResolverOptions;
+			typedef std::function<std::unique_ptr<Stream>(const std::wstring& part_name, const std::wstring& full_name, int index)> opener_t;
+
+			/// @brief Constructs a resolver.
+			/// @param opener The function that opens a part; it may return nullptr or throw if the part does not exist.
+			/// @param options The prefetch and cache configuration.
+			/// @throws std::invalid_argument if the opener is empty.
+			explicit StreamPartResolver(const opener_t& opener, const Options& options = Options());
+
+			/// @brief Returns a stream over the requested part, opening it if it is not cached.
+			/// @param part_name The name of the requested part.
+			/// @param full_name The full path of the requested part.
+			/// @param index The index of the requested part.
+			/// @return A stream over the part, or nullptr if it could not be opened.
+			std::unique_ptr<Stream> operator()(const std::wstring& part_name, const std::wstring& full_name, int index) const;
+
+			/// @brief Drops all cached parts. Streams already handed out stay valid.
+			void clear();
+		private:
+			class impl_t;
+			std::shared_ptr<impl_t> m_impl;
+		};
+
+		/// @brief A single operation recorded by a TracingStream.
+		struct IoTraceEvent
+		{
+			enum class Kind
+			{
+				Read,
+				Seek,
+			};
+
+			Kind kind = Kind::Read;     ///< The operation.
+			uint64_t offset = 0;        ///< For reads, the position read from; for seeks, the position before seeking.
+			uint64_t length = 0;        ///< For reads, the bytes returned; for seeks, the position after seeking.
+			uint64_t requested = 0;     ///< For reads, the bytes asked for.
+			uint64_t timestamp_ns = 0;  ///< Time since tracing started, in nanoseconds.
+			std::thread::id thread;     ///< The thread that performed the operation.
+		};
+
+		/// @brief A histogram with power-of-two buckets.
+		///
+		/// Bucket 0 counts zero values and bucket n counts values in [2^(n-1), 2^n).
+		typedef std::array<uint64_t, 65> IoTraceHistogram;
+
+		/// @brief Aggregated access pattern of a stream, as recorded by a TracingStream.
+		struct IoTraceStats
+		{
+			uint64_t reads = 0;             ///< Number of reads.
+			uint64_t seeks = 0;             ///< Number of seeks.
+			uint64_t sequential_reads = 0;  ///< Reads that started where the previous read ended.
+			uint64_t bytes_read = 0;        ///< Total bytes returned by reads, counting repeated ranges each time.
+			uint64_t unique_bytes = 0;      ///< Distinct bytes of the stream that were read at least once.
+			uint64_t stream_size = 0;       ///< Size of the traced stream.
+			IoTraceHistogram read_sizes = {};      ///< Histogram of the bytes returned by reads.
+			IoTraceHistogram seek_distances = {};  ///< Histogram of the gap between the end of a read and the start of the next non-sequential read.
+			std::vector<IoTraceEvent> events;      ///< The most recent events, oldest first.
+			uint64_t dropped_events = 0;    ///< Events overwritten because the ring buffer was full.
+
+			/// @brief Returns the bytes read per byte of the stream; 1.0 means the stream was read exactly once.
+			double readAmplification() const { return stream_size ? static_cast<double>(bytes_read) / static_cast<double>(stream_size) : 0.0; }
+			/// @brief Returns the bytes read per distinct byte read, which excludes parts of the stream never touched.
+			double rereadFactor() const { return unique_bytes ? static_cast<double>(bytes_read) / static_cast<double>(unique_bytes) : 0.0; }
+		};
+
+		/// @brief Options controlling a TracingStream.
+		struct TracingStreamOptions
+		{
+			size_t capacity = 4096; ///< Number of events kept in the ring buffer; 0 keeps only the aggregates.
 		};
 
-		/// @brief A class for handling file streams, inheriting from the Stream class.
-		class FileStream : public Stream
+		/// @brief A read-only stream that records the reads and seeks made through it.
+		///
+		/// Every operation is recorded with its offset, length, timestamp and thread in a ring buffer that is
+		/// allocated up front, so tracing does not allocate while the engine reads. Aggregates such as read
+		/// amplification and the read size and seek distance histograms cover the whole lifetime of the stream,
+		/// including events that have dropped out of the ring buffer.
+		class TracingStream : public Stream
 		{
 		public:
-			FileStream(std::istream* stream, bool own_stream);
-			FileStream(std::iostream* stream, bool own_stream);
-			FileStream(FILE* stream, bool own_stream);
-			FileStream(const std::string& filename);
-			FileStream(const std::wstring& filename);
-			~FileStream() override;
+			using Options = TracingStreamOptions;
 
-			/// @brief Seeks to a specific position in the stream.
+			/// @brief Constructs a tracing stream.
+			/// @param stream The stream to read from.
+			/// @param own_stream Whether the tracing stream deletes the inner stream when destroyed.
+			/// @param options The tracing configuration.
+			/// @throws std::invalid_argument if the stream is null.
+			TracingStream(Stream* stream, bool own_stream, const Options& options = Options());
+			~TracingStream() override;
+
+			/// @brief Seeks to a specific position in the inner stream and records it.
 			/// @param offset The position to seek to.
 			/// @param way The direction to seek (beginning, current, end).
 			/// @return The new position in the stream.
 			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override;
 
-			/// @brief Reads data from the stream into a buffer.
+			/// @brief Reads data from the inner stream and records it.
 			/// @param buffer The buffer to read data into.
 			/// @param size The number of bytes to read.
 			/// @return The number of bytes actually read.
 			size_t read(void* buffer, size_t size) override;
 
-			/// @brief Writes data from a buffer to the stream.
-			/// @param buffer The buffer containing data to write.
-			/// @param size The number of bytes to write.
-			/// @return The number of bytes actually written (default is 0).
-			size_t write(const void* buffer, size_t size) override;
+			/// @brief Forwards part requests to the wrapped stream.
+			/// @param part_name The name of the requested part.
+			/// @param full_name The full path of the requested part.
+			/// @param index The index of the requested part.
+			/// @return The wrapped stream's answer.
+			std::unique_ptr<Stream> get_stream_part(const std::wstring& part_name, const std::wstring& full_name, int index) override;
 
-			/// @brief Relinquishes ownership of the underlying IGR_Stream.
-			/// @return A pointer to the relinquished IGR_Stream.
-			IGR_Stream* relinquish_igr_stream() override;
+			/// @brief Returns the aggregates and the events currently in the ring buffer.
+			/// @return A snapshot of the trace.
+			IoTraceStats getStats() const;
 
-			/// @brief Closes the stream.
-			void close();
+			/// @brief Clears the events and aggregates and restarts the clock.
+			void reset();
 		protected:
-			IGR_Writable_Stream* m_inner = nullptr;
+			class impl_t;
+			std::unique_ptr<impl_t> m_impl;
 		};
 
 		/// @brief Represents a color with red, green, blue, and alpha components.
@@ -1436,6 +3129,18 @@ namespace Hyland
 		class Option
 		{
 		public:
+			/// @brief Constructs an Option object with the given parameters.
+			/// @param display_name The display name of the option.
+			/// @param description The description of the option.
+			/// @param default_value The default value of the option.
+			/// @param type The type of the option.
+			/// @param flags The flags associated with the option.
+			/// @param possible_values The possible values for the option.
+			Option(const std::wstring& display_name, const std::wstring& description, const std::wstring& default_value, const std::wstring& type, uint32_t flags, const std::vector<std::wstring>& possible_values)
+				: m_display_name(display_name), m_description(description), m_default_value(default_value), m_type(type), m_flags(flags), m_possible_values(possible_values)
+			{
+			}
+
 			/// @brief Constructs an Option object with the given index.
 			/// @param index The index of the option.
 			Option(uint32_t index);
@@ -1577,6 +3282,92 @@ namespace Hyland
 			uint32_t m_file_type_category = 0; ///< The file type category of the format.
 		};
 
+		/// @brief Indexed view of the formats and options supported by the engine.
+		/// Formats are probed one ID at a time as they are asked for, and the full tables are only built when a
+		/// lookup needs them. Lookups by ID, short name, MIME type and option name are hashed. The tables can be
+		/// saved to a cache file and loaded back by a later process running the same engine version, which skips
+		/// the probing entirely.
+		class Registry
+		{
+		public:
+			/// @brief Gets the version of the engine the registry describes.
+			/// @return The version reported by the engine when it was initialized.
+			const std::string& getEngineVersion() const;
+
+			/// @brief Retrieves every format supported by the engine.
+			/// @return A constant reference to the formats, in ID order. Valid until the next successful LoadFrom.
+			const std::vector<Format>& getFormats() const;
+
+			/// @brief Retrieves every option supported by the engine.
+			/// @return A constant reference to the options, in engine order. Valid until the next successful LoadFrom.
+			const std::vector<Option>& getOptions() const;
+
+			/// @brief Finds a format by ID. Only that ID is probed if the format table has not been built yet.
+			/// @param id The ID of the format.
+			/// @return The format, or nullptr if the engine does not know the ID. Valid until the next successful LoadFrom.
+			const Format* findFormat(uint32_t id) const;
+
+			/// @brief Finds a format by short name, ignoring case.
+			/// @param short_name The short name of the format.
+			/// @return The format, or nullptr if there is no match. Valid until the next successful LoadFrom.
+			const Format* findFormatByShortName(const std::wstring& short_name) const;
+
+			/// @brief Finds the first format with the given MIME type, ignoring case.
+			/// @param mime_type The MIME type of the format.
+			/// @return The format, or nullptr if there is no match. Valid until the next successful LoadFrom.
+			const Format* findFormatByMimeType(const std::wstring& mime_type) const;
+
+			/// @brief Finds an option by name, ignoring case.
+			/// @param name The name of the option.
+			/// @return The option, or nullptr if there is no match. Valid until the next successful LoadFrom.
+			const Option* findOption(const std::wstring& name) const;
+
+			/// @brief Finds the canvas type that writes files with the given extension.
+			/// @param extension The extension, with or without the leading dot, in any case.
+			/// @return The canvas type, or an empty optional if no canvas writes that extension.
+			static std::optional<CanvasType> findCanvasType(const std::string& extension);
+
+			/// @brief Finds the canvas type that writes files with the given extension.
+			/// @param extension The extension, with or without the leading dot, in any case.
+			/// @return The canvas type, or an empty optional if no canvas writes that extension.
+			static std::optional<CanvasType> findCanvasType(const std::wstring& extension);
+
+			/// @brief Replaces the tables with the ones stored in a cache file.
+			/// @param filename The cache file written by SaveTo.
+			/// @return True if the cache was loaded; false if it is missing, unreadable, or was written by a different
+			/// engine version, in which case the registry is left unchanged. References returned by getFormats,
+			/// getOptions and the find functions before a successful load are invalidated.
+			bool LoadFrom(const std::wstring& filename);
+
+			/// @brief Builds the full tables and writes them to a cache file.
+			/// @param filename The cache file to write.
+			/// @throws std::runtime_error if the file cannot be written.
+			void SaveTo(const std::wstring& filename) const;
+
+		private:
+			friend class DocumentFilters;
+			friend class Extractor;
+
+			/// @brief Constructs an empty registry. Used by DocumentFilters.
+			Registry();
+
+			/// @brief Marks the registry as usable once the engine is initialized, and makes it the one Extractor
+			/// looks formats up in.
+			/// @param engine_version The version reported by the engine.
+			void DoAttach(const std::string& engine_version);
+
+			/// @brief Copies a property of a format from the most recently attached registry. Used by Extractor.
+			/// @param id The ID of the format.
+			/// @param what The property to copy.
+			/// @param result Receives the property.
+			/// @return True if the property was copied; false if no registry is attached, the format is unknown, or
+			/// the registry does not keep that property.
+			static bool DoFetchAttached(uint32_t id, Format::What what, std::wstring& result);
+
+			class impl_t;
+			std::shared_ptr<impl_t> m_impl;
+		};
+
 
 		/// @brief Enum representing the getType of comparison to perform.
 		enum class CompareType
@@ -1952,6 +3743,13 @@ namespace Hyland
 			std::shared_ptr<impl_t> m_impl;
 		};
 
+		/// @brief The start of a document's text, as returned by Extractor::getTextPrefix and ExtractTextPrefix.
+		struct TextPrefix
+		{
+			std::wstring text; ///< The text, at most the requested number of UTF-16 code units.
+			bool truncated = false; ///< True if the document has more text after the prefix.
+		};
+
 		/// @brief The `Extractor` class provides functionality for handling and processing documents, including opening, saving, copying, retrieving metadata, and managing callbacks for various events.
 		class Extractor
 		{
@@ -1964,12 +3762,20 @@ namespace Hyland
 			typedef std::function<bool(const std::wstring&)> approve_external_resource_callback_t;
 			typedef std::function<std::unique_ptr<Stream>(const std::wstring&)> get_resource_stream_callback_t;
 			typedef std::function<bool(OcrImage&)> ocr_image_callback_t;
+			typedef std::function<std::unique_ptr<Stream>(const std::wstring&, const std::wstring&, int)> stream_part_callback_t;
 			typedef lazy_loader_indexed<Page> pages_t;
 			typedef enumerable_t<Subfile> subfiles_t;
 
 
 			Extractor();
 			Extractor(IGR_Stream* stream);
+
+			/// @brief Constructs an extractor over a raw bitmap. The pixels are not copied; see PixelBufferView
+			/// for how long they must stay valid. Open hands them to the engine with IGR_Open_DIB, which does
+			/// not report open callbacks.
+			/// @param bitmap The bitmap.
+			/// @throws std::invalid_argument if the bitmap is empty or its buffer is smaller than stride * height.
+			explicit Extractor(const PixelBufferView& bitmap);
 			virtual ~Extractor() {};
 
 			IGR_HDOC getHandle() const;
@@ -1992,6 +3798,58 @@ namespace Hyland
 			/// @param callback The callback function to be called after the document is opened. Default is an empty callback.
 			void Open(uint32_t open_flags = IGR_BODY_AND_META, const std::wstring& option = std::wstring(), const DocumentFilters::open_callback_t& callback = nullptr);
 
+			/// Opens a document like Open, reporting a failure of the engine in the result instead of throwing.
+			///
+			/// Corrupt, encrypted and unsupported documents come back as a failed result, which avoids the cost of an
+			/// exception when many of them are expected.
+			///
+			/// @param mode The open mode for the document.
+			/// @param open_flags The open flags for the document. Default value is IGR_BODY_AND_META.
+			/// @param option The additional options for opening the document. Default value is an empty string.
+			/// @param callback The callback function to be called after the document is opened. Default value is an empty function.
+			/// @return The outcome of the call.
+			Result<void> TryOpen(OpenMode mode, uint32_t open_flags = IGR_BODY_AND_META, const std::wstring& option = std::wstring(), const DocumentFilters::open_callback_t& callback = nullptr);
+
+			/// Opens a document like Open, reporting a failure of the engine in the result instead of throwing.
+			///
+			/// @param open_flags The flags indicating which parts of the document to open. Default is IGR_BODY_AND_META.
+			/// @param option The option for opening the document. Default is an empty string.
+			/// @param callback The callback function to be called after the document is opened. Default is an empty callback.
+			/// @return The outcome of the call.
+			Result<void> TryOpen(uint32_t open_flags = IGR_BODY_AND_META, const std::wstring& option = std::wstring(), const DocumentFilters::open_callback_t& callback = nullptr);
+
+			/// Opens a document with the specified mode and a prepared option set.
+			///
+			/// @param mode The open mode for the document.
+			/// @param open_flags The open flags for the document.
+			/// @param options The options for opening the document.
+			/// @param callback The callback function to be called after the document is opened. Default value is an empty function.
+			void Open(OpenMode mode, uint32_t open_flags, const OptionSet& options, const DocumentFilters::open_callback_t& callback = nullptr);
+
+			/// Opens a document with the specified open flags and a prepared option set.
+			///
+			/// @param open_flags The flags indicating which parts of the document to open.
+			/// @param options The options for opening the document.
+			/// @param callback The callback function to be called after the document is opened. Default is an empty callback.
+			void Open(uint32_t open_flags, const OptionSet& options, const DocumentFilters::open_callback_t& callback = nullptr);
+
+			/// Opens a document with a prepared option set, reporting a failure of the engine in the result instead of throwing.
+			///
+			/// @param mode The open mode for the document.
+			/// @param open_flags The open flags for the document.
+			/// @param options The options for opening the document.
+			/// @param callback The callback function to be called after the document is opened. Default value is an empty function.
+			/// @return The outcome of the call.
+			Result<void> TryOpen(OpenMode mode, uint32_t open_flags, const OptionSet& options, const DocumentFilters::open_callback_t& callback = nullptr);
+
+			/// Opens a document with a prepared option set, reporting a failure of the engine in the result instead of throwing.
+			///
+			/// @param open_flags The flags indicating which parts of the document to open.
+			/// @param options The options for opening the document.
+			/// @param callback The callback function to be called after the document is opened. Default is an empty callback.
+			/// @return The outcome of the call.
+			Result<void> TryOpen(uint32_t open_flags, const OptionSet& options, const DocumentFilters::open_callback_t& callback = nullptr);
+
 			/// @brief Retrieves the file getType.
 			///
 			/// @return The file getType as a 32-bit unsigned integer.
@@ -2005,7 +3863,8 @@ namespace Hyland
 			/// @brief Retrieves the file getType as a wide string.
 			///
 			/// @param what The getType of file getType to retrieve.
-			/// @return The file getType as a wide string.
+			/// @return The file getType as a wide string. Names, MIME types and categories come from the format
+			/// registry; the other properties are fetched from the engine.
 			std::wstring getFileType(Format::What what) const;
 
 			/// @brief Retrieves the MIME getType of the document.
@@ -2037,6 +3896,110 @@ namespace Hyland
 			 */
 			std::wstring getText(size_t max_length, bool strip_control_chars = false);
 
+			/// @brief Retrieves the next block of text into a caller-owned UTF-16 string.
+			///
+			/// The string is resized to hold the text and keeps its capacity, so reusing it across calls avoids
+			/// allocating for each block. A surrogate pair may be split between two blocks.
+			///
+			/// @param text Receives the text.
+			/// @param max_length The maximum number of UTF-16 code units to retrieve.
+			/// @param strip_control_chars Flag indicating whether to strip control characters from the text.
+			/// @return The number of code units retrieved; 0 at the end of the text.
+			size_t getText(std::u16string& text, size_t max_length, bool strip_control_chars = false);
+
+			/// @brief Retrieves the next block of text into a caller-owned string, encoded as UTF-8.
+			///
+			/// The text is converted straight from the engine's UTF-16 without an intermediate wide string, and
+			/// the string keeps its capacity between calls. A surrogate pair split between two blocks is held
+			/// back and written with the next block, so the concatenated blocks are always valid UTF-8. A held back
+			/// surrogate is returned first by the UTF-16 overloads if the caller switches to them.
+			///
+			/// @param text Receives the UTF-8 text.
+			/// @param max_length The maximum number of UTF-16 code units to retrieve.
+			/// @param strip_control_chars Flag indicating whether to strip control characters from the text.
+			/// @return The number of bytes written to text; 0 only at the end of the text.
+			size_t getText(std::string& text, size_t max_length, bool strip_control_chars = false);
+
+			/// @brief Retrieves the next block of text into a caller-owned UTF-16 buffer.
+			///
+			/// @param buffer The buffer to receive the text, which is followed by a terminating zero.
+			/// @param buffer_size The size of the buffer in code units, including room for the terminating zero.
+			/// @param strip_control_chars Flag indicating whether to strip control characters from the text.
+			/// @return The number of code units retrieved, not counting the terminating zero; 0 at the end of the text.
+			/// @throws std::invalid_argument if the buffer is null or has room for fewer than 2 code units.
+			size_t getText(char16_t* buffer, size_t buffer_size, bool strip_control_chars = false);
+
+			/// @brief Retrieves the next block of text like getText, reporting a failure of the engine in the result
+			/// instead of throwing.
+			///
+			/// @param buffer The buffer to receive the text, which is followed by a terminating zero.
+			/// @param buffer_size The size of the buffer in code units, including room for the terminating zero.
+			/// @param strip_control_chars Flag indicating whether to strip control characters from the text.
+			/// @return The number of code units retrieved, not counting the terminating zero; 0 at the end of the text.
+			/// @throws std::invalid_argument if the buffer is null or has room for fewer than 2 code units.
+			Result<size_t> TryGetText(char16_t* buffer, size_t buffer_size, bool strip_control_chars = false);
+
+			/// @brief Retrieves the next block of text into a caller-owned UTF-16 string, reporting a failure of the
+			/// engine in the result instead of throwing.
+			///
+			/// @param text Receives the text.
+			/// @param max_length The maximum number of UTF-16 code units to retrieve.
+			/// @param strip_control_chars Flag indicating whether to strip control characters from the text.
+			/// @return The number of code units retrieved; 0 at the end of the text.
+			Result<size_t> TryGetText(std::u16string& text, size_t max_length, bool strip_control_chars = false);
+
+			/// @brief Reads text from the current position until max_length code units have been produced or the
+			/// text ends, whichever comes first.
+			///
+			/// The engine is asked for no more than one code unit past the limit, which is how a truncated prefix is
+			/// told apart from one that ends exactly at the limit. A surrogate pair cut by the limit is left out
+			/// whole. Text read past the limit is kept and returned first by the next getText or getTextPrefix call,
+			/// so reading can carry on from the end of the prefix. The string keeps its capacity between calls.
+			///
+			/// @param text Receives the text.
+			/// @param max_length The maximum number of UTF-16 code units to produce.
+			/// @param strip_control_chars Flag indicating whether to strip control characters from the text. Stripped
+			/// characters do not count towards the limit.
+			/// @return True if the document has more text after the prefix.
+			bool getTextPrefix(std::u16string& text, size_t max_length, bool strip_control_chars = false);
+
+			/// @brief Reads text from the current position until max_length code units have been produced or the
+			/// text ends, whichever comes first.
+			///
+			/// @param max_length The maximum number of UTF-16 code units to produce.
+			/// @param strip_control_chars Flag indicating whether to strip control characters from the text.
+			/// @return The text and whether the document has more after it.
+			TextPrefix getTextPrefix(size_t max_length, bool strip_control_chars = false);
+
+			/// @brief Opens the document for the cheapest possible read of the start of its text, reads it, and
+			/// closes the document again.
+			///
+			/// The document is opened in text mode with the body only, so the engine does not extract metadata, and
+			/// LIMIT_PAGES is set from max_length (one page per 256 code units, plus two) so the engine stops laying
+			/// out the document soon after the prefix, whatever its length. If the text ends before max_length under
+			/// that limit, the document is read again without it, so truncated reflects the whole document rather
+			/// than the page limit. The document is closed as soon as the prefix is read.
+			///
+			/// Pass LIMIT_PAGES in options to set the bound yourself. The document is then read once, and truncated
+			/// only covers the pages within that bound.
+			///
+			/// @param max_length The maximum number of UTF-16 code units to produce.
+			/// @param options Additional options for opening the document. A LIMIT_PAGES given here replaces the one
+			/// derived from max_length.
+			/// @param strip_control_chars Flag indicating whether to strip control characters from the text.
+			/// @return The text and whether the document has more after it.
+			TextPrefix ExtractTextPrefix(size_t max_length, const OptionSet& options = OptionSet(), bool strip_control_chars = false);
+
+			/// @brief Reads the properties of the document without decoding its body.
+			///
+			/// The document is opened in text mode with IGR_META_ONLY, the text is read only until the end of the
+			/// metadata block, and the document is closed again. Values are parsed into integers, numbers and dates
+			/// where they fit.
+			///
+			/// @param options Additional options for opening the document.
+			/// @return The properties of the document; empty if it has none.
+			Metadata getMetadata(const OptionSet& options = OptionSet());
+
 			/// @brief Returns the end-of-file status of the object.
 			///
 			/// @return true if the object has reached the end of the file, false otherwise.
@@ -2045,14 +4008,20 @@ namespace Hyland
 			/// Saves the Text of the document to a file.
 			///
 			/// @param filename The path of the file to save the object to.
-			/// @param code_page The code page to use for saving the file. Default is 65001.
-			void SaveTo(const std::wstring& filename, int code_page = 65001);
+			/// @param code_page The code page to use for saving the file: 65001 (UTF-8), 1200 or 1201 (UTF-16 LE or BE),
+			///        12000 or 12001 (UTF-32 LE or BE). Default is 65001, which is also used for any other value.
+			/// @param strip_control_chars Flag indicating whether to strip control characters from the Text.
+			void SaveTo(const std::wstring& filename, int code_page = 65001, bool strip_control_chars = false);
 
 			/// Saves the Text of the document to a stream.
 			///
+			/// The text is converted from the engine's UTF-16 to the code page in a single pass and written in large
+			/// blocks. Unpaired surrogates are written as U+FFFD.
+			///
 			/// @param stream The stream to save the object to.
 			/// @param code_page The code page to use for saving the file. Default is 65001.
-			void SaveTo(std::ostream& Stream, int code_page = 65001);
+			/// @param strip_control_chars Flag indicating whether to strip control characters from the Text.
+			void SaveTo(std::ostream& Stream, int code_page = 65001, bool strip_control_chars = false);
 
 			/// Copies the bytes of the document to a file.
 			///
@@ -2079,6 +4048,38 @@ namespace Hyland
 			/// @return The SHA1 hash of the document as a wide string.
 			std::wstring getHashSHA1();
 
+			/// @brief Wraps the input stream in a HashingStream so the document is hashed while it is processed.
+			///
+			/// Must be called before the document is opened. getDigests then only reads the parts of the
+			/// input the engine did not.
+			///
+			/// @param options The hashing configuration.
+			/// @throws DocumentFilters::Error if the document is already open.
+			void enableHashing(const HashingStreamOptions& options = HashingStreamOptions());
+
+			/// @brief Retrieves the MD5, SHA-1, SHA-256 and XXH3 digests of the document.
+			///
+			/// If enableHashing was called this completes the running hashes, otherwise all digests are
+			/// computed in a single read of the input stream.
+			///
+			/// @return The digests of the document.
+			StreamDigests getDigests();
+
+			/// @brief Wraps the input stream in a TracingStream that records how the engine reads the document.
+			///
+			/// Must be called before the document is opened. Use getIoTrace to find formats that read the
+			/// input in a pathological pattern, or to size caches and read-ahead from measurements.
+			///
+			/// @param options The tracing configuration.
+			/// @throws DocumentFilters::Error if the document is already open.
+			void enableTracing(const TracingStreamOptions& options = TracingStreamOptions());
+
+			/// @brief Returns the I/O trace recorded since enableTracing was called.
+			///
+			/// @return A snapshot of the trace.
+			/// @throws DocumentFilters::Error if tracing is not enabled.
+			IoTraceStats getIoTrace() const;
+
 			/// @brief Returns the number of pages in the document.
 			///
 			/// @return The number of pages in the document.
@@ -2090,6 +4091,19 @@ namespace Hyland
 			/// @return The page at the specified index.
 			Page getPage(size_t index) const;
 
+			/// @brief Returns the number of pages like getPageCount, reporting a failure of the engine in the result
+			/// instead of throwing.
+			///
+			/// @return The number of pages in the document.
+			Result<size_t> TryGetPageCount() const;
+
+			/// Retrieves the page at the specified index like getPage, reporting a failure of the engine in the result
+			/// instead of throwing. An index past the last page is reported by the engine.
+			///
+			/// @param index The index of the page to retrieve.
+			/// @return The page at the specified index.
+			Result<Page> TryGetPage(size_t index) const;
+
 			/// @brief Returns the pages of the document.
 			///
 			/// @return A constant reference to the pages of the document.
@@ -2117,6 +4131,22 @@ namespace Hyland
 			/// @return The subfile object representing the image.
 			Subfile getImage(const std::wstring& id) const;
 
+			/// Retrieves the subfile with the specified ID like getSubFile, reporting a failure of the engine in the
+			/// result instead of throwing.
+			///
+			/// @param id The ID of the subfile to retrieve.
+			/// @return The subfile object with the specified ID.
+			/// @throws std::invalid_argument if the ID is empty.
+			Result<Subfile> TryGetSubFile(const std::wstring& id) const;
+
+			/// Retrieves the image with the specified ID like getImage, reporting a failure of the engine in the
+			/// result instead of throwing.
+			///
+			/// @param id The ID of the image to retrieve.
+			/// @return The subfile object representing the image.
+			/// @throws std::invalid_argument if the ID is empty.
+			Result<Subfile> TryGetImage(const std::wstring& id) const;
+
 			/// Sets the password callback function.
 			///
 			/// @param callback The callback function to be set.
@@ -2156,6 +4186,16 @@ namespace Hyland
 			/// @param callback The callback function to be set for OCR image processing.
 			void setOcrImageCallback(const ocr_image_callback_t& callback);
 
+			/// @brief Sets the callback that opens the other parts of a multi-volume document, such as split archives.
+			///
+			/// The callback receives the name, full path and index of the part the engine needs, and returns a
+			/// stream over it or nullptr. A StreamPartResolver can be used to add caching and prefetching. Must be
+			/// called before the document is opened.
+			///
+			/// @param callback The callback function to be called when a stream part is requested.
+			/// @throws DocumentFilters::Error if the document is already open.
+			void setStreamPartCallback(const stream_part_callback_t& callback);
+
 			/// Retrieves the bookmarks in the document.
 			///
 			/// @return The bookmarks in the document.
@@ -2200,6 +4240,9 @@ namespace Hyland
 			virtual IGR_Stream* resolve_stream() const;
 			IGR_Stream* need_stream() const;
 
+			/// @brief Opens the document with options already encoded for the engine.
+			Result<void> DoOpen(uint32_t open_flags, const IGR_UCS2* options, const DocumentFilters::open_callback_t& callback);
+
 		protected:
 			class impl_t;
 			std::shared_ptr<impl_t> m_impl;
@@ -2280,6 +4323,151 @@ namespace Hyland
 		};
 
 
+		/// @brief The words of a page, stored column by column.
+		///
+		/// Positions, sizes and character offsets are each kept in their own array, and the text of every word is
+		/// kept in one UTF-16 arena with an offset per word, so scanning a column touches only that column and no
+		/// accessor allocates. The table is filled with a single IGR_Get_Page_Words call and owns its data, so it
+		/// stays valid after the page is closed.
+		class WordTable
+		{
+			friend class Page;
+
+		public:
+			/// @brief Constructs an empty table.
+			WordTable() = default;
+
+			/// @brief Gets the number of words. @return The number of words.
+			size_t size() const { return m_x.size(); }
+
+			/// @brief Checks whether the table is empty. @return True if the page has no words.
+			bool empty() const { return m_x.empty(); }
+
+			/// @brief Gets the x-coordinate of every word. @return A view of the column.
+			span_t<const int32_t> getX() const { return { m_x.data(), m_x.size() }; }
+
+			/// @brief Gets the y-coordinate of every word. @return A view of the column.
+			span_t<const int32_t> getY() const { return { m_y.data(), m_y.size() }; }
+
+			/// @brief Gets the width of every word. @return A view of the column.
+			span_t<const int32_t> getWidth() const { return { m_width.data(), m_width.size() }; }
+
+			/// @brief Gets the height of every word. @return A view of the column.
+			span_t<const int32_t> getHeight() const { return { m_height.data(), m_height.size() }; }
+
+			/// @brief Gets the character offset of every word in the text of the page. @return A view of the column.
+			span_t<const uint32_t> getCharacterOffset() const { return { m_char_offset.data(), m_char_offset.size() }; }
+
+			/// @brief Gets where the text of each word starts in the arena, followed by the end of the last word.
+			/// @return A view of size() + 1 offsets; word i is [offsets[i], offsets[i + 1]).
+			span_t<const uint32_t> getTextOffsets() const { return { m_text_offset.data(), m_text_offset.size() }; }
+
+			/// @brief Gets the text of every word, one after another.
+			/// @return A view of the arena.
+			std::u16string_view getTextArena() const { return m_text; }
+
+			/// @brief Gets the text of a word without copying it.
+			/// @param index The index of the word, less than size().
+			/// @return A view of the text in the arena.
+			std::u16string_view getText(size_t index) const { return std::u16string_view(m_text).substr(m_text_offset[index], m_text_offset[index + 1] - m_text_offset[index]); }
+
+			/// @brief Gets the bounding rectangle of a word.
+			/// @param index The index of the word, less than size().
+			/// @return The rectangle of the word.
+			RectI32 getRect(size_t index) const { return RectI32::xywh(m_x[index], m_y[index], m_width[index], m_height[index]); }
+
+		private:
+			std::vector<int32_t> m_x; ///< The x-coordinate of each word.
+			std::vector<int32_t> m_y; ///< The y-coordinate of each word.
+			std::vector<int32_t> m_width; ///< The width of each word.
+			std::vector<int32_t> m_height; ///< The height of each word.
+			std::vector<uint32_t> m_char_offset; ///< The character offset of each word.
+			std::vector<uint32_t> m_text_offset{ 0 }; ///< Where each word starts in m_text, plus the end.
+			std::u16string m_text; ///< The text of every word.
+		};
+
+		/// @brief A uniform grid over the bounding boxes of the words of a page, for region and proximity queries.
+		///
+		/// The page is divided into about one cell per word and each word is listed in every cell its box
+		/// overlaps, so a query only looks at the words in the cells it touches instead of every word on the page.
+		/// Results are word indices, the same as those of WordTable and Page::words(), and a region query returns
+		/// them in ascending order, which is the reading order of the page. Boxes are half-open; a word with no
+		/// width or height is treated as one unit wide or high. The index copies the boxes it needs, so it does not
+		/// refer to the table it was built from.
+		class WordIndex
+		{
+		public:
+			/// @brief Constructs an empty index.
+			WordIndex() = default;
+
+			/// @brief Builds the index over the words of a table.
+			/// @param table The words to index.
+			explicit WordIndex(const WordTable& table);
+
+			/// @brief Builds the index over word boxes given column by column.
+			/// @param x The x-coordinate of each word.
+			/// @param y The y-coordinate of each word.
+			/// @param width The width of each word.
+			/// @param height The height of each word.
+			/// @throws std::invalid_argument if the columns are not the same size.
+			WordIndex(span_t<const int32_t> x, span_t<const int32_t> y, span_t<const int32_t> width, span_t<const int32_t> height);
+
+			/// @brief Gets the number of words indexed. @return The number of words.
+			size_t size() const { return m_left.size(); }
+
+			/// @brief Checks whether the index is empty. @return True if there are no words.
+			bool empty() const { return m_left.empty(); }
+
+			/// @brief Finds the words whose boxes intersect a rectangle.
+			/// @param rect The rectangle, in page coordinates.
+			/// @return The indices of the words, in ascending order.
+			std::vector<size_t> wordsInRect(const RectI32& rect) const;
+
+			/// @brief Finds the words whose boxes intersect a rectangle, reusing the caller's vector.
+			/// @param rect The rectangle, in page coordinates.
+			/// @param result Receives the indices of the words, in ascending order; its previous contents are discarded.
+			///
+			/// A rectangle covering a large part of the page is answered by checking every word, which is cheaper
+			/// than going through most of the cells.
+			void wordsInRect(const RectI32& rect, std::vector<size_t>& result) const;
+
+			/// @brief Finds the word closest to a point.
+			/// @param x The x-coordinate of the point.
+			/// @param y The y-coordinate of the point.
+			/// @return The index of the word, or std::nullopt if the index is empty. A point inside a word's box is at
+			/// distance zero from it; ties go to the lower index.
+			std::optional<size_t> nearestWord(int32_t x, int32_t y) const;
+
+			/// @brief Finds the words closest to a point.
+			/// @param x The x-coordinate of the point.
+			/// @param y The y-coordinate of the point.
+			/// @param count The maximum number of words to return.
+			/// @return The indices of up to count words, nearest first; ties go to the lower index.
+			std::vector<size_t> nearestWords(int32_t x, int32_t y, size_t count) const;
+
+		private:
+			void DoBuild();
+			size_t DoColumn(int64_t x) const;
+			size_t DoRow(int64_t y) const;
+
+			std::vector<int32_t> m_left; ///< The left edge of each word.
+			std::vector<int32_t> m_top; ///< The top edge of each word.
+			std::vector<int32_t> m_right; ///< The right edge of each word, past its last unit.
+			std::vector<int32_t> m_bottom; ///< The bottom edge of each word, past its last unit.
+			std::vector<uint32_t> m_first_column; ///< The first column of cells each word is listed in.
+			std::vector<uint32_t> m_last_column; ///< The last column of cells each word is listed in.
+			std::vector<uint32_t> m_first_row; ///< The first row of cells each word is listed in.
+			std::vector<uint32_t> m_last_row; ///< The last row of cells each word is listed in.
+			int32_t m_origin_x = 0; ///< The left edge of the grid.
+			int32_t m_origin_y = 0; ///< The top edge of the grid.
+			int64_t m_cell_width = 1; ///< The width of each cell.
+			int64_t m_cell_height = 1; ///< The height of each cell.
+			size_t m_columns = 0; ///< The number of columns of cells.
+			size_t m_rows = 0; ///< The number of rows of cells.
+			std::vector<uint32_t> m_cell_start; ///< Where the words of each cell start in m_cell_words, plus the end.
+			std::vector<uint32_t> m_cell_words; ///< The words of every cell, cell after cell, in ascending order.
+		};
+
 		class Page
 		{
 			friend class Extractor;
@@ -2339,11 +4527,53 @@ namespace Hyland
 			/// @return const reference to the words in the document.
 			const words_t& words() const;
 
+			/// @brief Gets the words of the page as a column-oriented table.
+			///
+			/// Prefer this to words() for pages with many words: it is built with one call to the engine and its
+			/// accessors do not copy or allocate.
+			///
+			/// @return const reference to the table, built on first use.
+			const WordTable& getWordTable() const;
+
+			/// @brief Gets the spatial index over the words of the page.
+			///
+			/// @return const reference to the index, built from getWordTable() on first use.
+			const WordIndex& getWordIndex() const;
+
+			/// @brief Finds the words of the page that intersect a rectangle, such as an area to redact or a column.
+			///
+			/// @param rect The rectangle, in page coordinates.
+			/// @return The indices of the words in getWordTable() and words(), in reading order.
+			std::vector<size_t> wordsInRect(const RectI32& rect) const;
+
+			/// @brief Finds the word of the page closest to a point.
+			///
+			/// @param x The x-coordinate of the point.
+			/// @param y The y-coordinate of the point.
+			/// @return The index of the word, or std::nullopt if the page has no words.
+			std::optional<size_t> nearestWord(int32_t x, int32_t y) const;
+
+			/// @brief Finds the words of the page closest to a point.
+			///
+			/// @param x The x-coordinate of the point.
+			/// @param y The y-coordinate of the point.
+			/// @param count The maximum number of words to return.
+			/// @return The indices of the words, nearest first.
+			std::vector<size_t> nearestWords(int32_t x, int32_t y, size_t count) const;
+
 			/// @brief Get the root page element of the page.
 			///
 			/// @return The root page element of the page.
 			PageElement getRootPageElement() const;
 
+			/// @brief Gets a snapshot of every page element of the page.
+			///
+			/// Prefer this to walking getRootPageElement() when visiting the whole tree: the elements are read in one
+			/// enumeration, with their text and styles, and walking the tree afterwards does not call the engine.
+			///
+			/// @return const reference to the tree, built on first use.
+			const PageElementTree& getElementTree() const;
+
 			/// @brief Retrieves a collection of images.
 			/// @return A constant reference to a collection of images.
 			const images_t& images() const;
@@ -2384,6 +4614,13 @@ namespace Hyland
 			/// @param properties The properties to use for rendering the page.
 			void Render(Canvas& Canvas, std::wstring& options, const RenderPageProperties& properties) const;
 
+			/// @brief Renders the content onto the provided canvas with a prepared option set and properties.
+			///
+			/// @param canvas The canvas to render the content onto.
+			/// @param options The options to use for rendering the page.
+			/// @param properties The properties to use for rendering the page.
+			void Render(Canvas& Canvas, const OptionSet& options, const RenderPageProperties& properties) const;
+
 			/// @brief Retrieves the value of a specified attribute.
 			///
 			/// @param name The name of the attribute to retrieve.
@@ -2414,6 +4651,21 @@ namespace Hyland
 			/// @return The pixels of the page.
 			PagePixels getPixels(PixelType type, const IGR_Rect& src_rect, const IGR_Size& dest_size, const std::wstring& options = std::wstring()) const;
 
+			/// @brief Gets the pixels of the page with a specified pixel type and source rectangle.
+			/// @param type The type of pixels to retrieve.
+			/// @param src_rect The source rectangle to extract pixels from.
+			/// @param options The options for pixel extraction.
+			/// @return The pixels of the page.
+			PagePixels getPixels(PixelType type, const IGR_Rect& src_rect, const OptionSet& options) const;
+
+			/// @brief Gets the pixels of the page with a specified pixel type, source rectangle, and destination size.
+			/// @param type The type of pixels to retrieve.
+			/// @param src_rect The source rectangle to extract pixels from.
+			/// @param dest_size The destination size for the extracted pixels.
+			/// @param options The options for pixel extraction.
+			/// @return The pixels of the page.
+			PagePixels getPixels(PixelType type, const IGR_Rect& src_rect, const IGR_Size& dest_size, const OptionSet& options) const;
+
 			/// @brief Compares the current page with another page using the specified settings.
 			/// @param other The other page to compare with.
 			/// @param settings The settings to use for the comparison. Defaults to CompareSettings().
@@ -2438,6 +4690,8 @@ namespace Hyland
 		private:
 			class impl_t;
 			std::shared_ptr<impl_t> m_impl;
+
+			PagePixels DoGetPixels(PixelType type, const IGR_Rect& src_rect, const IGR_Size& dest_size, const IGR_UCS2* options) const;
 		};
 
 		class Word
@@ -2682,6 +4936,12 @@ namespace Hyland
 			/// @param properties The rendering properties.
 			void RenderPage(const Page& Page, const RenderPageProperties& properties);
 
+			/// @brief Renders a page onto the canvas with a prepared option set.
+			/// @param page The page to render.
+			/// @param options The rendering options.
+			/// @param properties Optional rendering properties.
+			void RenderPage(const Page& Page, const OptionSet& options, const RenderPageProperties& properties = RenderPageProperties());
+
 			/// @brief Renders multiple pages onto the canvas.
 			/// @param Extractor The extractor containing the pages to render.
 			void RenderPages(const Extractor& Extractor);
@@ -2691,6 +4951,12 @@ namespace Hyland
 			/// @param height The height of the blank page.
 			/// @param options Optional rendering options.
 			void BlankPage(int width, int height, const std::wstring& options = std::wstring());
+
+			/// @brief Creates a blank page on the canvas with a prepared option set.
+			/// @param width The width of the blank page.
+			/// @param height The height of the blank page.
+			/// @param options The rendering options.
+			void BlankPage(int width, int height, const OptionSet& options);
 			/// @brief Draws an arc defined by four points.
 			/// @param x The x-coordinate of the starting point.
 			/// @param y The y-coordinate of the starting point.
@@ -2900,6 +5166,9 @@ namespace Hyland
 		private:
 			class impl_t;
 			std::shared_ptr<impl_t> m_impl;
+
+			void DoRenderPage(const Page& Page, const IGR_UCS2* options, const RenderPageProperties& properties);
+			void DoBlankPage(int width, int height, const IGR_UCS2* options);
 		};
 
 		/// @brief Represents a bookmark item.
@@ -3147,6 +5416,7 @@ namespace Hyland
 		class PageElement
 		{
 			friend class Page;
+			friend class PageElementTree;
 		private:
 			class impl_t;
 			std::shared_ptr<impl_t> m_impl;
@@ -3232,6 +5502,191 @@ namespace Hyland
 			bool operator==(const PageElement& other) const;
 		};
 
+		/// @brief A snapshot of a page element and everything below it, stored as flat arrays.
+		///
+		/// The elements are read in one enumeration and kept in document order, with the parent, first child, next
+		/// sibling and depth of each as an index into the same arrays. The text of every element is kept in one
+		/// UTF-16 arena, and style names and values are stored once each in a second arena however many elements
+		/// share them. Elements are reached through Node, which is an index and a pointer to the tree; nodes are
+		/// cheap to copy and nothing is allocated while walking the tree. The tree owns its data, so it stays
+		/// valid after the page is closed.
+		class PageElementTree
+		{
+		public:
+			static constexpr uint32_t npos = 0xFFFFFFFF; ///< The index of a missing parent, child or sibling.
+
+			class child_iterator;
+
+			/// @brief A handle to one element of a PageElementTree.
+			class Node
+			{
+			public:
+				typedef child_iterator const_iterator;
+
+				/// @brief Constructs a node that refers to nothing.
+				Node() = default;
+
+				/// @brief Constructs a handle to an element of a tree.
+				/// @param tree The tree.
+				/// @param index The index of the element, or npos for none.
+				Node(const PageElementTree* tree, uint32_t index) : m_tree(index == npos ? nullptr : tree), m_index(tree == nullptr ? npos : index) {}
+
+				/// @brief Checks if the node refers to an element. @return True if it does.
+				bool ok() const { return m_tree != nullptr; }
+
+				/// @brief Conversion operator to bool. @return True if the node refers to an element.
+				explicit operator bool() const { return ok(); }
+
+				/// @brief Gets the index of the element in the tree. @return The index, or npos.
+				uint32_t getIndex() const { return m_index; }
+
+				/// @brief Gets the type of the element. @return The type of the element.
+				PageElementType getType() const { return m_tree->m_type[m_index]; }
+
+				/// @brief Gets the bounds of the element. @return The bounds of the element.
+				IGR_FRect getBounds() const { return m_tree->m_bounds[m_index]; }
+
+				/// @brief Gets the depth of the element, as reported by the engine. @return The depth of the element.
+				uint32_t getDepth() const { return m_tree->m_depth[m_index]; }
+
+				/// @brief Gets the flags of the element. @return The IGR_PAGE_ELEMENT_FLAG values of the element.
+				uint32_t getFlags() const { return m_tree->m_flags[m_index]; }
+
+				/// @brief Gets the rotation of the element. @return The rotation in degrees.
+				uint32_t getRotation() const { return m_tree->m_rotation[m_index]; }
+
+				/// @brief Gets the parent of the element. @return The parent, or a node that is not ok() for the root.
+				Node getParent() const { return Node(m_tree, m_tree->m_parent[m_index]); }
+
+				/// @brief Gets the first child of the element. @return The first child, or a node that is not ok().
+				Node getFirstChild() const { return Node(m_tree, m_tree->m_first_child[m_index]); }
+
+				/// @brief Gets the next sibling of the element. @return The next sibling, or a node that is not ok().
+				Node getNextSibling() const { return Node(m_tree, m_tree->m_next_sibling[m_index]); }
+
+				/// @brief Gets the text of the element without copying it. @return A view of the text in the arena.
+				std::u16string_view getText() const { return m_tree->DoText(m_index); }
+
+				/// @brief Gets the number of styles of the element. @return The number of styles.
+				size_t getStyleCount() const { return m_tree->m_style_start[m_index + 1] - m_tree->m_style_start[m_index]; }
+
+				/// @brief Gets a style of the element by position.
+				/// @param index The position of the style, less than getStyleCount().
+				/// @return The name and value of the style.
+				std::pair<std::u16string_view, std::u16string_view> getStyleAt(size_t index) const;
+
+				/// @brief Gets a style of the element by name.
+				/// @param name The name of the style.
+				/// @return The value of the style, or std::nullopt if the element does not have it.
+				std::optional<std::u16string_view> getStyle(std::u16string_view name) const;
+
+				/// @brief Gets an iterator to the first child. @return The iterator.
+				const_iterator begin() const { return const_iterator(getFirstChild()); }
+
+				/// @brief Gets an iterator past the last child. @return The iterator.
+				const_iterator end() const { return const_iterator(); }
+
+				bool operator==(const Node& other) const { return m_tree == other.m_tree && m_index == other.m_index; }
+				bool operator!=(const Node& other) const { return !(*this == other); }
+
+			private:
+				const PageElementTree* m_tree = nullptr;
+				uint32_t m_index = npos;
+			};
+
+			/// @brief Iterates over the children of a node.
+			class child_iterator
+			{
+			public:
+				typedef std::forward_iterator_tag iterator_category;
+				typedef Node value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef const Node* pointer;
+				typedef Node reference;
+
+				child_iterator() = default;
+				explicit child_iterator(const Node& node) : m_node(node) {}
+
+				Node operator*() const { return m_node; }
+				const Node* operator->() const { return &m_node; }
+				child_iterator& operator++() { m_node = m_node.getNextSibling(); return *this; }
+				child_iterator operator++(int) { child_iterator result = *this; ++*this; return result; }
+				bool operator==(const child_iterator& other) const { return m_node == other.m_node; }
+				bool operator!=(const child_iterator& other) const { return !(*this == other); }
+
+			private:
+				Node m_node;
+			};
+
+			/// @brief Constructs an empty tree.
+			PageElementTree() = default;
+
+			/// @brief Takes a snapshot of an element and all of its descendants.
+			/// @param root The element to start from, such as Page::getRootPageElement().
+			/// @throws DocumentFilters::Error if the elements cannot be read.
+			explicit PageElementTree(const PageElement& root);
+
+			PageElementTree(const PageElementTree&) = default;
+			PageElementTree(PageElementTree&&) = default;
+			PageElementTree& operator=(const PageElementTree&) = default;
+			PageElementTree& operator=(PageElementTree&&) = default;
+
+			/// @brief Gets the number of elements. @return The number of elements.
+			size_t size() const { return m_type.size(); }
+
+			/// @brief Checks whether the tree is empty. @return True if there are no elements.
+			bool empty() const { return m_type.empty(); }
+
+			/// @brief Gets the element the snapshot was taken from. @return The root, or a node that is not ok() if empty.
+			Node getRoot() const { return Node(this, empty() ? npos : 0); }
+
+			/// @brief Gets an element by index.
+			/// @param index The index of the element, less than size(). Elements are numbered in document order.
+			/// @return The node.
+			Node getNode(size_t index) const { return Node(this, static_cast<uint32_t>(index)); }
+
+			/// @brief Gets the parent of every element. @return A view of the column; npos for the root.
+			span_t<const uint32_t> getParents() const { return { m_parent.data(), m_parent.size() }; }
+
+			/// @brief Gets the first child of every element. @return A view of the column; npos where there is none.
+			span_t<const uint32_t> getFirstChildren() const { return { m_first_child.data(), m_first_child.size() }; }
+
+			/// @brief Gets the next sibling of every element. @return A view of the column; npos where there is none.
+			span_t<const uint32_t> getNextSiblings() const { return { m_next_sibling.data(), m_next_sibling.size() }; }
+
+			/// @brief Gets the depth of every element. @return A view of the column.
+			span_t<const uint32_t> getDepths() const { return { m_depth.data(), m_depth.size() }; }
+
+			/// @brief Gets the type of every element. @return A view of the column.
+			span_t<const PageElementType> getTypes() const { return { m_type.data(), m_type.size() }; }
+
+			/// @brief Gets the text of every element, one after another.
+			/// @return A view of the arena. Container elements repeat the text of their descendants, as
+			/// PageElement::getText does.
+			std::u16string_view getTextArena() const { return m_text; }
+
+		private:
+			class builder_t;
+
+			std::u16string_view DoText(uint32_t index) const { return std::u16string_view(m_text).substr(m_text_start[index], m_text_start[index + 1] - m_text_start[index]); }
+			std::u16string_view DoString(uint32_t id) const { return std::u16string_view(m_strings).substr(m_string_start[id], m_string_start[id + 1] - m_string_start[id]); }
+
+			std::vector<PageElementType> m_type; ///< The type of each element.
+			std::vector<uint32_t> m_flags; ///< The flags of each element.
+			std::vector<uint32_t> m_depth; ///< The depth of each element.
+			std::vector<uint32_t> m_rotation; ///< The rotation of each element.
+			std::vector<IGR_FRect> m_bounds; ///< The bounds of each element.
+			std::vector<uint32_t> m_parent; ///< The parent of each element.
+			std::vector<uint32_t> m_first_child; ///< The first child of each element.
+			std::vector<uint32_t> m_next_sibling; ///< The next sibling of each element.
+			std::vector<uint32_t> m_text_start{ 0 }; ///< Where the text of each element starts in m_text, plus the end.
+			std::u16string m_text; ///< The text of every element.
+			std::vector<uint32_t> m_style_start{ 0 }; ///< Where the styles of each element start in m_styles, plus the end.
+			std::vector<std::pair<uint32_t, uint32_t>> m_styles; ///< The name and value of each style, as string ids.
+			std::vector<uint32_t> m_string_start{ 0 }; ///< Where each style string starts in m_strings, plus the end.
+			std::u16string m_strings; ///< Every distinct style name and value.
+		};
+
 		/// @brief Represents the pixel data of a page.
 		class PagePixels
 		{
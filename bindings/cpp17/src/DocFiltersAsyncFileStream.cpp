@@ -0,0 +1,628 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef DOCFILTERS_HAVE_IO_URING
+#include <cstdlib>
+#include <linux/io_uring.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		namespace
+		{
+			constexpr size_t async_block_size = 64 * 1024;
+
+#ifdef DOCFILTERS_HAVE_IO_URING
+			constexpr unsigned ring_slots = 32;    // registered buffers per thread, 2 MB in total
+			constexpr unsigned ring_entries = 64;  // more than ring_slots, so the queues can never overflow
+
+			/** The state of the read queued into one of the buffers of a ring. */
+			struct ring_slot_t
+			{
+				int32_t result = 0;
+				bool done = true;
+				bool released = false; ///< The owner gave the slot up before its read completed.
+				struct iovec iov = {};
+			};
+
+			/** An io_uring set up with raw system calls, with a pool of registered buffers. One is created per thread
+			 *  and shared by the streams read on it; the lock is only contended when a stream moves between threads. */
+			class ring_t
+			{
+			public:
+				std::mutex m_lock;
+
+				static std::shared_ptr<ring_t> for_this_thread()
+				{
+					thread_local std::shared_ptr<ring_t> ring;
+					thread_local bool attempted = false;
+					if (!attempted)
+					{
+						attempted = true;
+						try
+						{
+							ring = std::make_shared<ring_t>();
+						}
+						catch (const std::exception&)
+						{
+							ring.reset();
+						}
+					}
+					return ring;
+				}
+
+				ring_t()
+				{
+					io_uring_params params;
+					memset(&params, 0, sizeof(params));
+					m_fd = static_cast<int>(syscall(__NR_io_uring_setup, ring_entries, &params));
+					if (m_fd < 0)
+						throw std::runtime_error("io_uring is not available");
+
+					m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+					m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+					bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+					if (single_mmap)
+						m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+
+					m_sq = mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+					if (m_sq == MAP_FAILED)
+					{
+						m_sq = nullptr;
+						close();
+						throw std::runtime_error("Failed to map io_uring");
+					}
+					m_cq = single_mmap ? m_sq : mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+					m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+					m_sqes = m_cq == MAP_FAILED ? MAP_FAILED : mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+					if (m_cq == MAP_FAILED || m_sqes == MAP_FAILED)
+					{
+						if (m_cq == MAP_FAILED)
+							m_cq = nullptr;
+						if (m_sqes == MAP_FAILED)
+							m_sqes = nullptr;
+						close();
+						throw std::runtime_error("Failed to map io_uring");
+					}
+
+					auto sq = static_cast<uint8_t*>(m_sq);
+					m_sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+					m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+					m_sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+					m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+					auto cq = static_cast<uint8_t*>(m_cq);
+					m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+					m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+					m_cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+					m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+					if (posix_memalign(&m_buffers, 4096, ring_slots * async_block_size) != 0)
+					{
+						m_buffers = nullptr;
+						close();
+						throw std::runtime_error("Failed to allocate io_uring buffers");
+					}
+
+					// Registration pins the buffers, which can fail under a low RLIMIT_MEMLOCK; plain vectored reads still work
+					std::vector<struct iovec> iovs(ring_slots);
+					m_slots.resize(ring_slots);
+					for (unsigned i = 0; i < ring_slots; ++i)
+					{
+						iovs[i].iov_base = slot_data(i);
+						iovs[i].iov_len = async_block_size;
+						m_free_slots.push_back(i);
+					}
+					m_fixed = syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_BUFFERS, iovs.data(), ring_slots) == 0;
+				}
+
+				~ring_t()
+				{
+					// The kernel may still write into the buffers; wait for every read, and if the ring cannot be
+					// waited on, leak the buffers rather than free memory that is being written to
+					while (m_in_flight > 0 && enter(1))
+						reap();
+					if (m_in_flight > 0)
+						m_buffers = nullptr;
+					close();
+				}
+
+				uint8_t* slot_data(size_t slot) const
+				{
+					return static_cast<uint8_t*>(m_buffers) + slot * async_block_size;
+				}
+
+				bool acquire_slot(size_t& slot)
+				{
+					if (m_free_slots.empty())
+						return false;
+					slot = m_free_slots.back();
+					m_free_slots.pop_back();
+					return true;
+				}
+
+				/** Gives a slot back. A slot whose read is still in flight is only reused once its completion is reaped,
+				 *  since the kernel may still write into its buffer. */
+				void release_slot(size_t slot)
+				{
+					reap();
+					if (m_slots[slot].done)
+						m_free_slots.push_back(slot);
+					else
+						m_slots[slot].released = true;
+				}
+
+				/** Adds a read to the submission queue; it is sent to the kernel by the next submit or wait. */
+				void queue(int fd, size_t slot, uint64_t offset, size_t length)
+				{
+					ring_slot_t& request = m_slots[slot];
+					unsigned tail = *m_sq_tail;
+					unsigned index = tail & m_sq_mask;
+					io_uring_sqe* sqe = static_cast<io_uring_sqe*>(m_sqes) + index;
+					memset(sqe, 0, sizeof(*sqe));
+
+					request.done = false;
+					request.released = false;
+					request.result = 0;
+					sqe->fd = fd;
+					sqe->off = offset;
+					sqe->user_data = slot;
+					if (m_fixed)
+					{
+						sqe->opcode = IORING_OP_READ_FIXED;
+						sqe->addr = reinterpret_cast<uint64_t>(slot_data(slot));
+						sqe->len = static_cast<uint32_t>(length);
+						sqe->buf_index = static_cast<uint16_t>(slot);
+					}
+					else
+					{
+						request.iov.iov_base = slot_data(slot);
+						request.iov.iov_len = length;
+						sqe->opcode = IORING_OP_READV;
+						sqe->addr = reinterpret_cast<uint64_t>(&request.iov);
+						sqe->len = 1;
+					}
+
+					m_sq_array[index] = index;
+					__atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+					++m_unsubmitted;
+					++m_in_flight;
+				}
+
+				void submit()
+				{
+					enter(0);
+				}
+
+				/** Waits for the read of a slot. Returns its result, or -EIO if the ring failed; the read may then still
+				 *  be in flight, so the slot stays busy until its completion arrives. */
+				int32_t wait(size_t slot)
+				{
+					reap();
+					while (!m_slots[slot].done)
+					{
+						if (!enter(1))
+							return -EIO;
+						reap();
+					}
+					return m_slots[slot].result;
+				}
+
+			private:
+				int m_fd = -1;
+				void* m_sq = nullptr;
+				void* m_cq = nullptr;
+				void* m_sqes = nullptr;
+				size_t m_sq_size = 0;
+				size_t m_cq_size = 0;
+				size_t m_sqes_size = 0;
+				unsigned* m_sq_head = nullptr;
+				unsigned* m_sq_tail = nullptr;
+				unsigned* m_sq_array = nullptr;
+				unsigned m_sq_mask = 0;
+				unsigned* m_cq_head = nullptr;
+				unsigned* m_cq_tail = nullptr;
+				unsigned m_cq_mask = 0;
+				io_uring_cqe* m_cqes = nullptr;
+				unsigned m_unsubmitted = 0;
+				size_t m_in_flight = 0;
+
+				void* m_buffers = nullptr;
+				bool m_fixed = false;
+				std::vector<size_t> m_free_slots;
+				std::vector<ring_slot_t> m_slots;
+
+				bool enter(unsigned min_complete)
+				{
+					for (;;)
+					{
+						unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+						long res = syscall(__NR_io_uring_enter, m_fd, m_unsubmitted, min_complete, flags, nullptr, 0);
+						if (res >= 0)
+						{
+							m_unsubmitted -= std::min<unsigned>(m_unsubmitted, static_cast<unsigned>(res));
+							return true;
+						}
+						if (errno == EINTR)
+							continue;
+						// EAGAIN and EBUSY mean completions have to be reaped before more can be submitted
+						return (errno == EAGAIN || errno == EBUSY) && min_complete == 0;
+					}
+				}
+
+				void reap()
+				{
+					unsigned head = *m_cq_head;
+					unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+					while (head != tail)
+					{
+						const io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+						auto slot = static_cast<size_t>(cqe.user_data);
+						ring_slot_t& request = m_slots[slot];
+						request.result = cqe.res;
+						request.done = true;
+						--m_in_flight;
+						if (request.released)
+						{
+							request.released = false;
+							m_free_slots.push_back(slot);
+						}
+						++head;
+					}
+					__atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+				}
+
+				void close()
+				{
+					if (m_buffers)
+						free(m_buffers);
+					if (m_sqes)
+						munmap(m_sqes, m_sqes_size);
+					if (m_cq && m_cq != m_sq)
+						munmap(m_cq, m_cq_size);
+					if (m_sq)
+						munmap(m_sq, m_sq_size);
+					if (m_fd >= 0)
+						::close(m_fd);
+					m_buffers = m_sqes = m_cq = m_sq = nullptr;
+					m_fd = -1;
+				}
+			};
+
+			/** A block of the file being read, or already read, into a ring buffer. */
+			struct async_block_t
+			{
+				std::shared_ptr<ring_t> ring;
+				size_t slot = 0;
+				size_t length = 0;
+				bool ready = false; ///< The read completed in full; only touched by the stream that owns the block.
+
+				~async_block_t()
+				{
+					std::lock_guard<std::mutex> lock(ring->m_lock);
+					ring->release_slot(slot);
+				}
+
+				/** Waits for the read; returns false if it failed or came back short. */
+				bool wait()
+				{
+					if (!ready)
+					{
+						std::lock_guard<std::mutex> lock(ring->m_lock);
+						ready = ring->wait(slot) == static_cast<int32_t>(length);
+					}
+					return ready;
+				}
+
+				const uint8_t* data() const
+				{
+					return ring->slot_data(slot);
+				}
+			};
+#endif
+		} // namespace
+
+		class AsyncFileStream::impl_t
+		{
+		public:
+#ifdef _WIN32
+			HANDLE m_file = INVALID_HANDLE_VALUE;
+#else
+			int m_fd = -1;
+#endif
+			Options m_options;
+			Stats m_stats;
+			uint64_t m_size = 0;
+			uint64_t m_offset = 0;
+			uint64_t m_last_end = 0;
+#ifdef DOCFILTERS_HAVE_IO_URING
+			std::map<uint64_t, std::unique_ptr<async_block_t>> m_blocks;
+#endif
+
+			impl_t(const std::wstring& filename, const Options& options)
+				: m_options(options)
+			{
+#ifdef _WIN32
+				m_file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (m_file == INVALID_HANDLE_VALUE)
+					throw std::runtime_error("Failed to open file");
+
+				LARGE_INTEGER size;
+				if (!GetFileSizeEx(m_file, &size))
+				{
+					CloseHandle(m_file);
+					throw std::runtime_error("Failed to get file size");
+				}
+				m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+				m_fd = ::open(w_to_u8(filename).c_str(), O_RDONLY | O_CLOEXEC);
+				if (m_fd < 0)
+					throw std::runtime_error("Failed to open file");
+
+				struct stat st;
+				if (fstat(m_fd, &st) != 0)
+				{
+					::close(m_fd);
+					throw std::runtime_error("Failed to get file size");
+				}
+				m_size = static_cast<uint64_t>(st.st_size);
+#endif
+			}
+
+			~impl_t()
+			{
+#ifdef DOCFILTERS_HAVE_IO_URING
+				m_blocks.clear();
+#endif
+#ifdef _WIN32
+				CloseHandle(m_file);
+#else
+				::close(m_fd);
+#endif
+			}
+
+			int64_t seek(int64_t offset, int origin)
+			{
+				int64_t base = 0;
+				switch (origin)
+				{
+				case std::ios::beg:
+					base = 0;
+					break;
+				case std::ios::cur:
+					base = static_cast<int64_t>(m_offset);
+					break;
+				case std::ios::end:
+					base = static_cast<int64_t>(m_size);
+					break;
+				default:
+					return -1;
+				}
+				if (base + offset < 0)
+					return -1;
+				m_offset = static_cast<uint64_t>(base + offset);
+				return static_cast<int64_t>(m_offset);
+			}
+
+			size_t read_at(void* buffer, size_t size, uint64_t offset)
+			{
+				++m_stats.direct_reads;
+
+				size_t total = 0;
+				auto dest = static_cast<uint8_t*>(buffer);
+				while (total < size)
+				{
+#ifdef _WIN32
+					OVERLAPPED ov = { 0 };
+					ov.Offset = static_cast<DWORD>(offset + total);
+					ov.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+					DWORD chunk = static_cast<DWORD>(std::min<size_t>(size - total, 0x40000000));
+					DWORD got = 0;
+					if (!ReadFile(m_file, dest + total, chunk, &got, &ov) || got == 0)
+						break;
+#else
+#if defined(__APPLE__)
+					ssize_t got = pread(m_fd, dest + total, size - total, static_cast<off_t>(offset + total));
+#else
+					ssize_t got = pread64(m_fd, dest + total, size - total, static_cast<off64_t>(offset + total));
+#endif
+					if (got < 0 && errno == EINTR)
+						continue;
+					if (got <= 0)
+						break;
+#endif
+					total += static_cast<size_t>(got);
+				}
+				return total;
+			}
+
+#ifdef DOCFILTERS_HAVE_IO_URING
+			/** Queues reads for the missing blocks in [first, last] and submits them together. Returns false if the
+			 *  first block could not be queued. */
+			bool queue_blocks(uint64_t first, uint64_t last, const std::shared_ptr<ring_t>& ring)
+			{
+				std::lock_guard<std::mutex> lock(ring->m_lock);
+
+				bool queued = false;
+				for (uint64_t block = first; block <= last && block * async_block_size < m_size; ++block)
+				{
+					if (m_blocks.count(block))
+						continue;
+
+					size_t slot = 0;
+					if (!ring->acquire_slot(slot))
+						break;
+					auto entry = std::make_unique<async_block_t>();
+					entry->ring = ring;
+					entry->slot = slot;
+					entry->length = static_cast<size_t>(std::min<uint64_t>(async_block_size, m_size - block * async_block_size));
+					ring->queue(m_fd, slot, block * async_block_size, entry->length);
+					m_blocks.emplace(block, std::move(entry));
+					++m_stats.block_reads;
+					queued = true;
+				}
+
+				if (queued)
+				{
+					ring->submit();
+					++m_stats.submissions;
+				}
+				return m_blocks.count(first) != 0;
+			}
+
+			/** Drops blocks behind the current one first, then the furthest ahead, to stay within the block budget. */
+			void trim_blocks(uint64_t current, size_t budget)
+			{
+				while (m_blocks.size() > budget)
+				{
+					auto first = m_blocks.begin();
+					if (first->first < current)
+						m_blocks.erase(first);
+					else
+						m_blocks.erase(std::prev(m_blocks.end()));
+				}
+			}
+
+			/** Serves a read from ring blocks; returns false without reading if it should be a positional read. */
+			bool read_blocks(uint8_t* dest, size_t bytes, size_t& done)
+			{
+				uint64_t first = m_offset / async_block_size;
+				uint64_t last = (m_offset + bytes - 1) / async_block_size;
+				bool sequential = m_offset == m_last_end;
+				if (last - first + 1 > ring_slots / 4 || (!sequential && !m_blocks.count(first)))
+					return false;
+
+				std::shared_ptr<ring_t> ring = ring_t::for_this_thread();
+				if (!ring)
+					return false;
+
+				size_t ahead = sequential ? m_options.read_ahead : 0;
+				trim_blocks(first, last - first + 1 + ahead);
+				for (uint64_t block = first; block <= last; ++block)
+					m_stats.block_hits += m_blocks.count(block);
+				if (!queue_blocks(first, last + ahead, ring))
+					return false;
+
+				for (uint64_t block = first; block <= last; ++block)
+				{
+					auto it = m_blocks.find(block);
+					if (it == m_blocks.end())
+					{
+						// Another stream on this thread holds the buffers; read what is left directly
+						done += read_at(dest + done, bytes - done, m_offset + done);
+						return true;
+					}
+
+					if (!it->second->wait())
+					{
+						m_blocks.erase(it);
+						done += read_at(dest + done, bytes - done, m_offset + done);
+						return true;
+					}
+
+					uint64_t pos = m_offset + done;
+					size_t skip = static_cast<size_t>(pos - block * async_block_size);
+					size_t chunk = std::min(bytes - done, it->second->length - skip);
+					memcpy(dest + done, it->second->data() + skip, chunk);
+					done += chunk;
+				}
+				return true;
+			}
+#endif
+
+			size_t read(void* buffer, size_t size)
+			{
+				if (m_offset >= m_size || size == 0)
+					return 0;
+
+				size_t bytes = static_cast<size_t>(std::min<uint64_t>(size, m_size - m_offset));
+				size_t done = 0;
+#ifdef DOCFILTERS_HAVE_IO_URING
+				if (!read_blocks(static_cast<uint8_t*>(buffer), bytes, done))
+					done = read_at(buffer, bytes, m_offset);
+#else
+				done = read_at(buffer, bytes, m_offset);
+#endif
+				m_offset += done;
+				m_last_end = m_offset;
+				return done;
+			}
+		};
+
+		AsyncFileStream::AsyncFileStream(const std::string& filename, const Options& options)
+			: AsyncFileStream(u8_to_w(filename), options)
+		{
+		}
+
+		AsyncFileStream::AsyncFileStream(const std::wstring& filename, const Options& options)
+			: m_impl(std::make_unique<impl_t>(filename, options))
+		{
+		}
+
+		AsyncFileStream::~AsyncFileStream() = default;
+
+		std::streamoff AsyncFileStream::seek(std::streampos offset, std::ios_base::seekdir way)
+		{
+			return m_impl->seek(static_cast<int64_t>(offset), static_cast<int>(way));
+		}
+
+		size_t AsyncFileStream::read(void* buffer, size_t size)
+		{
+			return m_impl->read(buffer, size);
+		}
+
+		uint64_t AsyncFileStream::size() const
+		{
+			return m_impl->m_size;
+		}
+
+		AsyncFileStream::Stats AsyncFileStream::getStats() const
+		{
+			return m_impl->m_stats;
+		}
+
+		bool AsyncFileStream::isAvailable()
+		{
+#ifdef DOCFILTERS_HAVE_IO_URING
+			return ring_t::for_this_thread() != nullptr;
+#else
+			return false;
+#endif
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
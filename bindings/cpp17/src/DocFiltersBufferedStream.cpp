@@ -0,0 +1,365 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		class BufferedStream::impl_t
+		{
+		public:
+			struct block_t
+			{
+				uint64_t index = 0;
+				size_t length = 0;
+				std::vector<uint8_t> data;
+			};
+			using lru_t = std::list<block_t>;
+
+			Stream* m_inner = nullptr;
+			bool m_own = false;
+			Options m_options;
+			Stats m_stats;
+
+			lru_t m_lru; // most recently used at the front
+			std::unordered_map<uint64_t, lru_t::iterator> m_index;
+			std::vector<uint8_t> m_scratch;
+
+			uint64_t m_offset = 0;
+			int64_t m_inner_pos = -1;
+			int64_t m_size = -1;
+			int64_t m_last_block = -1;
+			size_t m_streak = 0;
+
+			impl_t(Stream* inner, bool own, const Options& options)
+				: m_inner(inner), m_own(own), m_options(options)
+			{
+				if (m_inner == nullptr)
+					throw std::invalid_argument("stream cannot be null");
+				if (m_options.block_size == 0 || m_options.block_count == 0)
+					throw std::invalid_argument("block_size and block_count must be greater than 0");
+
+				m_options.read_ahead = std::min(m_options.read_ahead, m_options.block_count - 1);
+				m_index.reserve(m_options.block_count);
+			}
+
+			~impl_t()
+			{
+				if (m_own)
+					delete m_inner;
+			}
+
+			int64_t size()
+			{
+				if (m_size < 0)
+				{
+					m_size = m_inner->seek(0, std::ios::end);
+					m_inner_pos = m_size;
+					++m_stats.backend_seeks;
+				}
+				return m_size;
+			}
+
+			size_t backend_read(uint64_t offset, uint8_t* dest, size_t size)
+			{
+				if (m_inner_pos != static_cast<int64_t>(offset))
+				{
+					m_inner_pos = m_inner->seek(static_cast<std::streamoff>(offset), std::ios::beg);
+					++m_stats.backend_seeks;
+					if (m_inner_pos != static_cast<int64_t>(offset))
+					{
+						m_inner_pos = -1;
+						return 0;
+					}
+				}
+
+				size_t total = 0;
+				while (total < size)
+				{
+					size_t got = m_inner->read(dest + total, size - total);
+					++m_stats.backend_reads;
+					if (got == 0)
+						break;
+					total += got;
+				}
+				m_stats.backend_bytes += total;
+				m_inner_pos += static_cast<int64_t>(total);
+
+				// A short read marks the end of the stream
+				if (total < size)
+					m_size = static_cast<int64_t>(offset + total);
+				return total;
+			}
+
+			lru_t::iterator acquire_slot()
+			{
+				if (m_lru.size() < m_options.block_count)
+				{
+					m_lru.emplace_front();
+					m_lru.front().data.resize(m_options.block_size);
+				}
+				else
+				{
+					// Recycle the least recently used block
+					m_index.erase(m_lru.back().index);
+					m_lru.splice(m_lru.begin(), m_lru, std::prev(m_lru.end()));
+				}
+				return m_lru.begin();
+			}
+
+			void track_access(uint64_t index)
+			{
+				if (static_cast<int64_t>(index) == m_last_block)
+					return;
+				m_streak = static_cast<int64_t>(index) == m_last_block + 1 ? m_streak + 1 : 0;
+				m_last_block = static_cast<int64_t>(index);
+			}
+
+			const block_t& get_block(uint64_t index)
+			{
+				track_access(index);
+
+				auto found = m_index.find(index);
+				if (found != m_index.end())
+				{
+					++m_stats.hits;
+					m_lru.splice(m_lru.begin(), m_lru, found->second);
+					return *found->second;
+				}
+				++m_stats.misses;
+
+				const size_t bs = m_options.block_size;
+				size_t count = 1;
+				if (m_options.read_ahead > 0 && m_streak > 0)
+				{
+					while (count <= m_options.read_ahead && m_index.find(index + count) == m_index.end())
+						++count;
+					if (m_size >= 0)
+					{
+						uint64_t last = (static_cast<uint64_t>(m_size) + bs - 1) / bs;
+						count = static_cast<size_t>(std::max<uint64_t>(1, std::min<uint64_t>(count, last > index ? last - index : 1)));
+					}
+				}
+
+				if (count == 1)
+				{
+					auto slot = acquire_slot();
+					slot->index = index;
+					slot->length = backend_read(index * bs, slot->data.data(), bs);
+					m_index[index] = slot;
+					return *slot;
+				}
+
+				// Fetch the block and the blocks following it in a single backend read
+				m_scratch.resize(count * bs);
+				size_t got = backend_read(index * bs, m_scratch.data(), m_scratch.size());
+
+				// Insert in reverse so the requested block ends up most recently used
+				for (size_t i = count; i-- > 0;)
+				{
+					size_t begin = i * bs;
+					if (i > 0 && begin >= got)
+						continue;
+
+					size_t length = got > begin ? std::min(bs, got - begin) : 0;
+					auto slot = acquire_slot();
+					slot->index = index + i;
+					slot->length = length;
+					std::memcpy(slot->data.data(), m_scratch.data() + begin, length);
+					m_index[index + i] = slot;
+					if (i > 0)
+						++m_stats.read_ahead_blocks;
+				}
+				return m_lru.front();
+			}
+
+			size_t read(void* buffer, size_t size)
+			{
+				auto dest = static_cast<uint8_t*>(buffer);
+				const size_t bs = m_options.block_size;
+
+				if (size >= bs * m_options.block_count)
+				{
+					// Reads this large would flush the whole cache, send them straight through
+					++m_stats.bypass_reads;
+					size_t got = backend_read(m_offset, dest, size);
+					m_offset += got;
+					m_stats.bytes_read += got;
+					return got;
+				}
+
+				size_t total = 0;
+				while (total < size)
+				{
+					uint64_t index = m_offset / bs;
+					size_t offset_in_block = static_cast<size_t>(m_offset % bs);
+
+					const block_t& block = get_block(index);
+					if (offset_in_block >= block.length)
+						break;
+
+					size_t n = std::min(size - total, block.length - offset_in_block);
+					std::memcpy(dest + total, block.data.data() + offset_in_block, n);
+					total += n;
+					m_offset += n;
+
+					if (block.length < bs && offset_in_block + n >= block.length)
+						break;
+				}
+				m_stats.bytes_read += total;
+				return total;
+			}
+
+			/** Drops a cached block and parks its slot at the back so it is recycled first. */
+			void discard(lru_t::iterator slot)
+			{
+				m_index.erase(slot->index);
+				slot->index = UINT64_MAX;
+				slot->length = 0;
+				m_lru.splice(m_lru.end(), m_lru, slot);
+			}
+
+			size_t write(const void* buffer, size_t size)
+			{
+				if (size == 0)
+					return 0;
+
+				const size_t bs = m_options.block_size;
+				uint64_t first = m_offset / bs;
+				uint64_t last = (m_offset + size - 1) / bs;
+				for (uint64_t index = first; index <= last && !m_index.empty(); ++index)
+				{
+					auto found = m_index.find(index);
+					if (found != m_index.end())
+						discard(found->second);
+				}
+
+				// A write that moves the end of the stream also changes the short block that used to end it, even
+				// when the write starts past that block and the gap is filled with zeros
+				if (m_size < 0 || static_cast<int64_t>(m_offset + size) > m_size)
+				{
+					for (auto it = m_lru.begin(); it != m_lru.end();)
+					{
+						auto slot = it++;
+						if (slot->index != UINT64_MAX && slot->length < bs)
+							discard(slot);
+					}
+				}
+
+				if (m_inner_pos != static_cast<int64_t>(m_offset))
+				{
+					m_inner_pos = m_inner->seek(static_cast<std::streamoff>(m_offset), std::ios::beg);
+					++m_stats.backend_seeks;
+				}
+				size_t written = m_inner->write(buffer, size);
+				m_offset += written;
+				m_inner_pos = m_inner_pos >= 0 ? m_inner_pos + static_cast<int64_t>(written) : -1;
+				if (m_size >= 0 && static_cast<int64_t>(m_offset) > m_size)
+					m_size = static_cast<int64_t>(m_offset);
+				return written;
+			}
+
+			int64_t seek(int64_t offset, int origin)
+			{
+				int64_t base = 0;
+				switch (origin)
+				{
+				case std::ios::beg:
+					base = 0;
+					break;
+				case std::ios::cur:
+					base = static_cast<int64_t>(m_offset);
+					break;
+				case std::ios::end:
+					base = size();
+					break;
+				default:
+					return -1;
+				}
+				if (base < 0 || base + offset < 0)
+					return -1;
+				m_offset = static_cast<uint64_t>(base + offset);
+				return static_cast<int64_t>(m_offset);
+			}
+
+			void invalidate()
+			{
+				m_index.clear();
+				m_lru.clear();
+				m_last_block = -1;
+				m_streak = 0;
+			}
+		};
+
+		BufferedStream::BufferedStream(Stream* stream, bool own_stream, const Options& options)
+			: m_impl(std::make_unique<impl_t>(stream, own_stream, options))
+		{
+		}
+
+		BufferedStream::BufferedStream(std::istream* stream, bool own_stream, const Options& options)
+			: m_impl(std::make_unique<impl_t>(new FileStream(stream, own_stream), true, options))
+		{
+		}
+
+		BufferedStream::BufferedStream(FILE* file, bool own_file, const Options& options)
+			: m_impl(std::make_unique<impl_t>(new FileStream(file, own_file), true, options))
+		{
+		}
+
+		BufferedStream::~BufferedStream() = default;
+
+		std::streamoff BufferedStream::seek(std::streampos offset, std::ios_base::seekdir way)
+		{
+			return m_impl->seek(static_cast<int64_t>(offset), static_cast<int>(way));
+		}
+
+		size_t BufferedStream::read(void* buffer, size_t size)
+		{
+			return m_impl->read(buffer, size);
+		}
+
+		size_t BufferedStream::write(const void* buffer, size_t size)
+		{
+			return m_impl->write(buffer, size);
+		}
+
+		std::unique_ptr<Stream> BufferedStream::get_stream_part(const std::wstring& part_name, const std::wstring& full_name, int index)
+		{
+			return m_impl->m_inner->get_stream_part(part_name, full_name, index);
+		}
+
+		BufferedStream::Stats BufferedStream::getStats() const
+		{
+			return m_impl->m_stats;
+		}
+
+		const BufferedStream::Options& BufferedStream::getOptions() const
+		{
+			return m_impl->m_options;
+		}
+
+		void BufferedStream::invalidate()
+		{
+			m_impl->invalidate();
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
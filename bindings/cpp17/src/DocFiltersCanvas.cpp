@@ -106,11 +106,21 @@ namespace Hyland
 		}
 
 		void Canvas::RenderPage(const Page& Page, const std::wstring& options, const RenderPageProperties& properties)
+		{
+			DoRenderPage(Page, reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str()), properties);
+		}
+
+		void Canvas::RenderPage(const Page& Page, const OptionSet& options, const RenderPageProperties& properties)
+		{
+			DoRenderPage(Page, options.data(), properties);
+		}
+
+		void Canvas::DoRenderPage(const Page& Page, const IGR_UCS2* options, const RenderPageProperties& properties)
 		{
 			Error_Control_Block ecb = { 0 };
 			throw_on_error(IGR_Render_Page_Ex(Page.getHandle()
 				, m_impl->needHandle()
-				, reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str())
+				, options
 				, properties.data()
 				, &ecb), ecb, "IGR_Render_Page_Ex");
 			m_impl->m_has_page = true;
@@ -130,9 +140,19 @@ namespace Hyland
 		}
 
 		void Canvas::BlankPage(int width, int height, const std::wstring& options)
+		{
+			DoBlankPage(width, height, reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str()));
+		}
+
+		void Canvas::BlankPage(int width, int height, const OptionSet& options)
+		{
+			DoBlankPage(width, height, options.data());
+		}
+
+		void Canvas::DoBlankPage(int width, int height, const IGR_UCS2* options)
 		{
 			Error_Control_Block ecb = { 0 };
-			throw_on_error(IGR_Canvas_Blank_Page(m_impl->needHandle(), reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str()), width, height, nullptr, &ecb), ecb, "IGR_Canvas_Blank_Page");
+			throw_on_error(IGR_Canvas_Blank_Page(m_impl->needHandle(), options, width, height, nullptr, &ecb), ecb, "IGR_Canvas_Blank_Page");
 
 			m_impl->m_has_page = true;
 		}
@@ -22,22 +22,17 @@ namespace Hyland
 	{
 		IGR_RETURN_CODE throw_on_error(IGR_RETURN_CODE code, const Error_Control_Block& ecb, const std::string& function_name, const std::string& error_message)
 		{
-			if (code == IGR_OK || code == IGR_NO_MORE)
+			if (!failed(code))
 				return code;
-			std::stringstream s;
-			if (!error_message.empty())
-				s << error_message;
-			else if (ecb.Msg[0] != 0)
-				s << &ecb.Msg[0];
-			else
-				s << "Error " << code;
+			if (error_message.empty())
+				ErrorInfo(code, ecb, function_name.c_str()).raise();
 
+			std::stringstream s;
+			s << error_message;
 			if (!function_name.empty())
 				s << " in " << function_name;
 
 			throw DocumentFilters::Error(code, s.str());
-
-			return code;
 		}
 
 		uint32_t stoul_or(const std::wstring& s, uint32_t default_value)
@@ -14,8 +14,11 @@
 */
 #include "DocumentFiltersObjects.h"
 
+#include <algorithm>
+#include <functional>
 #include <stack>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -103,6 +106,17 @@ namespace Hyland
 		 */
 		std::vector<std::wstring> split(const std::wstring& str, const std::wstring& delimiters);
 
+		/**
+		 * @brief Checks whether a return code indicates an error. IGR_NO_MORE is not one.
+		 *
+		 * @param code The return code to check.
+		 * @return true if the call failed.
+		 */
+		inline bool failed(IGR_RETURN_CODE code)
+		{
+			return code != IGR_OK && code != IGR_NO_MORE;
+		}
+
 		/**
 		 * @brief Throws an exception if the given return code indicates an error.
 		 *
@@ -126,6 +140,47 @@ namespace Hyland
 		 */
 		std::string base64_encode(const void* data, std::size_t length);
 
+		/**
+		 * @brief Appends UTF-16 text to a string as UTF-8.
+		 *
+		 * Produces the same bytes as u16_to_u8, including stopping at a zero code unit, but writes into an
+		 * existing string so its capacity can be reused.
+		 *
+		 * @param dest The string to append to.
+		 * @param str The UTF-16 text.
+		 * @param str_len The number of code units in the text.
+		 */
+		void u16_append_u8(std::string& dest, const char16_t* str, size_t str_len);
+
+		/**
+		 * @brief Appends UTF-16 text to a string as UTF-8 or UTF-32 in a single pass.
+		 *
+		 * The encoding is picked by the type of dest. Stops at a zero code unit, like u16_append_u8, and
+		 * replaces unpaired surrogates with U+FFFD.
+		 *
+		 * @param dest The string to append to.
+		 * @param str The UTF-16 text.
+		 * @param str_len The number of code units in the text.
+		 * @param strip_control_chars Maps \xE to a new line and drops the other control characters
+		 *        Extractor::getText strips.
+		 * @param swap_bytes Writes each UTF-32 code unit in the opposite byte order.
+		 */
+		void u16_append_encoded(std::string& dest, const char16_t* str, size_t str_len, bool strip_control_chars);
+		void u16_append_encoded(std::u32string& dest, const char16_t* str, size_t str_len, bool strip_control_chars, bool swap_bytes);
+
+		/**
+		 * @brief Appends UTF-16 text to a UTF-16 string, copying code units as they are, unpaired surrogates and
+		 * zeros included.
+		 *
+		 * @param dest The string to append to.
+		 * @param str The UTF-16 text.
+		 * @param str_len The number of code units in the text.
+		 * @param strip_control_chars Maps \xE to a new line and drops the other control characters
+		 *        Extractor::getText strips.
+		 * @param swap_bytes Writes each code unit in the opposite byte order.
+		 */
+		void u16_append_encoded(std::u16string& dest, const char16_t* str, size_t str_len, bool strip_control_chars, bool swap_bytes);
+
 
 		/**
 		 * @brief A RAII wrapper for managing handle resources.
@@ -528,6 +583,150 @@ namespace Hyland
 			}
 		};
 
+		/**
+		 * @brief Detects whether a bridge Traits type supplies a static action function.
+		 */
+		template <typename Traits, typename = void>
+		struct has_stream_action_t : std::false_type {};
+
+		template <typename Traits>
+		struct has_stream_action_t<Traits, std::void_t<decltype(&Traits::action)>> : std::true_type {};
+
+		/**
+		 * @brief Creates an IGR_Stream whose callbacks forward to an inner stream object.
+		 *
+		 * The Traits type supplies static read, write, seek and destroy functions that operate
+		 * on InnerStream, allowing the callbacks to be bound without virtual dispatch. Traits may
+		 * also supply a static action function, which then handles engine requests such as
+		 * IGR_ACTION_GET_STREAM_PART.
+		 *
+		 * @tparam InnerStream The type of the object being bridged.
+		 * @tparam Traits The type providing the static stream functions for InnerStream.
+		 * @param stream The object to bridge.
+		 * @param own_stream Indicates if the IGR_Stream should destroy the object when closed.
+		 * @param igr_stream Receives the created IGR_Stream.
+		 * @return The created IGR_Stream.
+		 * @throws std::invalid_argument if stream or igr_stream is null.
+		 */
+		template <typename InnerStream, typename Traits>
+		IGR_Stream* bridge_stream_t(InnerStream* stream, bool own_stream, IGR_Stream** igr_stream)
+		{
+			struct funcs
+			{
+				static IGR_ULONG IGR_EXPORT read(void* handle, void* buffer, IGR_ULONG size)
+				{
+					return Traits::read(reinterpret_cast<InnerStream*>(handle), buffer, size);
+				}
+				static IGR_ULONG IGR_EXPORT write(void* handle, const void* buffer, IGR_ULONG size)
+				{
+					return Traits::write(reinterpret_cast<InnerStream*>(handle), buffer, size);
+				}
+				static IGR_LONGLONG IGR_EXPORT seek(void* handle, IGR_LONGLONG offset, IGR_ULONG origin)
+				{
+					return Traits::seek(reinterpret_cast<InnerStream*>(handle), offset, origin);
+				}
+				static IGR_LONG IGR_EXPORT action(void* handle, int action_id, void* action_data)
+				{
+					if constexpr (has_stream_action_t<Traits>::value)
+						return Traits::action(reinterpret_cast<InnerStream*>(handle), action_id, action_data);
+					else
+						return IGR_E_NOT_VALID_FOR_THIS_CLASS;
+				}
+				static void IGR_EXPORT destroy(void* handle)
+				{
+					Traits::destroy(reinterpret_cast<InnerStream*>(handle));
+				}
+				static void IGR_EXPORT destroy_noop(void* /*handle*/)
+				{
+				}
+			};
+			if (!stream)
+				throw std::invalid_argument("stream cannot be null");
+			if (!igr_stream)
+				throw std::invalid_argument("igr_stream cannot be null");
+
+			Error_Control_Block ecb = { 0 };
+			throw_on_error(IGR_Make_Stream_From_Functions(stream
+				, 0
+				, funcs::seek
+				, funcs::read
+				, funcs::write
+				, has_stream_action_t<Traits>::value ? funcs::action : nullptr
+				, own_stream ? funcs::destroy : funcs::destroy_noop, igr_stream, &ecb),
+				ecb, "IGR_Make_Stream_From_Functions", "Failed to create stream from file");
+
+			return *igr_stream;
+		}
+
+		/**
+		 * @brief Presents an IGR_Stream as a read-only Stream, the reverse of bridge_stream.
+		 *
+		 * Used to layer Stream wrappers over a stream the engine handed out, such as the input
+		 * stream of an Extractor.
+		 */
+		class igr_stream_reader_t : public Stream
+		{
+		public:
+			typedef std::function<std::unique_ptr<Stream>(const std::wstring&, const std::wstring&, int)> part_resolver_t;
+		private:
+			IGR_Stream* m_stream;
+			bool m_own;
+			part_resolver_t m_part_resolver;
+		public:
+			/**
+			 * @brief Constructs a reader over an IGR_Stream.
+			 *
+			 * @param stream The stream to read from.
+			 * @param own_stream Indicates if the reader closes the stream when destroyed.
+			 */
+			igr_stream_reader_t(IGR_Stream* stream, bool own_stream)
+				: m_stream(stream), m_own(own_stream)
+			{
+			}
+
+			~igr_stream_reader_t() override
+			{
+				if (m_own && m_stream != nullptr)
+					m_stream->Close(m_stream);
+			}
+
+			/**
+			 * @brief Makes the reader responsible for closing the stream.
+			 */
+			void take_ownership() { m_own = true; }
+
+			/**
+			 * @brief Sets the function that answers part requests for multi-volume documents.
+			 *
+			 * @param resolver The function to call from get_stream_part.
+			 */
+			void set_part_resolver(const part_resolver_t& resolver) { m_part_resolver = resolver; }
+
+			std::unique_ptr<Stream> get_stream_part(const std::wstring& part_name, const std::wstring& full_name, int index) override
+			{
+				return m_part_resolver ? m_part_resolver(part_name, full_name, index) : nullptr;
+			}
+
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override
+			{
+				return m_stream->Seek(m_stream, static_cast<IGR_LONGLONG>(offset), static_cast<IGR_ULONG>(way));
+			}
+
+			size_t read(void* buffer, size_t size) override
+			{
+				size_t total = 0;
+				while (total < size)
+				{
+					IGR_ULONG chunk = static_cast<IGR_ULONG>(std::min<size_t>(size - total, 0x40000000));
+					IGR_ULONG got = m_stream->Read(m_stream, static_cast<uint8_t*>(buffer) + total, chunk);
+					if (got == 0)
+						break;
+					total += got;
+				}
+				return total;
+			}
+		};
+
 		class subfile_enumerable_t : public enumerable_t<Subfile>
 		{
 			friend class subfile_enumerator_t;
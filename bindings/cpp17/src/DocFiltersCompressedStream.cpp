@@ -0,0 +1,611 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+
+#ifdef DOCFILTERS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef DOCFILTERS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		namespace
+		{
+			/// A point the decoder can be restarted from.
+			struct checkpoint_t
+			{
+				uint64_t out = 0;           ///< Offset in the decompressed data.
+				uint64_t in = 0;            ///< Offset of the first whole compressed byte to read.
+				int bits = 0;               ///< Bits of the byte before `in` still to be consumed (gzip only).
+				bool member_start = false;  ///< The decoder restarts at a gzip member or zstd frame header.
+				std::vector<uint8_t> window; ///< Decompressed data preceding the checkpoint (gzip only).
+			};
+
+			/// Incremental decoder that records checkpoints as it moves through new data.
+			class decoder_t
+			{
+			public:
+				decoder_t(Stream* source, size_t span)
+					: m_source(source), m_span(span), m_input(64 * 1024)
+				{
+				}
+				virtual ~decoder_t() = default;
+
+				/// Positions the decoder at the checkpoint, or at the start of the data when cp is null.
+				virtual void restart(const checkpoint_t* cp) = 0;
+
+				/// Decodes up to size bytes. Fewer bytes are returned only at the end of the data, or if the data is corrupt.
+				virtual size_t decode(uint8_t* out, size_t size) = 0;
+
+				uint64_t position() const { return m_out; }
+				const std::vector<checkpoint_t>& checkpoints() const { return m_checkpoints; }
+
+				const checkpoint_t* checkpoint_before(uint64_t target) const
+				{
+					auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), target,
+						[](uint64_t value, const checkpoint_t& cp) { return value < cp.out; });
+					return it == m_checkpoints.begin() ? nullptr : &*std::prev(it);
+				}
+
+			protected:
+				/// Reads compressed data at m_in_offset into dest.
+				size_t read_input(uint8_t* dest, size_t size)
+				{
+					if (m_source_pos != static_cast<int64_t>(m_in_offset))
+					{
+						m_source_pos = m_source->seek(static_cast<std::streamoff>(m_in_offset), std::ios::beg);
+						if (m_source_pos != static_cast<int64_t>(m_in_offset))
+						{
+							m_source_pos = -1;
+							return 0;
+						}
+					}
+					size_t got = m_source->read(dest, size);
+					m_in_offset += got;
+					m_source_pos += static_cast<int64_t>(got);
+					return got;
+				}
+
+				bool wants_checkpoint() const
+				{
+					uint64_t last = m_checkpoints.empty() ? 0 : m_checkpoints.back().out;
+					return m_out > last && m_out - last >= m_span;
+				}
+
+				void add_checkpoint(checkpoint_t&& cp)
+				{
+					if (cp.out > 0 && (m_checkpoints.empty() || cp.out > m_checkpoints.back().out))
+						m_checkpoints.push_back(std::move(cp));
+				}
+
+				Stream* m_source;
+				size_t m_span;
+				std::vector<uint8_t> m_input;
+				uint64_t m_in_offset = 0; ///< Compressed offset just past the data read into m_input.
+				int64_t m_source_pos = -1;
+				uint64_t m_out = 0;
+				bool m_end = false;
+				std::vector<checkpoint_t> m_checkpoints;
+			};
+
+#ifdef DOCFILTERS_HAVE_ZLIB
+			/// gzip/zlib decoder using deflate block boundaries as checkpoints, in the manner of zlib's zran example.
+			class gzip_decoder_t : public decoder_t
+			{
+			public:
+				gzip_decoder_t(Stream* source, size_t span, bool zlib_wrapper)
+					: decoder_t(source, span), m_trailer(zlib_wrapper ? 4 : 8), m_multi_member(!zlib_wrapper)
+				{
+					restart(nullptr);
+				}
+
+				~gzip_decoder_t() override
+				{
+					if (m_initialized)
+						inflateEnd(&m_strm);
+				}
+
+				void restart(const checkpoint_t* cp) override
+				{
+					if (m_initialized)
+						inflateEnd(&m_strm);
+					m_initialized = false;
+					m_strm = z_stream();
+					m_end = false;
+					m_out = cp ? cp->out : 0;
+
+					if (cp == nullptr || cp->member_start)
+					{
+						m_in_offset = cp ? cp->in : 0;
+						m_raw = false;
+						if (inflateInit2(&m_strm, 15 + 32) != Z_OK)
+							throw std::runtime_error("Failed to initialize gzip decoder");
+						m_initialized = true;
+						return;
+					}
+
+					// Resume mid-member with raw deflate, priming any partial byte and the preceding window
+					if (inflateInit2(&m_strm, -15) != Z_OK)
+						throw std::runtime_error("Failed to initialize gzip decoder");
+					m_initialized = true;
+					m_raw = true;
+					m_in_offset = cp->in - (cp->bits ? 1 : 0);
+					if (cp->bits)
+					{
+						size_t got = read_input(m_input.data(), m_input.size());
+						if (got == 0)
+						{
+							m_end = true;
+							return;
+						}
+						m_strm.next_in = m_input.data() + 1;
+						m_strm.avail_in = static_cast<uInt>(got - 1);
+						inflatePrime(&m_strm, cp->bits, m_input[0] >> (8 - cp->bits));
+					}
+					inflateSetDictionary(&m_strm, cp->window.data(), static_cast<uInt>(cp->window.size()));
+				}
+
+				size_t decode(uint8_t* out, size_t size) override
+				{
+					size_t produced = 0;
+					while (produced < size && !m_end)
+					{
+						if (m_strm.avail_in == 0 && !fill(1))
+						{
+							m_end = true; // truncated
+							break;
+						}
+
+						m_strm.next_out = out + produced;
+						m_strm.avail_out = static_cast<uInt>(std::min<size_t>(size - produced, UINT_MAX));
+						uInt before = m_strm.avail_out;
+						int ret = inflate(&m_strm, Z_BLOCK);
+						size_t n = before - m_strm.avail_out;
+						produced += n;
+						m_out += n;
+
+						if (ret == Z_STREAM_END)
+							next_member();
+						else if (ret != Z_OK && ret != Z_BUF_ERROR)
+							m_end = true; // corrupt
+						else if ((m_strm.data_type & 128) && !(m_strm.data_type & 64) && wants_checkpoint())
+							add_block_checkpoint();
+					}
+					return produced;
+				}
+
+			private:
+				/// Makes sure at least count bytes of input are buffered.
+				bool fill(size_t count)
+				{
+					if (m_strm.avail_in >= count)
+						return true;
+					if (m_strm.avail_in > 0 && m_strm.next_in != m_input.data())
+						std::memmove(m_input.data(), m_strm.next_in, m_strm.avail_in);
+					size_t got = read_input(m_input.data() + m_strm.avail_in, m_input.size() - m_strm.avail_in);
+					m_strm.next_in = m_input.data();
+					m_strm.avail_in += static_cast<uInt>(got);
+					return m_strm.avail_in >= count;
+				}
+
+				void add_block_checkpoint()
+				{
+					checkpoint_t cp;
+					cp.out = m_out;
+					cp.in = m_in_offset - m_strm.avail_in;
+					cp.bits = m_strm.data_type & 7;
+					cp.window.resize(32768);
+					uInt length = static_cast<uInt>(cp.window.size());
+					if (inflateGetDictionary(&m_strm, cp.window.data(), &length) != Z_OK)
+						return;
+					cp.window.resize(length);
+					add_checkpoint(std::move(cp));
+				}
+
+				void next_member()
+				{
+					// Raw deflate stops before the member trailer, skip it ourselves
+					if (m_raw)
+					{
+						for (size_t remaining = m_trailer; remaining > 0;)
+						{
+							if (!fill(1))
+							{
+								m_end = true;
+								return;
+							}
+							size_t n = std::min<size_t>(remaining, m_strm.avail_in);
+							m_strm.next_in += n;
+							m_strm.avail_in -= static_cast<uInt>(n);
+							remaining -= n;
+						}
+					}
+
+					if (!m_multi_member || !fill(2) || m_strm.next_in[0] != 0x1f || m_strm.next_in[1] != 0x8b)
+					{
+						m_end = true;
+						return;
+					}
+
+					checkpoint_t cp;
+					cp.out = m_out;
+					cp.in = m_in_offset - m_strm.avail_in;
+					cp.member_start = true;
+					add_checkpoint(std::move(cp));
+
+					inflateReset2(&m_strm, 15 + 32);
+					m_raw = false;
+				}
+
+				z_stream m_strm = z_stream();
+				bool m_initialized = false;
+				bool m_raw = false;
+				size_t m_trailer;
+				bool m_multi_member;
+			};
+#endif
+
+#ifdef DOCFILTERS_HAVE_ZSTD
+			/// zstd decoder using frame starts as checkpoints.
+			class zstd_decoder_t : public decoder_t
+			{
+			public:
+				zstd_decoder_t(Stream* source, size_t span)
+					: decoder_t(source, span), m_ctx(ZSTD_createDCtx())
+				{
+					if (m_ctx == nullptr)
+						throw std::runtime_error("Failed to initialize zstd decoder");
+					m_input.resize(ZSTD_DStreamInSize());
+					restart(nullptr);
+				}
+
+				~zstd_decoder_t() override
+				{
+					ZSTD_freeDCtx(m_ctx);
+				}
+
+				void restart(const checkpoint_t* cp) override
+				{
+					ZSTD_DCtx_reset(m_ctx, ZSTD_reset_session_only);
+					m_in_offset = cp ? cp->in : 0;
+					m_out = cp ? cp->out : 0;
+					m_in = ZSTD_inBuffer{ m_input.data(), 0, 0 };
+					m_frame_done = true;
+					m_end = false;
+				}
+
+				size_t decode(uint8_t* out, size_t size) override
+				{
+					ZSTD_outBuffer dest = { out, size, 0 };
+					while (dest.pos < dest.size && !m_end)
+					{
+						if (m_in.pos == m_in.size)
+						{
+							size_t got = read_input(m_input.data(), m_input.size());
+							if (got == 0)
+							{
+								m_end = true; // end of data, or truncated if a frame is still open
+								break;
+							}
+							m_in = ZSTD_inBuffer{ m_input.data(), got, 0 };
+						}
+
+						if (m_frame_done)
+						{
+							uint64_t out_pos = m_out + dest.pos;
+							uint64_t last = m_checkpoints.empty() ? 0 : m_checkpoints.back().out;
+							if (out_pos > last && out_pos - last >= m_span)
+							{
+								checkpoint_t cp;
+								cp.out = out_pos;
+								cp.in = m_in_offset - (m_in.size - m_in.pos);
+								cp.member_start = true;
+								add_checkpoint(std::move(cp));
+							}
+							m_frame_done = false;
+						}
+
+						size_t ret = ZSTD_decompressStream(m_ctx, &dest, &m_in);
+						if (ZSTD_isError(ret))
+						{
+							m_end = true; // corrupt
+							break;
+						}
+						if (ret == 0)
+							m_frame_done = true;
+					}
+					m_out += dest.pos;
+					return dest.pos;
+				}
+
+			private:
+				ZSTD_DCtx* m_ctx;
+				ZSTD_inBuffer m_in = { nullptr, 0, 0 };
+				bool m_frame_done = true;
+			};
+#endif
+		} // namespace
+
+		class CompressedStream::impl_t
+		{
+		public:
+			struct window_t
+			{
+				uint64_t index = 0;
+				size_t length = 0;
+				std::vector<uint8_t> data;
+			};
+			using lru_t = std::list<window_t>;
+
+			Stream* m_source;
+			bool m_own;
+			CompressionFormat m_format;
+			Options m_options;
+			Stats m_stats;
+			std::unique_ptr<decoder_t> m_decoder;
+
+			lru_t m_lru; // most recently used at the front
+			std::unordered_map<uint64_t, lru_t::iterator> m_index;
+			std::vector<uint8_t> m_scratch;
+
+			uint64_t m_offset = 0;
+			int64_t m_size = -1;
+
+			impl_t(Stream* source, bool own, CompressionFormat format, const Options& options)
+				: m_source(source), m_own(own), m_format(format), m_options(options)
+			{
+				if (m_source == nullptr)
+					throw std::invalid_argument("stream cannot be null");
+				if (m_options.window_size == 0 || m_options.window_count == 0)
+					throw std::invalid_argument("window_size and window_count must be greater than 0");
+
+				uint8_t magic[4] = { 0 };
+				m_source->seek(0, std::ios::beg);
+				size_t got = m_source->read(magic, sizeof(magic));
+
+				bool gzip = got >= 2 && magic[0] == 0x1f && magic[1] == 0x8b;
+				bool zlib = got >= 2 && (magic[0] & 0x0f) == 8 && ((magic[0] << 8) | magic[1]) % 31 == 0;
+				bool zstd = got >= 4 && ((magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+					|| ((magic[0] & 0xf0) == 0x50 && magic[1] == 0x2a && magic[2] == 0x4d && magic[3] == 0x18));
+
+				if (m_format == CompressionFormat::Auto)
+				{
+					if (gzip || zlib)
+						m_format = CompressionFormat::Gzip;
+					else if (zstd)
+						m_format = CompressionFormat::Zstd;
+					else
+						throw std::invalid_argument("Unrecognized compression format");
+				}
+
+				if (!isSupported(m_format))
+					throw std::runtime_error("Compression format is not supported by this build");
+
+				size_t span = std::max(m_options.checkpoint_span, m_options.window_size);
+#ifdef DOCFILTERS_HAVE_ZLIB
+				if (m_format == CompressionFormat::Gzip)
+					m_decoder = std::make_unique<gzip_decoder_t>(m_source, span, zlib && !gzip);
+#endif
+#ifdef DOCFILTERS_HAVE_ZSTD
+				if (m_format == CompressionFormat::Zstd)
+					m_decoder = std::make_unique<zstd_decoder_t>(m_source, span);
+#endif
+				(void)span;
+				m_scratch.resize(m_options.window_size);
+			}
+
+			~impl_t()
+			{
+				m_decoder.reset();
+				if (m_own)
+					delete m_source;
+			}
+
+			/// Moves the decoder to target, restarting from a checkpoint if that is closer. Returns false at the end of the data.
+			bool position_decoder(uint64_t target)
+			{
+				const checkpoint_t* cp = m_decoder->checkpoint_before(target);
+				uint64_t cp_out = cp ? cp->out : 0;
+				uint64_t pos = m_decoder->position();
+				if (pos > target || pos < cp_out)
+				{
+					m_decoder->restart(cp);
+					++m_stats.restarts;
+				}
+
+				while (m_decoder->position() < target)
+				{
+					size_t want = static_cast<size_t>(std::min<uint64_t>(m_scratch.size(), target - m_decoder->position()));
+					size_t got = m_decoder->decode(m_scratch.data(), want);
+					m_stats.bytes_decoded += got;
+					if (got < want)
+					{
+						m_size = static_cast<int64_t>(m_decoder->position());
+						return false;
+					}
+				}
+				return true;
+			}
+
+			const window_t* get_window(uint64_t index)
+			{
+				auto found = m_index.find(index);
+				if (found != m_index.end())
+				{
+					++m_stats.window_hits;
+					m_lru.splice(m_lru.begin(), m_lru, found->second);
+					return &*found->second;
+				}
+
+				uint64_t target = index * m_options.window_size;
+				if (m_size >= 0 && target >= static_cast<uint64_t>(m_size))
+					return nullptr;
+
+				++m_stats.window_misses;
+				if (!position_decoder(target))
+					return nullptr;
+
+				if (m_lru.size() < m_options.window_count)
+				{
+					m_lru.emplace_front();
+					m_lru.front().data.resize(m_options.window_size);
+				}
+				else
+				{
+					m_index.erase(m_lru.back().index);
+					m_lru.splice(m_lru.begin(), m_lru, std::prev(m_lru.end()));
+				}
+
+				window_t& window = m_lru.front();
+				window.index = index;
+				window.length = m_decoder->decode(window.data.data(), m_options.window_size);
+				m_stats.bytes_decoded += window.length;
+				if (window.length < m_options.window_size)
+					m_size = static_cast<int64_t>(target + window.length);
+				m_index[index] = m_lru.begin();
+				return &window;
+			}
+
+			size_t read(void* buffer, size_t size)
+			{
+				auto dest = static_cast<uint8_t*>(buffer);
+				const size_t ws = m_options.window_size;
+				size_t total = 0;
+				while (total < size)
+				{
+					uint64_t index = m_offset / ws;
+					size_t offset_in_window = static_cast<size_t>(m_offset % ws);
+
+					const window_t* window = get_window(index);
+					if (window == nullptr || offset_in_window >= window->length)
+						break;
+
+					size_t n = std::min(size - total, window->length - offset_in_window);
+					std::memcpy(dest + total, window->data.data() + offset_in_window, n);
+					total += n;
+					m_offset += n;
+
+					if (window->length < ws && offset_in_window + n >= window->length)
+						break;
+				}
+				return total;
+			}
+
+			uint64_t size()
+			{
+				if (m_size < 0)
+				{
+					// Decode through to the end from the furthest known point
+					auto&& cps = m_decoder->checkpoints();
+					if (!cps.empty() && m_decoder->position() < cps.back().out)
+					{
+						m_decoder->restart(&cps.back());
+						++m_stats.restarts;
+					}
+					for (;;)
+					{
+						size_t got = m_decoder->decode(m_scratch.data(), m_scratch.size());
+						m_stats.bytes_decoded += got;
+						if (got < m_scratch.size())
+							break;
+					}
+					m_size = static_cast<int64_t>(m_decoder->position());
+				}
+				return static_cast<uint64_t>(m_size);
+			}
+		};
+
+		CompressedStream::CompressedStream(Stream* stream, bool own_stream, CompressionFormat format, const Options& options)
+			: m_impl(std::make_unique<impl_t>(stream, own_stream, format, options))
+		{
+		}
+
+		CompressedStream::~CompressedStream() = default;
+
+		std::streamoff CompressedStream::seek(std::streampos offset, std::ios_base::seekdir way)
+		{
+			int64_t base = 0;
+			switch (way)
+			{
+			case std::ios::beg:
+				base = 0;
+				break;
+			case std::ios::cur:
+				base = static_cast<int64_t>(m_impl->m_offset);
+				break;
+			case std::ios::end:
+				base = static_cast<int64_t>(m_impl->size());
+				break;
+			default:
+				return -1;
+			}
+			int64_t target = base + static_cast<int64_t>(offset);
+			if (target < 0)
+				return -1;
+			m_impl->m_offset = static_cast<uint64_t>(target);
+			return target;
+		}
+
+		size_t CompressedStream::read(void* buffer, size_t size)
+		{
+			return m_impl->read(buffer, size);
+		}
+
+		uint64_t CompressedStream::size()
+		{
+			return m_impl->size();
+		}
+
+		CompressionFormat CompressedStream::getFormat() const
+		{
+			return m_impl->m_format;
+		}
+
+		CompressedStream::Stats CompressedStream::getStats() const
+		{
+			Stats result = m_impl->m_stats;
+			result.checkpoints = m_impl->m_decoder->checkpoints().size();
+			return result;
+		}
+
+		bool CompressedStream::isSupported(CompressionFormat format)
+		{
+			switch (format)
+			{
+#ifdef DOCFILTERS_HAVE_ZLIB
+			case CompressionFormat::Gzip:
+				return true;
+#endif
+#ifdef DOCFILTERS_HAVE_ZSTD
+			case CompressionFormat::Zstd:
+				return true;
+#endif
+			default:
+				return false;
+			}
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
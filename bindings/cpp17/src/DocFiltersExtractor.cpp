@@ -15,6 +15,7 @@
 #include "DocumentFiltersObjects.h"
 #include "DocFiltersCommon.h"
 #include <algorithm>
+#include <limits>
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <intrin.h>
@@ -40,35 +41,37 @@ namespace Hyland
 	{
 		namespace
 		{
-			std::u16string& swap_endianness(std::u16string& buffer)
+			uint32_t mode_flags(OpenMode mode, uint32_t open_flags)
 			{
-				for (auto&& ch : buffer)
-					ch = (ch >> 8) | (ch << 8); // NOLINT
-				return buffer;
+				if (mode == OpenMode::Text)
+					return (open_flags & ~0xffff0000) | IGR_FORMAT_TEXT; // NOLINT
+				if (mode == OpenMode::Paginated)
+					return (open_flags & ~0xffff0000) | IGR_FORMAT_IMAGE; // NOLINT
+				if (mode == OpenMode::ClassicHtml)
+					return (open_flags & ~0xffff0000) | IGR_FORMAT_HTML; // NOLINT
+				return open_flags;
 			}
 
-			std::u32string& swap_endianness(std::u32string& buffer)
+			/** The number of bits each pixel of the type takes; 0 if the engine works it out. */
+			uint32_t bits_per_pixel(PixelType type)
 			{
-				for (auto&& ch : buffer)
-					ch = (ch >> 24) | ((ch >> 8) & 0xFF00) | ((ch << 8) & 0xFF0000) | (ch << 24); // NOLINT
-				return buffer;
-			}
-
-			template <typename str>
-			str& prepare_endianness(str& buffer, bool need_little)
-			{
-#if TARGET_LITTLE_ENDIAN == 1
-				// system is little
-				if (need_little)
-					return buffer;
-				
-				return swap_endianness(buffer);
-#else
-				// system is big
-				if (need_little)
-					return swap_endianness(buffer);
-				return buffer;
-#endif
+				switch (type)
+				{
+				case PixelType::Pixel1BPP: return 1;
+				case PixelType::Pixel4BPP: return 4;
+				case PixelType::Pixel8BPP: return 8;
+				case PixelType::Pixel16BPP_565_RGB:
+				case PixelType::Pixel16BPP_565_BGR:
+				case PixelType::Pixel16BPP_4444_ARGB:
+				case PixelType::Pixel16BPP_4444_BGRA: return 16;
+				case PixelType::Pixel24BPP_888_RGB:
+				case PixelType::Pixel24BPP_888_BGR: return 24;
+				case PixelType::Pixel32BPP_8888_ARGB:
+				case PixelType::Pixel32BPP_8888_BGRA:
+				case PixelType::Pixel32BPP_8888_RGBA:
+				case PixelType::Pixel32BPP_8888_ABGR: return 32;
+				default: return 0;
+				}
 			}
 		} // namespace
 
@@ -76,10 +79,16 @@ namespace Hyland
 		{
 		public:
 			IGR_Stream* m_stream = nullptr;
+			HashingStream* m_hashing = nullptr; // owned by m_stream when hashing is enabled
+			TracingStream* m_tracing = nullptr; // owned by m_stream when tracing is enabled
+			bool m_parts_bridged = false; // m_stream answers stream part requests through m_stream_part_callback
 			handle_holder_t<IGR_LONG> m_handle;
 			IGR_LONG m_type = 0;
 			IGR_LONG m_caps = 0;
 			bool m_eof = false;
+			std::u16string m_text_buffer; // reused by the getText overloads
+			char16_t m_pending_surrogate = 0; // high surrogate held back from the last UTF-8 block
+			std::u16string m_unread; // read past the end of a text prefix; handed out before any more text
 			DocumentFilters::open_callback_t m_callback;
 			Extractor::password_callback_t m_password_callback;
 			Extractor::localize_callback_t m_localize_callback;
@@ -89,9 +98,12 @@ namespace Hyland
 			Extractor::approve_external_resource_callback_t m_approve_external_resource_callback;
 			Extractor::get_resource_stream_callback_t m_get_resource_stream_callback;
 			Extractor::ocr_image_callback_t m_ocr_image_callback;
+			Extractor::stream_part_callback_t m_stream_part_callback;
 			std::optional<Extractor::pages_t> m_pages_loader;
 			std::shared_ptr<subfile_enumerable_t> m_subfiles;
 			std::shared_ptr<subfile_enumerable_t> m_images;
+			std::optional<IGR_Open_DIB_Info> m_bitmap; // opened with IGR_Open_DIB instead of from m_stream
+			std::shared_ptr<const void> m_bitmap_owner;
 
 			explicit impl_t(IGR_Stream* stream)
 				: m_stream(stream)
@@ -118,6 +130,8 @@ namespace Hyland
 			{
 				m_handle.reset();
 				m_eof = false;
+				m_pending_surrogate = 0;
+				m_unread.clear();
 				m_subfiles.reset();
 				m_images.reset();
 				m_pages_loader.reset();
@@ -126,9 +140,27 @@ namespace Hyland
 				{
 					m_stream->Close(m_stream);
 					m_stream = nullptr;
+					m_hashing = nullptr;
+					m_tracing = nullptr;
+					m_parts_bridged = false;
 				}
 			}
 
+			/** Creates a reader over m_stream that answers stream part requests with the callback. The callback is
+			 *  looked up on each request, so it can be replaced until the document is opened. */
+			static igr_stream_reader_t* make_part_reader(const std::shared_ptr<impl_t>& self)
+			{
+				auto reader = new igr_stream_reader_t(self->need_stream(), false);
+				reader->set_part_resolver([weak = std::weak_ptr<impl_t>(self)](const std::wstring& part_name, const std::wstring& full_name, int index) -> std::unique_ptr<Stream>
+					{
+						auto impl = weak.lock();
+						if (!impl || !impl->m_stream_part_callback)
+							return nullptr;
+						return impl->m_stream_part_callback(part_name, full_name, index);
+					});
+				return reader;
+			}
+
 			[[nodiscard]] 
 			IGR_Stream* need_stream() const
 			{
@@ -153,12 +185,59 @@ namespace Hyland
 
 			void need_type()
 			{
-				if (!has_handle() && m_type == 0 && m_caps == 0)
+				if (!has_handle() && !m_bitmap.has_value() && m_type == 0 && m_caps == 0)
 				{
 					Error_Control_Block ecb = { 0 };
 					IGR_Get_Stream_Type(need_stream(), &m_caps, &m_type, &ecb); // ignore errors
 				}
 			}
+
+			/** Writes the rest of the text to stream. Each chunk is handed to encode, which converts it from UTF-16
+			 *  into block in one pass; block is written out whenever it grows past a few hundred kilobytes. A high
+			 *  surrogate at the end of a chunk is carried over so a pair split between chunks stays a pair.
+			 *  As SaveTo has always done, each chunk of 4096 code units ends at its first zero, and a chunk that
+			 *  starts with a zero ends the output. */
+			template <typename R, typename E>
+			void save_text(Extractor& extractor, std::ostream& stream, E&& encode)
+			{
+				static const size_t chunk_size = 4096;
+				static const size_t block_size = 262144;
+
+				auto& text = m_text_buffer;
+				R block;
+				block.reserve(block_size / sizeof(typename R::value_type) + chunk_size * (sizeof(typename R::value_type) == 1 ? 3 : 1));
+
+				size_t carry = 0;
+				if (m_pending_surrogate != 0)
+				{
+					text.resize(chunk_size + 2);
+					text[carry++] = m_pending_surrogate;
+					m_pending_surrogate = 0;
+				}
+
+				bool stop = false;
+				while (!m_eof && !stop)
+				{
+					text.resize(carry + chunk_size + 1);
+					auto first = text.begin() + static_cast<std::ptrdiff_t>(carry);
+					auto read = static_cast<std::ptrdiff_t>(extractor.getText(&text[carry], chunk_size + 1, false));
+					auto cut = static_cast<size_t>(std::find(first, first + read, u'\0') - first);
+					stop = read > 0 && cut == 0;
+
+					size_t length = carry + cut;
+					carry = !m_eof && !stop && length > 0 && text[length - 1] >= 0xD800 && text[length - 1] <= 0xDBFF ? 1 : 0; // NOLINT
+
+					encode(block, text.data(), length - carry);
+					if (carry != 0)
+						text[0] = text[length - 1];
+
+					if (m_eof || stop || block.size() * sizeof(typename R::value_type) >= block_size)
+					{
+						stream.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size() * sizeof(typename R::value_type)));
+						block.clear();
+					}
+				}
+			}
 		};
 
 
@@ -172,6 +251,36 @@ namespace Hyland
 		{
 		}
 
+		Extractor::Extractor(const PixelBufferView& bitmap)
+			: m_impl(new impl_t(nullptr))
+		{
+			if (bitmap.pixels == nullptr || bitmap.width == 0 || bitmap.height == 0 || bitmap.stride == 0)
+				throw std::invalid_argument("bitmap");
+			if ((static_cast<uint64_t>(bitmap.width) * bits_per_pixel(bitmap.type) + 7) / 8 > bitmap.stride)
+				throw std::invalid_argument("bitmap.stride");
+			if (bitmap.size / bitmap.stride < bitmap.height || bitmap.size > std::numeric_limits<IGR_ULONG>::max())
+				throw std::invalid_argument("bitmap.size");
+			if (bitmap.palette == nullptr && bitmap.palette_count != 0)
+				throw std::invalid_argument("bitmap.palette");
+
+			IGR_Open_DIB_Info info = {};
+			info.struct_size = sizeof(info);
+			info.flags = static_cast<IGR_ULONG>(bitmap.flags);
+			info.width = bitmap.width;
+			info.height = bitmap.height;
+			info.stride = bitmap.stride;
+			info.pixel_format = static_cast<IGR_OPEN_BITMAP_PIXEL_TYPE>(bitmap.type);
+			info.pixel_data = bitmap.pixels;
+			info.pixel_data_size = static_cast<IGR_ULONG>(bitmap.size);
+			info.palette = bitmap.palette;
+			info.palette_count = bitmap.palette_count;
+			info.dpi_x = bitmap.dpi_x;
+			info.dpi_y = bitmap.dpi_y;
+			info.orientation = static_cast<IGR_OPEN_BITMAP_ORIENTATION_TYPE>(bitmap.orientation);
+			m_impl->m_bitmap = info;
+			m_impl->m_bitmap_owner = bitmap.owner;
+		}
+
 		IGR_HDOC Extractor::getHandle() const
 		{
 			return m_impl->need_handle();
@@ -185,6 +294,26 @@ namespace Hyland
 		}
 
 		void Extractor::Open(uint32_t open_flags, const std::wstring& option, const DocumentFilters::open_callback_t& callback)
+		{
+			TryOpen(open_flags, option, callback).value();
+		}
+
+		Result<void> Extractor::TryOpen(uint32_t open_flags, const std::wstring& option, const DocumentFilters::open_callback_t& callback)
+		{
+			return DoOpen(open_flags, reinterpret_cast<const IGR_UCS2*>(w_to_u16(option).c_str()), callback);
+		}
+
+		void Extractor::Open(uint32_t open_flags, const OptionSet& options, const DocumentFilters::open_callback_t& callback)
+		{
+			TryOpen(open_flags, options, callback).value();
+		}
+
+		Result<void> Extractor::TryOpen(uint32_t open_flags, const OptionSet& options, const DocumentFilters::open_callback_t& callback)
+		{
+			return DoOpen(open_flags, options.data(), callback);
+		}
+
+		Result<void> Extractor::DoOpen(uint32_t open_flags, const IGR_UCS2* options, const DocumentFilters::open_callback_t& callback)
 		{
 			m_impl->Close(false);
 			m_impl->m_callback = callback;
@@ -192,10 +321,18 @@ namespace Hyland
 			int flags = open_flags;
 
 			Error_Control_Block ecb = { 0 };
-			throw_on_error(IGR_Open_Ex(IGR_OPEN_FROM_STREAM
+			if (m_impl->m_bitmap.has_value())
+			{
+				IGR_RETURN_CODE rc = IGR_Open_DIB(&*m_impl->m_bitmap, flags, options, &m_impl->m_caps, &m_impl->m_type, m_impl->m_handle.attach(), &ecb);
+				if (failed(rc))
+					return ErrorInfo(rc, ecb, "IGR_Open_DIB");
+				return Result<void>();
+			}
+
+			IGR_RETURN_CODE rc = IGR_Open_Ex(IGR_OPEN_FROM_STREAM
 				, need_stream()
 				, flags
-				, reinterpret_cast<const IGR_UCS2*>(w_to_u16(option).c_str())
+				, options
 				, &m_impl->m_caps
 				, &m_impl->m_type
 				, nullptr
@@ -288,7 +425,7 @@ namespace Hyland
 									auto strm = impl->m_get_resource_stream_callback(u16_to_w(p->url));
 									if (strm)
 									{
-										Stream::bridge_stream(strm.release(), true, &p->result);
+										Stream::bridge_input_stream(strm.release(), true, &p->result);
 										return IGR_OK;
 									}
 									return IGR_CANCELLED;
@@ -329,22 +466,30 @@ namespace Hyland
 					{
 						return IGR_E_BAD_ERROR;
 					}
-					return IGR_OK; }, m_impl.get(), m_impl->m_handle.attach(), &ecb),
-				ecb, "IGR_Open_Ex");
-			;
+					return IGR_OK; }, m_impl.get(), m_impl->m_handle.attach(), &ecb);
+			if (failed(rc))
+				return ErrorInfo(rc, ecb, "IGR_Open_Ex");
+			return Result<void>();
 		}
 
 		void Extractor::Open(OpenMode mode, uint32_t open_flags, const std::wstring& option, const DocumentFilters::open_callback_t& callback)
 		{
-			uint32_t flags = open_flags;
-			if (mode == OpenMode::Text)
-				flags = (flags & ~0xffff0000) | IGR_FORMAT_TEXT; // NOLINT
-			else if (mode == OpenMode::Paginated)
-				flags = (flags & ~0xffff0000) | IGR_FORMAT_IMAGE; // NOLINT
-			else if (mode == OpenMode::ClassicHtml)
-				flags = (flags & ~0xffff0000) | IGR_FORMAT_HTML; // NOLINT
+			TryOpen(mode, open_flags, option, callback).value();
+		}
+
+		Result<void> Extractor::TryOpen(OpenMode mode, uint32_t open_flags, const std::wstring& option, const DocumentFilters::open_callback_t& callback)
+		{
+			return TryOpen(mode_flags(mode, open_flags), option, callback);
+		}
+
+		void Extractor::Open(OpenMode mode, uint32_t open_flags, const OptionSet& options, const DocumentFilters::open_callback_t& callback)
+		{
+			TryOpen(mode, open_flags, options, callback).value();
+		}
 
-			Open(flags, option, callback);
+		Result<void> Extractor::TryOpen(OpenMode mode, uint32_t open_flags, const OptionSet& options, const DocumentFilters::open_callback_t& callback)
+		{
+			return DoOpen(mode_flags(mode, open_flags), options.data(), callback);
 		}
 
 		IGR_Stream* Extractor::resolve_stream() const
@@ -397,9 +542,29 @@ namespace Hyland
 			m_impl->m_ocr_image_callback = callback;
 		}
 
+		void Extractor::setStreamPartCallback(const stream_part_callback_t& callback)
+		{
+			if (m_impl->has_handle())
+				throw DocumentFilters::Error("The stream part callback must be set before the document is opened");
+
+			m_impl->m_stream_part_callback = callback;
+			if (m_impl->m_parts_bridged || !callback)
+				return;
+
+			// The reader only takes ownership of the original stream once the bridge exists, so a failure leaves it untouched
+			std::unique_ptr<igr_stream_reader_t> reader(impl_t::make_part_reader(m_impl));
+			IGR_Stream* wrapped = nullptr;
+			Stream::bridge_stream(reader.get(), true, &wrapped);
+			reader.release()->take_ownership(); // NOLINT: owned by the bridged stream
+
+			m_impl->m_stream = wrapped;
+			m_impl->m_parts_bridged = true;
+		}
+
 		uint32_t Extractor::getFileType() const
 		{
-			need_stream();
+			if (!m_impl->m_bitmap.has_value())
+				need_stream();
 			m_impl->need_type();
 			return static_cast<uint32_t>(m_impl->m_type);
 		}
@@ -407,7 +572,9 @@ namespace Hyland
 		std::wstring Extractor::getFileType(Format::What what) const
 		{
 			std::wstring res;
-			Format::Fetch(static_cast<uint32_t>(getFileType()), what, res);
+			uint32_t id = static_cast<uint32_t>(getFileType());
+			if (!Registry::DoFetchAttached(id, what, res))
+				Format::Fetch(id, what, res);
 			return res;
 		}
 
@@ -418,30 +585,227 @@ namespace Hyland
 		}
 
         std::wstring Extractor::getText(size_t max_length, bool strip_control_chars)
+        {
+            auto& buffer = m_impl->m_text_buffer;
+            getText(buffer, max_length, strip_control_chars);
+            return u16_to_w(buffer.data(), buffer.size());
+        }
+
+        size_t Extractor::getText(std::u16string& text, size_t max_length, bool strip_control_chars)
+        {
+            return TryGetText(text, max_length, strip_control_chars).value();
+        }
+
+        Result<size_t> Extractor::TryGetText(std::u16string& text, size_t max_length, bool strip_control_chars)
         {
             if (max_length == 0)
                 throw std::invalid_argument("max_length");
 
-            Error_Control_Block ecb = { 0 };
-            IGR_LONG length = static_cast<IGR_ULONG>(max_length);
-            std::vector<IGR_UCS2> buffer(max_length + 1);
-            throw_on_error(IGR_Get_Text(m_impl->need_handle(), &buffer[0], &length, &ecb), ecb, "IGR_Get_Text");
-            m_impl->m_eof = length == 0;
+            text.resize(max_length + 1);
+            auto result = TryGetText(&text[0], max_length + 1, strip_control_chars);
+            text.resize(result ? *result : 0);
+            return result;
+        }
+
+        size_t Extractor::getText(std::string& text, size_t max_length, bool strip_control_chars)
+        {
+            if (max_length == 0)
+                throw std::invalid_argument("max_length");
+
+            auto& buffer = m_impl->m_text_buffer;
+            text.clear();
+
+            // A block can come back empty, when it held only a surrogate that was held back or only stripped
+            // characters; keep reading so that 0 is returned only at the end of the text
+            do
+            {
+                // A high surrogate held back from the previous block goes in front of this one
+                char16_t pending = m_impl->m_pending_surrogate;
+                m_impl->m_pending_surrogate = 0;
+                size_t offset = pending ? 1 : 0;
+                buffer.resize(max_length + 1 + offset);
+                buffer[0] = pending;
+                size_t length = offset + getText(&buffer[offset], max_length + 1, strip_control_chars);
+
+                if (length > 0 && !m_impl->m_eof && buffer[length - 1] >= 0xD800 && buffer[length - 1] <= 0xDBFF) // NOLINT
+                    m_impl->m_pending_surrogate = buffer[--length];
+
+                u16_append_u8(text, buffer.data(), length);
+            } while (text.empty() && !m_impl->m_eof);
+            return text.size();
+        }
+
+        size_t Extractor::getText(char16_t* buffer, size_t buffer_size, bool strip_control_chars)
+        {
+            return TryGetText(buffer, buffer_size, strip_control_chars).value();
+        }
+
+        Result<size_t> Extractor::TryGetText(char16_t* buffer, size_t buffer_size, bool strip_control_chars)
+        {
+            if (buffer == nullptr || buffer_size < 2)
+                throw std::invalid_argument("buffer_size");
+
+            auto strip = [&](size_t length)
+            {
+                if (!strip_control_chars)
+                    return length;
+
+                // Replace \xE with new line and strip \x01-\x08,\x0b,\x0c-\x10
+                size_t out = 0;
+                for (size_t i = 0; i < length; ++i)
+                {
+                    char16_t ch = buffer[i];
+                    if (ch == u'\xE')
+                        buffer[out++] = u'\n';
+                    else if (!((ch >= u'\x01' && ch <= u'\x08') || ch == u'\x0B' || (ch >= u'\x0C' && ch <= u'\x10')))
+                        buffer[out++] = ch;
+                }
+                return out;
+            };
+
+            // Text getTextPrefix read past its limit comes first, after a surrogate the UTF-8 getText held back
+            size_t result = 0;
+            auto& unread = m_impl->m_unread;
+            if (m_impl->m_pending_surrogate != 0)
+            {
+                unread.insert(unread.begin(), m_impl->m_pending_surrogate);
+                m_impl->m_pending_surrogate = 0;
+            }
+            if (!unread.empty())
+            {
+                size_t count = std::min(unread.size(), buffer_size - 1);
+                std::copy_n(unread.begin(), count, buffer);
+                unread.erase(0, count);
+                result = strip(count);
+            }
+
+            if (result == 0)
+            {
+                Error_Control_Block ecb = { 0 };
+                IGR_LONG length = static_cast<IGR_LONG>(buffer_size - 1);
+                IGR_RETURN_CODE rc = IGR_Get_Text(m_impl->need_handle(), reinterpret_cast<IGR_UCS2*>(buffer), &length, &ecb);
+                if (failed(rc))
+                {
+                    buffer[0] = 0;
+                    return ErrorInfo(rc, ecb, "IGR_Get_Text");
+                }
+                m_impl->m_eof = length == 0;
+                result = strip(static_cast<size_t>(length));
+            }
+            buffer[result] = 0;
+            return result;
+        }
+
+        bool Extractor::getTextPrefix(std::u16string& text, size_t max_length, bool strip_control_chars)
+        {
+            static const size_t block_size = 0x1000;
+
+            if (max_length == 0)
+                throw std::invalid_argument("max_length");
 
-            auto&& res = u16_to_w(&buffer[0], length);
+            // One code unit of room past the limit tells a truncated prefix from one that ends exactly at it
+            text.resize(max_length + 1);
+            size_t length = 0;
+            while (length <= max_length)
+            {
+                size_t wanted = std::min(block_size, max_length + 1 - length);
+                size_t got = getText(&text[length], wanted + 1, strip_control_chars);
+                if (got == 0 && m_impl->m_eof)
+                    break;
+                length += got;
+            }
 
-            if (strip_control_chars)
+            bool truncated = length > max_length;
+            if (truncated)
             {
-                // Replace \xE with new line
-                std::replace(res.begin(), res.end(), '\xE', '\n');
+                size_t end = length;
+                length = max_length;
+                if (text[length - 1] >= 0xD800 && text[length - 1] <= 0xDBFF) // NOLINT
+                    --length;
+
+                // Keep what was read past the limit so the next getText carries on from the end of the prefix
+                m_impl->m_unread.insert(0, text, length, end - length);
+            }
+            text.resize(length);
+            return truncated;
+        }
 
-                // Strip \x01-\x08,\x0b,\x0c-\x10
-                res.erase(std::remove_if(res.begin(), res.end(), [](wchar_t ch) {
-                    return (ch >= '\x01' && ch <= '\x08') || ch == '\x0B' || (ch >= '\x0C' && ch <= '\x10');
-                }), res.end());
+        TextPrefix Extractor::getTextPrefix(size_t max_length, bool strip_control_chars)
+        {
+            auto& buffer = m_impl->m_text_buffer;
+            TextPrefix result;
+            result.truncated = getTextPrefix(buffer, max_length, strip_control_chars);
+            result.text = u16_to_w(buffer.data(), buffer.size());
+            return result;
+        }
+
+        TextPrefix Extractor::ExtractTextPrefix(size_t max_length, const OptionSet& options, bool strip_control_chars)
+        {
+            // Pages with little text, such as slides, hold a few hundred code units; assume that little so the
+            // limit is reached by the text rather than by the pages, with one page to spare
+            static const size_t min_page_length = 256;
+
+            if (max_length == 0)
+                throw std::invalid_argument("max_length");
+
+            auto read = [&](const OptionSet& open_options) {
+                Open(OpenMode::Text, IGR_BODY_ONLY, open_options);
+                TextPrefix result;
+                try
+                {
+                    result = getTextPrefix(max_length, strip_control_chars);
+                }
+                catch (...)
+                {
+                    Close();
+                    throw;
+                }
+                Close();
+                return result;
+            };
+
+            if (options.contains(L"LIMIT_PAGES"))
+                return read(options);
+
+            size_t pages = std::min<size_t>(max_length / min_page_length + 2, std::numeric_limits<int>::max());
+            TextPrefix result = read(OptionSet(options).set(L"LIMIT_PAGES", static_cast<int>(pages)));
+
+            // Text that ends short may have been cut by the page limit rather than by the document; read it again
+            // without the limit so truncated is exact. Only short documents and sparse pages pay for this.
+            if (!result.truncated)
+                result = read(options);
+            return result;
+        }
+
+        Metadata Extractor::getMetadata(const OptionSet& options)
+        {
+            static const size_t block_size = 0x1000;
+
+            Open(OpenMode::Text, IGR_META_ONLY, options);
+
+            // Read only as far as the end of the metadata block
+            auto& buffer = m_impl->m_text_buffer;
+            buffer.clear();
+            try
+            {
+                for (;;)
+                {
+                    size_t start = buffer.size();
+                    buffer.resize(start + block_size + 1);
+                    size_t got = getText(&buffer[start], block_size + 1);
+                    buffer.resize(start + got);
+                    if (std::find(buffer.begin() + static_cast<std::ptrdiff_t>(start), buffer.end(), IGR_CHAR_END_META) != buffer.end() || (got == 0 && m_impl->m_eof))
+                        break;
+                }
+            }
+            catch (...)
+            {
+                Close();
+                throw;
             }
+            Close();
 
-            return res;
+            return Metadata::Parse(buffer.data(), buffer.size());
         }
 
 		bool Extractor::getEOF() const
@@ -449,54 +813,51 @@ namespace Hyland
 			return m_impl->m_eof;
 		}
 
-		void Extractor::SaveTo(const std::wstring& filename, int code_page)
+		void Extractor::SaveTo(const std::wstring& filename, int code_page, bool strip_control_chars)
 		{
 			std::ofstream Stream(w_to_u8(filename), std::ios::binary);
 			if (!Stream)
 				throw std::runtime_error("Failed to open file for writing");
-			SaveTo(Stream, code_page);
+			SaveTo(Stream, code_page, strip_control_chars);
 		}
 
-		void Extractor::SaveTo(std::ostream& Stream, int code_page)
+		void Extractor::SaveTo(std::ostream& Stream, int code_page, bool strip_control_chars)
 		{
-			static const int utf8 = 65001;
 			static const int utf16le = 1200;
 			static const int utf16be = 1201;
 			static const int utf32le = 12000;
 			static const int utf32be = 12001;
+			static const bool little_endian = TARGET_LITTLE_ENDIAN == 1;
 
-			while (!getEOF())
+			switch (code_page)
 			{
-				std::wstring text = getText(4096); // NOLINT
-				if (text.empty())
-					break;
-
-				switch (code_page)
-				{
-				case utf16le: // UTF-16 LE 
-				case utf16be: // UTF-16 BE
-				{
-					std::u16string utf16 = w_to_u16(text);
-					prepare_endianness(utf16, code_page == utf16le);
-					Stream.write(reinterpret_cast<const char*>(utf16.c_str()), utf16.size() * sizeof(char16_t));
-				}
-				break;
-				case utf32le: // UTF-32 LE
-				case utf32be: // UTF-32 BE
-				{
-					std::u32string utf32 = w_to_u32(text);
-					prepare_endianness(utf32, code_page == utf32le);
-					Stream.write(reinterpret_cast<const char*>(utf32.c_str()), utf32.size() * sizeof(char32_t));
-				}
-				break;
-				case utf8:
-				default:
-				{
-					std::string utf8 = w_to_u8(text);
-					Stream.write(utf8.c_str(), utf8.size());
-				}
+			case utf16le: // UTF-16 LE
+			case utf16be: // UTF-16 BE
+			{
+				bool swap = (code_page == utf16le) != little_endian;
+				m_impl->save_text<std::u16string>(*this, Stream, [&](std::u16string& block, const char16_t* text, size_t length)
+					{
+						// UTF-16 is written unit for unit, unpaired surrogates included
+						u16_append_encoded(block, text, length, strip_control_chars, swap);
+					});
+			}
+			break;
+			case utf32le: // UTF-32 LE
+			case utf32be: // UTF-32 BE
+			{
+				bool swap = (code_page == utf32le) != little_endian;
+				m_impl->save_text<std::u32string>(*this, Stream, [&](std::u32string& block, const char16_t* text, size_t length)
+					{
+						u16_append_encoded(block, text, length, strip_control_chars, swap);
+					});
+			}
+			break;
+			default: // UTF-8
+				m_impl->save_text<std::string>(*this, Stream, [&](std::string& block, const char16_t* text, size_t length)
+					{
+						u16_append_encoded(block, text, length, strip_control_chars);
+					});
 				break;
-				}
 			}
 		}
 
@@ -554,11 +915,71 @@ namespace Hyland
 			return u16_to_w(buffer);
 		}
 
+		void Extractor::enableHashing(const HashingStreamOptions& options)
+		{
+			if (m_impl->has_handle())
+				throw DocumentFilters::Error("Hashing must be enabled before the document is opened");
+			if (m_impl->m_hashing != nullptr)
+				return;
+
+			// The reader only takes ownership of the original stream once the bridge exists, so a failure leaves it untouched
+			auto reader = impl_t::make_part_reader(m_impl);
+			auto hashing = std::make_unique<HashingStream>(reader, true, options);
+			IGR_Stream* wrapped = nullptr;
+			Stream::bridge_stream(hashing.get(), true, &wrapped);
+			reader->take_ownership();
+
+			m_impl->m_stream = wrapped;
+			m_impl->m_hashing = hashing.release(); // NOLINT: owned by the bridged stream
+			m_impl->m_parts_bridged = true;
+		}
+
+		StreamDigests Extractor::getDigests()
+		{
+			if (m_impl->m_hashing != nullptr)
+				return m_impl->m_hashing->getDigests();
+
+			HashingStream hashing(new igr_stream_reader_t(need_stream(), false), true);
+			return hashing.getDigests();
+		}
+
+		void Extractor::enableTracing(const TracingStreamOptions& options)
+		{
+			if (m_impl->has_handle())
+				throw DocumentFilters::Error("Tracing must be enabled before the document is opened");
+			if (m_impl->m_tracing != nullptr)
+				return;
+
+			auto reader = impl_t::make_part_reader(m_impl);
+			auto tracing = std::make_unique<TracingStream>(reader, true, options);
+			IGR_Stream* wrapped = nullptr;
+			Stream::bridge_stream(tracing.get(), true, &wrapped);
+			reader->take_ownership();
+
+			m_impl->m_stream = wrapped;
+			m_impl->m_tracing = tracing.release(); // NOLINT: owned by the bridged stream
+			m_impl->m_parts_bridged = true;
+		}
+
+		IoTraceStats Extractor::getIoTrace() const
+		{
+			if (m_impl->m_tracing == nullptr)
+				throw DocumentFilters::Error("Tracing is not enabled");
+			return m_impl->m_tracing->getStats();
+		}
+
 		size_t Extractor::getPageCount() const
+		{
+			return TryGetPageCount().value();
+		}
+
+		Result<size_t> Extractor::TryGetPageCount() const
 		{
 			Error_Control_Block ecb = { 0 };
 			IGR_LONG res = 0;
-			throw_on_error(IGR_Get_Page_Count(m_impl->need_handle(), &res, &ecb), ecb, "IGR_Get_Page_Count");
+			IGR_RETURN_CODE rc = IGR_Get_Page_Count(m_impl->need_handle(), &res, &ecb);
+			if (failed(rc))
+				return ErrorInfo(rc, ecb, "IGR_Get_Page_Count");
 			return static_cast<size_t>(res);
 		}
 
@@ -567,9 +988,16 @@ namespace Hyland
 			if (index > getPageCount())
 				throw std::out_of_range("index");
 
+			return TryGetPage(index).value();
+		}
+
+		Result<Page> Extractor::TryGetPage(size_t index) const
+		{
 			Error_Control_Block ecb = { 0 };
 			IGR_HPAGE p = 0;
-			throw_on_error(IGR_Open_Page(m_impl->need_handle(), static_cast<IGR_LONG>(index), &p, &ecb), ecb, "IGR_Get_Page");
+			IGR_RETURN_CODE rc = IGR_Open_Page(m_impl->need_handle(), static_cast<IGR_LONG>(index), &p, &ecb);
+			if (failed(rc))
+				return ErrorInfo(rc, ecb, "IGR_Get_Page");
 			return Page(p, index);
 		}
 
@@ -590,13 +1018,20 @@ namespace Hyland
 		}
 
 		Subfile Extractor::getSubFile(const std::wstring& id) const
+		{
+			return TryGetSubFile(id).value();
+		}
+
+		Result<Subfile> Extractor::TryGetSubFile(const std::wstring& id) const
 		{
 			if (id.empty())
 				throw std::invalid_argument("id");
 
 			Error_Control_Block ecb = { 0 };
 			IGR_Stream* Stream = nullptr;
-			throw_on_error(IGR_Extract_Subfile_Stream(m_impl->need_handle(), reinterpret_cast<const IGR_UCS2*>(w_to_u16(id).c_str()), &Stream, &ecb), ecb, "IGR_Extract_Subfile_Stream");
+			IGR_RETURN_CODE rc = IGR_Extract_Subfile_Stream(m_impl->need_handle(), reinterpret_cast<const IGR_UCS2*>(w_to_u16(id).c_str()), &Stream, &ecb);
+			if (failed(rc))
+				return ErrorInfo(rc, ecb, "IGR_Extract_Subfile_Stream");
 			return Subfile(m_impl->need_handle(), id, Stream);
 		}
 
@@ -609,13 +1044,20 @@ namespace Hyland
 		}
 
 		Subfile Extractor::getImage(const std::wstring& id) const
+		{
+			return TryGetImage(id).value();
+		}
+
+		Result<Subfile> Extractor::TryGetImage(const std::wstring& id) const
 		{
 			if (id.empty())
 				throw std::invalid_argument("id");
 
 			Error_Control_Block ecb = { 0 };
 			IGR_Stream* Stream = nullptr;
-			throw_on_error(IGR_Extract_Image_Stream(m_impl->need_handle(), reinterpret_cast<const IGR_UCS2*>(w_to_u16(id).c_str()), &Stream, &ecb), ecb, "IGR_Extract_Image_Stream");
+			IGR_RETURN_CODE rc = IGR_Extract_Image_Stream(m_impl->need_handle(), reinterpret_cast<const IGR_UCS2*>(w_to_u16(id).c_str()), &Stream, &ecb);
+			if (failed(rc))
+				return ErrorInfo(rc, ecb, "IGR_Extract_Image_Stream");
 			return Subfile(m_impl->need_handle(), id, Stream);
 		}
 
@@ -631,6 +1073,9 @@ namespace Hyland
 		{
 			IGR_Stream* res = m_impl->m_stream;
 			m_impl->m_stream = nullptr;
+			m_impl->m_hashing = nullptr;
+			m_impl->m_tracing = nullptr;
+			m_impl->m_parts_bridged = false;
 
 			return res;
 		}
@@ -0,0 +1,726 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		namespace
+		{
+			inline uint32_t rotl32(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+			inline uint32_t rotr32(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+			inline uint64_t rotl64(uint64_t x, int n) { return (x << n) | (x >> (64 - n)); }
+
+			inline uint32_t read_le32(const uint8_t* p)
+			{
+				return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+					| (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+			}
+
+			inline uint64_t read_le64(const uint8_t* p)
+			{
+				return static_cast<uint64_t>(read_le32(p)) | (static_cast<uint64_t>(read_le32(p + 4)) << 32);
+			}
+
+			inline uint32_t read_be32(const uint8_t* p)
+			{
+				return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+					| (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+			}
+
+			std::wstring to_hex(const uint8_t* data, size_t size)
+			{
+				static const wchar_t digits[] = L"0123456789abcdef";
+				std::wstring result(size * 2, L'0');
+				for (size_t i = 0; i < size; ++i)
+				{
+					result[i * 2] = digits[data[i] >> 4];
+					result[i * 2 + 1] = digits[data[i] & 0x0f];
+				}
+				return result;
+			}
+
+			/// Buffering and length padding shared by the Merkle-Damgard hashes, which all use 64 byte blocks.
+			template <typename Derived>
+			class block_hash_t
+			{
+			public:
+				void update(const uint8_t* data, size_t size)
+				{
+					m_length += size;
+					if (m_used > 0)
+					{
+						size_t n = std::min(sizeof(m_block) - m_used, size);
+						std::memcpy(m_block + m_used, data, n);
+						m_used += n;
+						data += n;
+						size -= n;
+						if (m_used < sizeof(m_block))
+							return;
+						static_cast<Derived*>(this)->compress(m_block);
+						m_used = 0;
+					}
+					for (; size >= sizeof(m_block); data += sizeof(m_block), size -= sizeof(m_block))
+						static_cast<Derived*>(this)->compress(data);
+					if (size > 0)
+					{
+						std::memcpy(m_block, data, size);
+						m_used = size;
+					}
+				}
+
+			protected:
+				void pad(bool big_endian_length)
+				{
+					uint64_t bits = m_length * 8;
+					uint8_t padding[64] = { 0x80 };
+					uint8_t length[8];
+					for (int i = 0; i < 8; ++i)
+						length[i] = static_cast<uint8_t>(big_endian_length ? bits >> (56 - 8 * i) : bits >> (8 * i));
+					update(padding, (m_used < 56 ? 56 : 120) - m_used);
+					update(length, sizeof(length));
+				}
+
+				uint8_t m_block[64] = { 0 };
+				size_t m_used = 0;
+				uint64_t m_length = 0;
+			};
+
+			class md5_t : public block_hash_t<md5_t>
+			{
+				friend class block_hash_t<md5_t>;
+				uint32_t m_state[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+
+				void compress(const uint8_t* block)
+				{
+					static const uint32_t k[64] = {
+						0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+						0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+						0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+						0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+						0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+						0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+						0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+						0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+					};
+					static const int shifts[16] = { 7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21 };
+
+					uint32_t m[16];
+					for (int i = 0; i < 16; ++i)
+						m[i] = read_le32(block + i * 4);
+
+					uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+					for (int i = 0; i < 64; ++i)
+					{
+						uint32_t f;
+						int g;
+						switch (i / 16)
+						{
+						case 0: f = (b & c) | (~b & d); g = i; break;
+						case 1: f = (d & b) | (~d & c); g = (5 * i + 1) % 16; break;
+						case 2: f = b ^ c ^ d; g = (3 * i + 5) % 16; break;
+						default: f = c ^ (b | ~d); g = (7 * i) % 16; break;
+						}
+						f += a + k[i] + m[g];
+						a = d;
+						d = c;
+						c = b;
+						b += rotl32(f, shifts[(i / 16) * 4 + i % 4]);
+					}
+					m_state[0] += a;
+					m_state[1] += b;
+					m_state[2] += c;
+					m_state[3] += d;
+				}
+
+			public:
+				std::wstring finish()
+				{
+					pad(false);
+					uint8_t digest[16];
+					for (int i = 0; i < 16; ++i)
+						digest[i] = static_cast<uint8_t>(m_state[i / 4] >> (8 * (i % 4)));
+					return to_hex(digest, sizeof(digest));
+				}
+			};
+
+			class sha1_t : public block_hash_t<sha1_t>
+			{
+				friend class block_hash_t<sha1_t>;
+				uint32_t m_state[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+				void compress(const uint8_t* block)
+				{
+					uint32_t w[80];
+					for (int i = 0; i < 16; ++i)
+						w[i] = read_be32(block + i * 4);
+					for (int i = 16; i < 80; ++i)
+						w[i] = rotl32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+					uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3], e = m_state[4];
+					for (int i = 0; i < 80; ++i)
+					{
+						uint32_t f, k;
+						if (i < 20) { f = (b & c) | (~b & d); k = 0x5a827999; }
+						else if (i < 40) { f = b ^ c ^ d; k = 0x6ed9eba1; }
+						else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8f1bbcdc; }
+						else { f = b ^ c ^ d; k = 0xca62c1d6; }
+						uint32_t t = rotl32(a, 5) + f + e + k + w[i];
+						e = d;
+						d = c;
+						c = rotl32(b, 30);
+						b = a;
+						a = t;
+					}
+					m_state[0] += a;
+					m_state[1] += b;
+					m_state[2] += c;
+					m_state[3] += d;
+					m_state[4] += e;
+				}
+
+			public:
+				std::wstring finish()
+				{
+					pad(true);
+					uint8_t digest[20];
+					for (int i = 0; i < 20; ++i)
+						digest[i] = static_cast<uint8_t>(m_state[i / 4] >> (24 - 8 * (i % 4)));
+					return to_hex(digest, sizeof(digest));
+				}
+			};
+
+			class sha256_t : public block_hash_t<sha256_t>
+			{
+				friend class block_hash_t<sha256_t>;
+				uint32_t m_state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+				void compress(const uint8_t* block)
+				{
+					static const uint32_t k[64] = {
+						0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+						0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+						0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+						0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+						0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+						0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+						0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+						0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+					};
+
+					uint32_t w[64];
+					for (int i = 0; i < 16; ++i)
+						w[i] = read_be32(block + i * 4);
+					for (int i = 16; i < 64; ++i)
+					{
+						uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+						uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+						w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+					}
+
+					uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+					uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+					for (int i = 0; i < 64; ++i)
+					{
+						uint32_t s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+						uint32_t ch = (e & f) ^ (~e & g);
+						uint32_t t1 = h + s1 + ch + k[i] + w[i];
+						uint32_t s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+						uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+						uint32_t t2 = s0 + maj;
+						h = g;
+						g = f;
+						f = e;
+						e = d + t1;
+						d = c;
+						c = b;
+						b = a;
+						a = t1 + t2;
+					}
+					m_state[0] += a;
+					m_state[1] += b;
+					m_state[2] += c;
+					m_state[3] += d;
+					m_state[4] += e;
+					m_state[5] += f;
+					m_state[6] += g;
+					m_state[7] += h;
+				}
+
+			public:
+				std::wstring finish()
+				{
+					pad(true);
+					uint8_t digest[32];
+					for (int i = 0; i < 32; ++i)
+						digest[i] = static_cast<uint8_t>(m_state[i / 4] >> (24 - 8 * (i % 4)));
+					return to_hex(digest, sizeof(digest));
+				}
+			};
+
+			/// Streaming XXH3 64-bit with the default secret and seed 0, following the reference implementation.
+			class xxh3_t
+			{
+				static constexpr uint32_t prime32_1 = 0x9E3779B1U;
+				static constexpr uint32_t prime32_2 = 0x85EBCA77U;
+				static constexpr uint32_t prime32_3 = 0xC2B2AE3DU;
+				static constexpr uint64_t prime64_1 = 0x9E3779B185EBCA87ULL;
+				static constexpr uint64_t prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+				static constexpr uint64_t prime64_3 = 0x165667B19E3779F9ULL;
+				static constexpr uint64_t prime64_4 = 0x85EBCA77C2B2AE63ULL;
+				static constexpr uint64_t prime64_5 = 0x27D4EB2F165667C5ULL;
+				static constexpr uint64_t prime_mx1 = 0x165667919E3779F9ULL;
+				static constexpr uint64_t prime_mx2 = 0x9FB21C651E98DF25ULL;
+
+				static constexpr size_t stripe_len = 64;
+				static constexpr size_t secret_size = 192;
+				static constexpr size_t secret_limit = secret_size - stripe_len;
+				static constexpr size_t stripes_per_block = secret_limit / 8;
+				static constexpr size_t buffer_size = 256;
+				static constexpr size_t midsize_max = 240;
+
+				static const uint8_t* secret()
+				{
+					static const uint8_t k_secret[secret_size] = {
+						0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+						0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+						0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+						0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+						0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+						0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+						0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+						0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+						0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+						0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+						0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+						0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+					};
+					return k_secret;
+				}
+
+				static uint64_t mul128_fold64(uint64_t lhs, uint64_t rhs)
+				{
+#if defined(__SIZEOF_INT128__)
+					unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+					return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+					uint64_t lo_lo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+					uint64_t hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+					uint64_t lo_hi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+					uint64_t hi_hi = (lhs >> 32) * (rhs >> 32);
+					uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+					uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+					uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+					return lower ^ upper;
+#endif
+				}
+
+				static uint64_t xxh64_avalanche(uint64_t h)
+				{
+					h ^= h >> 33;
+					h *= prime64_2;
+					h ^= h >> 29;
+					h *= prime64_3;
+					h ^= h >> 32;
+					return h;
+				}
+
+				static uint64_t avalanche(uint64_t h)
+				{
+					h ^= h >> 37;
+					h *= prime_mx1;
+					h ^= h >> 32;
+					return h;
+				}
+
+				static uint64_t rrmxmx(uint64_t h, uint64_t length)
+				{
+					h ^= rotl64(h, 49) ^ rotl64(h, 24);
+					h *= prime_mx2;
+					h ^= (h >> 35) + length;
+					h *= prime_mx2;
+					return h ^ (h >> 28);
+				}
+
+				static uint64_t mix16(const uint8_t* input, const uint8_t* key)
+				{
+					return mul128_fold64(read_le64(input) ^ read_le64(key), read_le64(input + 8) ^ read_le64(key + 8));
+				}
+
+				static uint64_t hash_short(const uint8_t* input, size_t length)
+				{
+					const uint8_t* key = secret();
+					if (length > 128)
+					{
+						uint64_t acc = length * prime64_1;
+						for (size_t i = 0; i < 8; ++i)
+							acc += mix16(input + 16 * i, key + 16 * i);
+						uint64_t acc_end = mix16(input + length - 16, key + 136 - 17);
+						acc = avalanche(acc);
+						for (size_t i = 8; i < length / 16; ++i)
+							acc_end += mix16(input + 16 * i, key + 16 * (i - 8) + 3);
+						return avalanche(acc + acc_end);
+					}
+					if (length > 16)
+					{
+						uint64_t acc = length * prime64_1;
+						if (length > 32)
+						{
+							if (length > 64)
+							{
+								if (length > 96)
+								{
+									acc += mix16(input + 48, key + 96);
+									acc += mix16(input + length - 64, key + 112);
+								}
+								acc += mix16(input + 32, key + 64);
+								acc += mix16(input + length - 48, key + 80);
+							}
+							acc += mix16(input + 16, key + 32);
+							acc += mix16(input + length - 32, key + 48);
+						}
+						acc += mix16(input, key);
+						acc += mix16(input + length - 16, key + 16);
+						return avalanche(acc);
+					}
+					if (length > 8)
+					{
+						uint64_t lo = read_le64(input) ^ (read_le64(key + 24) ^ read_le64(key + 32));
+						uint64_t hi = read_le64(input + length - 8) ^ (read_le64(key + 40) ^ read_le64(key + 48));
+						uint64_t swapped = 0;
+						for (int i = 0; i < 8; ++i)
+							swapped |= ((lo >> (8 * i)) & 0xff) << (56 - 8 * i);
+						return avalanche(length + swapped + hi + mul128_fold64(lo, hi));
+					}
+					if (length >= 4)
+					{
+						uint64_t input64 = read_le32(input + length - 4) + (static_cast<uint64_t>(read_le32(input)) << 32);
+						return rrmxmx(input64 ^ (read_le64(key + 8) ^ read_le64(key + 16)), length);
+					}
+					if (length > 0)
+					{
+						uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) | (static_cast<uint32_t>(input[length >> 1]) << 24)
+							| static_cast<uint32_t>(input[length - 1]) | (static_cast<uint32_t>(length) << 8);
+						return xxh64_avalanche(combined ^ (static_cast<uint64_t>(read_le32(key)) ^ read_le32(key + 4)));
+					}
+					return xxh64_avalanche(read_le64(key + 56) ^ read_le64(key + 64));
+				}
+
+				static void accumulate_512(uint64_t* acc, const uint8_t* input, const uint8_t* key)
+				{
+					for (size_t lane = 0; lane < 8; ++lane)
+					{
+						uint64_t data_val = read_le64(input + lane * 8);
+						uint64_t data_key = data_val ^ read_le64(key + lane * 8);
+						acc[lane ^ 1] += data_val;
+						acc[lane] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+					}
+				}
+
+				static void scramble(uint64_t* acc, const uint8_t* key)
+				{
+					for (size_t lane = 0; lane < 8; ++lane)
+					{
+						uint64_t a = acc[lane];
+						a ^= a >> 47;
+						a ^= read_le64(key + lane * 8);
+						a *= prime32_1;
+						acc[lane] = a;
+					}
+				}
+
+				static const uint8_t* consume_stripes(uint64_t* acc, size_t& stripes_so_far, const uint8_t* input, size_t stripes)
+				{
+					const uint8_t* key = secret();
+					const uint8_t* initial_key = key + stripes_so_far * 8;
+					if (stripes >= stripes_per_block - stripes_so_far)
+					{
+						size_t this_iter = stripes_per_block - stripes_so_far;
+						do
+						{
+							for (size_t n = 0; n < this_iter; ++n)
+								accumulate_512(acc, input + n * stripe_len, initial_key + n * 8);
+							scramble(acc, key + secret_limit);
+							input += this_iter * stripe_len;
+							stripes -= this_iter;
+							this_iter = stripes_per_block;
+							initial_key = key;
+						} while (stripes >= stripes_per_block);
+						stripes_so_far = 0;
+					}
+					if (stripes > 0)
+					{
+						for (size_t n = 0; n < stripes; ++n)
+							accumulate_512(acc, input + n * stripe_len, initial_key + n * 8);
+						input += stripes * stripe_len;
+						stripes_so_far += stripes;
+					}
+					return input;
+				}
+
+				uint64_t m_acc[8] = { prime32_3, prime64_1, prime64_2, prime64_3, prime64_4, prime32_2, prime64_5, prime32_1 };
+				uint8_t m_buffer[buffer_size] = { 0 };
+				size_t m_buffered = 0;
+				size_t m_stripes_so_far = 0;
+				uint64_t m_total = 0;
+
+			public:
+				void update(const uint8_t* input, size_t length)
+				{
+					const uint8_t* end = input + length;
+					m_total += length;
+
+					if (length <= buffer_size - m_buffered)
+					{
+						std::memcpy(m_buffer + m_buffered, input, length);
+						m_buffered += length;
+						return;
+					}
+
+					if (m_buffered > 0)
+					{
+						size_t load = buffer_size - m_buffered;
+						std::memcpy(m_buffer + m_buffered, input, load);
+						input += load;
+						consume_stripes(m_acc, m_stripes_so_far, m_buffer, buffer_size / stripe_len);
+						m_buffered = 0;
+					}
+
+					if (static_cast<size_t>(end - input) > buffer_size)
+					{
+						size_t stripes = static_cast<size_t>(end - 1 - input) / stripe_len;
+						input = consume_stripes(m_acc, m_stripes_so_far, input, stripes);
+						std::memcpy(m_buffer + buffer_size - stripe_len, input - stripe_len, stripe_len);
+					}
+
+					std::memcpy(m_buffer, input, static_cast<size_t>(end - input));
+					m_buffered = static_cast<size_t>(end - input);
+				}
+
+				std::wstring finish()
+				{
+					uint64_t result;
+					if (m_total > midsize_max)
+					{
+						uint64_t acc[8];
+						std::memcpy(acc, m_acc, sizeof(acc));
+						uint8_t last_stripe[stripe_len];
+						const uint8_t* last = last_stripe;
+						if (m_buffered >= stripe_len)
+						{
+							size_t stripes_so_far = m_stripes_so_far;
+							consume_stripes(acc, stripes_so_far, m_buffer, (m_buffered - 1) / stripe_len);
+							last = m_buffer + m_buffered - stripe_len;
+						}
+						else
+						{
+							size_t catchup = stripe_len - m_buffered;
+							std::memcpy(last_stripe, m_buffer + buffer_size - catchup, catchup);
+							std::memcpy(last_stripe + catchup, m_buffer, m_buffered);
+						}
+						accumulate_512(acc, last, secret() + secret_limit - 7);
+
+						const uint8_t* key = secret() + 11;
+						result = m_total * prime64_1;
+						for (size_t i = 0; i < 4; ++i)
+							result += mul128_fold64(acc[2 * i] ^ read_le64(key + 16 * i), acc[2 * i + 1] ^ read_le64(key + 16 * i + 8));
+						result = avalanche(result);
+					}
+					else
+						result = hash_short(m_buffer, static_cast<size_t>(m_total));
+
+					uint8_t digest[8];
+					for (int i = 0; i < 8; ++i)
+						digest[i] = static_cast<uint8_t>(result >> (56 - 8 * i));
+					return to_hex(digest, sizeof(digest));
+				}
+			};
+		} // namespace
+
+		class HashingStream::impl_t
+		{
+		public:
+			Stream* m_stream;
+			bool m_own;
+			Options m_options;
+
+			md5_t m_md5;
+			sha1_t m_sha1;
+			sha256_t m_sha256;
+			xxh3_t m_xxh3;
+
+			uint64_t m_hashed = 0;
+			int64_t m_position = 0;
+			std::map<uint64_t, std::vector<uint8_t>> m_pending; // out-of-order reads waiting for the hashes to reach them
+			size_t m_pending_bytes = 0;
+
+			bool m_finished = false;
+			StreamDigests m_digests;
+
+			impl_t(Stream* stream, bool own, const Options& options)
+				: m_stream(stream), m_own(own), m_options(options)
+			{
+				if (m_stream == nullptr)
+					throw std::invalid_argument("stream cannot be null");
+				m_position = std::max<int64_t>(0, m_stream->seek(0, std::ios::cur));
+			}
+
+			~impl_t()
+			{
+				if (m_own)
+					delete m_stream;
+			}
+
+			void hash(const uint8_t* data, size_t size)
+			{
+				m_md5.update(data, size);
+				m_sha1.update(data, size);
+				m_sha256.update(data, size);
+				m_xxh3.update(data, size);
+				m_hashed += size;
+			}
+
+			void drain()
+			{
+				while (!m_pending.empty() && m_pending.begin()->first <= m_hashed)
+				{
+					auto it = m_pending.begin();
+					uint64_t end = it->first + it->second.size();
+					if (end > m_hashed)
+					{
+						size_t skip = static_cast<size_t>(m_hashed - it->first);
+						hash(it->second.data() + skip, it->second.size() - skip);
+					}
+					m_pending_bytes -= it->second.size();
+					m_pending.erase(it);
+				}
+			}
+
+			void ingest(uint64_t offset, const uint8_t* data, size_t size)
+			{
+				if (m_finished || size == 0 || offset + size <= m_hashed)
+					return;
+
+				if (offset <= m_hashed)
+				{
+					size_t skip = static_cast<size_t>(m_hashed - offset);
+					hash(data + skip, size - skip);
+					drain();
+				}
+				else if (m_pending_bytes + size <= m_options.reorder_limit)
+				{
+					auto& pending = m_pending[offset];
+					if (pending.size() < size)
+					{
+						m_pending_bytes += size - pending.size();
+						pending.assign(data, data + size);
+					}
+				}
+			}
+
+			size_t read(void* buffer, size_t size)
+			{
+				size_t got = m_stream->read(buffer, size);
+				ingest(static_cast<uint64_t>(m_position), static_cast<const uint8_t*>(buffer), got);
+				m_position += static_cast<int64_t>(got);
+				return got;
+			}
+
+			void finish()
+			{
+				if (m_finished)
+					return;
+
+				// Read whatever the engine skipped, stopping at out-of-order data that is already buffered
+				std::vector<uint8_t> buffer(256 * 1024);
+				int64_t inner = -1;
+				for (;;)
+				{
+					drain();
+					uint64_t limit = m_pending.empty() ? std::numeric_limits<uint64_t>::max() : m_pending.begin()->first;
+					size_t want = static_cast<size_t>(std::min<uint64_t>(buffer.size(), limit - m_hashed));
+
+					if (inner != static_cast<int64_t>(m_hashed))
+					{
+						inner = m_stream->seek(static_cast<std::streamoff>(m_hashed), std::ios::beg);
+						if (inner != static_cast<int64_t>(m_hashed))
+							break;
+					}
+					size_t got = m_stream->read(buffer.data(), want);
+					if (got == 0)
+						break;
+					inner += static_cast<int64_t>(got);
+					m_digests.filled_bytes += got;
+					hash(buffer.data(), got);
+				}
+				if (inner != -1)
+					m_stream->seek(static_cast<std::streamoff>(m_position), std::ios::beg);
+
+				m_pending.clear();
+				m_pending_bytes = 0;
+				m_finished = true;
+
+				m_digests.md5 = m_md5.finish();
+				m_digests.sha1 = m_sha1.finish();
+				m_digests.sha256 = m_sha256.finish();
+				m_digests.xxh3 = m_xxh3.finish();
+				m_digests.size = m_hashed;
+			}
+		};
+
+		HashingStream::HashingStream(Stream* stream, bool own_stream, const Options& options)
+			: m_impl(std::make_unique<impl_t>(stream, own_stream, options))
+		{
+		}
+
+		HashingStream::~HashingStream() = default;
+
+		std::streamoff HashingStream::seek(std::streampos offset, std::ios_base::seekdir way)
+		{
+			std::streamoff result = m_impl->m_stream->seek(offset, way);
+			if (result >= 0)
+				m_impl->m_position = result;
+			return result;
+		}
+
+		size_t HashingStream::read(void* buffer, size_t size)
+		{
+			return m_impl->read(buffer, size);
+		}
+
+		std::unique_ptr<Stream> HashingStream::get_stream_part(const std::wstring& part_name, const std::wstring& full_name, int index)
+		{
+			return m_impl->m_stream->get_stream_part(part_name, full_name, index);
+		}
+
+		StreamDigests HashingStream::getDigests()
+		{
+			m_impl->finish();
+			return m_impl->m_digests;
+		}
+
+		uint64_t HashingStream::getHashedBytes() const
+		{
+			return m_impl->m_hashed;
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
@@ -0,0 +1,311 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		class MappedFileStream::impl_t
+		{
+		public:
+#ifdef _WIN32
+			HANDLE m_file = INVALID_HANDLE_VALUE;
+			HANDLE m_mapping = nullptr;
+#else
+			int m_fd = -1;
+#endif
+			const uint8_t* m_data = nullptr;
+			uint64_t m_size = 0;
+			uint64_t m_offset = 0;
+
+			impl_t(const std::wstring& filename, AccessHint hint)
+			{
+#ifdef _WIN32
+				DWORD flags = FILE_ATTRIBUTE_NORMAL;
+				if (hint == AccessHint::Random)
+					flags |= FILE_FLAG_RANDOM_ACCESS;
+				else if (hint == AccessHint::Sequential)
+					flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+
+				m_file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, flags, nullptr);
+				if (m_file == INVALID_HANDLE_VALUE)
+					throw std::runtime_error("Failed to open file");
+
+				LARGE_INTEGER size;
+				if (!GetFileSizeEx(m_file, &size))
+				{
+					close();
+					throw std::runtime_error("Failed to get file size");
+				}
+				m_size = static_cast<uint64_t>(size.QuadPart);
+
+				if (m_size > 0 && m_size <= static_cast<uint64_t>(SIZE_MAX))
+				{
+					m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+					if (m_mapping != nullptr)
+					{
+						m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+						if (m_data == nullptr)
+						{
+							CloseHandle(m_mapping);
+							m_mapping = nullptr;
+						}
+					}
+				}
+#else
+				m_fd = ::open(w_to_u8(filename).c_str(), O_RDONLY | O_CLOEXEC);
+				if (m_fd < 0)
+					throw std::runtime_error("Failed to open file");
+
+				struct stat st;
+				if (fstat(m_fd, &st) != 0)
+				{
+					close();
+					throw std::runtime_error("Failed to get file size");
+				}
+				m_size = static_cast<uint64_t>(st.st_size);
+
+				if (S_ISREG(st.st_mode) && m_size > 0 && m_size <= static_cast<uint64_t>(SIZE_MAX))
+				{
+					void* data = mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_SHARED, m_fd, 0);
+					if (data != MAP_FAILED)
+					{
+						m_data = static_cast<const uint8_t*>(data);
+						madvise(data, static_cast<size_t>(m_size), hint == AccessHint::Random ? MADV_RANDOM
+							: hint == AccessHint::Sequential ? MADV_SEQUENTIAL
+							: MADV_NORMAL);
+					}
+				}
+#if !defined(__APPLE__)
+				if (m_data == nullptr)
+				{
+					posix_fadvise(m_fd, 0, 0, hint == AccessHint::Random ? POSIX_FADV_RANDOM
+						: hint == AccessHint::Sequential ? POSIX_FADV_SEQUENTIAL
+						: POSIX_FADV_NORMAL);
+				}
+#endif
+#endif
+			}
+
+			~impl_t()
+			{
+				close();
+			}
+
+			void close()
+			{
+#ifdef _WIN32
+				if (m_data)
+					UnmapViewOfFile(m_data);
+				if (m_mapping)
+					CloseHandle(m_mapping);
+				if (m_file != INVALID_HANDLE_VALUE)
+					CloseHandle(m_file);
+				m_mapping = nullptr;
+				m_file = INVALID_HANDLE_VALUE;
+#else
+				if (m_data)
+					munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size)); // NOLINT
+				if (m_fd >= 0)
+					::close(m_fd);
+				m_fd = -1;
+#endif
+				m_data = nullptr;
+				m_size = 0;
+				m_offset = 0;
+			}
+
+			int64_t seek(int64_t offset, int origin)
+			{
+				int64_t base = 0;
+				switch (origin)
+				{
+				case std::ios::beg:
+					base = 0;
+					break;
+				case std::ios::cur:
+					base = static_cast<int64_t>(m_offset);
+					break;
+				case std::ios::end:
+					base = static_cast<int64_t>(m_size);
+					break;
+				default:
+					return -1;
+				}
+				if (base + offset < 0)
+					return -1;
+				m_offset = static_cast<uint64_t>(base + offset);
+				return static_cast<int64_t>(m_offset);
+			}
+
+			size_t read(void* buffer, size_t size)
+			{
+				if (m_offset >= m_size || size == 0)
+					return 0;
+
+				size_t bytes = static_cast<size_t>(std::min<uint64_t>(size, m_size - m_offset));
+				if (m_data)
+				{
+					std::memcpy(buffer, m_data + m_offset, bytes);
+				}
+				else
+				{
+					bytes = read_at(buffer, bytes, m_offset);
+				}
+				m_offset += bytes;
+				return bytes;
+			}
+
+			size_t read_at(void* buffer, size_t size, uint64_t offset)
+			{
+				size_t total = 0;
+				auto dest = static_cast<uint8_t*>(buffer);
+				while (total < size)
+				{
+#ifdef _WIN32
+					OVERLAPPED ov = { 0 };
+					ov.Offset = static_cast<DWORD>(offset + total);
+					ov.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+					DWORD chunk = static_cast<DWORD>(std::min<size_t>(size - total, 0x40000000));
+					DWORD got = 0;
+					if (!ReadFile(m_file, dest + total, chunk, &got, &ov) || got == 0)
+						break;
+#elif defined(__APPLE__)
+					ssize_t got = pread(m_fd, dest + total, size - total, static_cast<off_t>(offset + total));
+					if (got < 0 && errno == EINTR)
+						continue;
+					if (got <= 0)
+						break;
+#else
+					ssize_t got = pread64(m_fd, dest + total, size - total, static_cast<off64_t>(offset + total));
+					if (got < 0 && errno == EINTR)
+						continue;
+					if (got <= 0)
+						break;
+#endif
+					total += static_cast<size_t>(got);
+				}
+				return total;
+			}
+
+			bool is_open() const
+			{
+#ifdef _WIN32
+				return m_file != INVALID_HANDLE_VALUE;
+#else
+				return m_fd >= 0;
+#endif
+			}
+		};
+
+		MappedFileStream::MappedFileStream(const std::string& filename, AccessHint hint)
+			: MappedFileStream(u8_to_w(filename), hint)
+		{
+		}
+
+		MappedFileStream::MappedFileStream(const std::wstring& filename, AccessHint hint)
+			: m_impl(std::make_unique<impl_t>(filename, hint))
+		{
+		}
+
+		MappedFileStream::~MappedFileStream()
+		{
+			close();
+		}
+
+		void MappedFileStream::close()
+		{
+			m_impl.reset();
+		}
+
+		std::streamoff MappedFileStream::seek(std::streampos offset, std::ios_base::seekdir way)
+		{
+			return m_impl ? m_impl->seek(static_cast<int64_t>(offset), static_cast<int>(way)) : -1;
+		}
+
+		size_t MappedFileStream::read(void* buffer, size_t size)
+		{
+			return m_impl ? m_impl->read(buffer, size) : 0;
+		}
+
+		uint64_t MappedFileStream::size() const
+		{
+			return m_impl ? m_impl->m_size : 0;
+		}
+
+		bool MappedFileStream::isMapped() const
+		{
+			return m_impl && m_impl->m_data != nullptr;
+		}
+
+		bool MappedFileStream::get_memory_view(const void*& data, size_t& size) const
+		{
+			if (!isMapped())
+				return false;
+			data = m_impl->m_data;
+			size = static_cast<size_t>(m_impl->m_size);
+			return true;
+		}
+
+		IGR_Stream* MappedFileStream::relinquish_igr_stream()
+		{
+			struct traits
+			{
+				static IGR_ULONG read(impl_t* impl, void* buffer, IGR_ULONG size)
+				{
+					return static_cast<IGR_ULONG>(impl->read(buffer, size));
+				}
+				static IGR_ULONG write(impl_t* /*impl*/, const void* /*buffer*/, IGR_ULONG /*size*/)
+				{
+					return 0;
+				}
+				static IGR_LONGLONG seek(impl_t* impl, IGR_LONGLONG offset, IGR_ULONG origin)
+				{
+					return impl->seek(offset, static_cast<int>(origin));
+				}
+				static void destroy(impl_t* impl)
+				{
+					delete impl;
+				}
+			};
+
+			if (!m_impl || !m_impl->is_open())
+				return nullptr;
+
+			IGR_Stream* result = nullptr;
+			bridge_stream_t<impl_t, traits>(m_impl.get(), true, &result);
+			m_impl.release(); // NOLINT: ownership passed to the IGR_Stream
+			return result;
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
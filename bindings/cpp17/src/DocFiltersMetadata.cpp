@@ -0,0 +1,221 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <unordered_set>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		namespace
+		{
+			/** Process-wide pool of property names. The strings live in a deque so views of them stay valid as it grows.
+			 *  Nothing is ever removed, since any Metadata still alive may refer to a name. */
+			class name_pool_t
+			{
+			public:
+				std::wstring_view intern(std::wstring_view name)
+				{
+					{
+						std::shared_lock<std::shared_mutex> lock(m_lock);
+						auto it = m_index.find(name);
+						if (it != m_index.end())
+							return *it;
+					}
+
+					std::unique_lock<std::shared_mutex> lock(m_lock);
+					auto it = m_index.find(name);
+					if (it != m_index.end())
+						return *it;
+					m_names.emplace_back(name);
+					return *m_index.insert(m_names.back()).first;
+				}
+
+			private:
+				std::shared_mutex m_lock;
+				std::deque<std::wstring> m_names;
+				std::unordered_set<std::wstring_view> m_index;
+			};
+
+			name_pool_t& name_pool()
+			{
+				static name_pool_t pool;
+				return pool;
+			}
+
+			/** Narrows text that can only be a number or a date; anything outside ASCII cannot be either. */
+			bool to_ascii(const std::wstring& text, std::string& result)
+			{
+				result.clear();
+				for (wchar_t ch : text)
+				{
+					if (ch <= 0 || ch > 0x7F) // NOLINT
+						return false;
+					result.push_back(static_cast<char>(ch));
+				}
+				return true;
+			}
+
+			bool parse_integer(const std::string& text, int64_t& result)
+			{
+				size_t first = text[0] == '-' || text[0] == '+' ? 1 : 0;
+				if (first == text.size() || !std::all_of(text.begin() + static_cast<std::ptrdiff_t>(first), text.end(), [](char ch) { return ch >= '0' && ch <= '9'; }))
+					return false;
+
+				errno = 0;
+				result = std::strtoll(text.c_str(), nullptr, 10); // NOLINT
+				return errno != ERANGE;
+			}
+
+			bool parse_number(const std::string& text, double& result)
+			{
+				// Only plain decimal notation; strtod would also take "inf", "nan" and hex
+				if (!std::all_of(text.begin(), text.end(), [](char ch) { return (ch >= '0' && ch <= '9') || ch == '.' || ch == 'e' || ch == 'E' || ch == '-' || ch == '+'; }))
+					return false;
+
+				errno = 0;
+				char* end = nullptr;
+				result = std::strtod(text.c_str(), &end);
+				return end == text.c_str() + text.size() && errno != ERANGE;
+			}
+
+			bool is_date(const std::string& text)
+			{
+				// The engine reports dates as "Fri, 01 Jan 2021 10:00:00 GMT"
+				if (text.size() < 20 || text[3] != ',') // NOLINT
+					return false;
+				std::tm tm = {};
+				std::istringstream ss(text);
+				ss >> std::get_time(&tm, "%a, %d %b %Y %H:%M:%S");
+				return !ss.fail();
+			}
+		} // namespace
+
+		MetadataValue::MetadataValue(const std::wstring& text)
+			: m_text(text)
+		{
+			std::string ascii;
+			if (text.empty() || !to_ascii(text, ascii))
+				return;
+
+			if (parse_integer(ascii, m_integer))
+			{
+				m_type = Type::Integer;
+				m_number = static_cast<double>(m_integer);
+			}
+			else if (parse_number(ascii, m_number))
+				m_type = Type::Number;
+			else if (is_date(ascii))
+			{
+				m_type = Type::Date;
+				m_date = DateTime(ascii);
+			}
+		}
+
+		std::optional<int64_t> MetadataValue::getInteger() const
+		{
+			if (m_type == Type::Integer)
+				return m_integer;
+			return std::nullopt;
+		}
+
+		std::optional<double> MetadataValue::getNumber() const
+		{
+			if (m_type == Type::Integer || m_type == Type::Number)
+				return m_number;
+			return std::nullopt;
+		}
+
+		std::optional<DateTime> MetadataValue::getDate() const
+		{
+			if (m_type == Type::Date)
+				return m_date;
+			return std::nullopt;
+		}
+
+		Metadata Metadata::Parse(const std::wstring& text)
+		{
+			std::u16string utf16 = w_to_u16(text);
+			return Parse(utf16.data(), utf16.size());
+		}
+
+		Metadata Metadata::Parse(const char16_t* text, size_t length)
+		{
+			// Name1: Value1<#14>Name2: Value2<#14>
+			Metadata result;
+			std::u16string name;
+			std::u16string value;
+			bool in_name = true;
+
+			auto flush = [&]()
+			{
+				if (!name.empty() && !value.empty())
+					result.m_entries.emplace_back(name_pool().intern(u16_to_w(name.data(), name.size())), MetadataValue(u16_to_w(value.data(), value.size())));
+				name.clear();
+				value.clear();
+				in_name = true;
+			};
+
+			for (size_t i = 0; i < length && text[i] != IGR_CHAR_END_META; ++i)
+			{
+				char16_t ch = text[i];
+				if (ch == IGR_CHAR_START_META)
+					continue;
+				if (ch == IGR_CHAR_PARA_BREAK)
+					flush();
+				else if (in_name && ch == u':' && i + 1 < length && text[i + 1] == u' ')
+				{
+					in_name = false;
+					++i;
+				}
+				else
+					(in_name ? name : value).push_back(ch);
+			}
+			flush();
+
+			// The last value of a repeated name wins
+			auto& entries = result.m_entries;
+			std::stable_sort(entries.begin(), entries.end(), [](const entry_t& a, const entry_t& b) { return a.first < b.first; });
+			auto out = entries.begin();
+			for (auto it = entries.begin(); it != entries.end(); ++it)
+			{
+				if (std::next(it) != entries.end() && std::next(it)->first == it->first)
+					continue;
+				if (out != it)
+					*out = std::move(*it);
+				++out;
+			}
+			entries.erase(out, entries.end());
+			return result;
+		}
+
+		const MetadataValue* Metadata::find(std::wstring_view name) const
+		{
+			auto it = std::lower_bound(m_entries.begin(), m_entries.end(), name, [](const entry_t& entry, std::wstring_view key) { return entry.first < key; });
+			return it != m_entries.end() && it->first == name ? &it->second : nullptr;
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
@@ -0,0 +1,158 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		namespace
+		{
+			bool same_name(const std::wstring& a, const std::wstring& b)
+			{
+				return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](wchar_t x, wchar_t y)
+					{
+						return (x >= L'a' && x <= L'z' ? x - 0x20 : x) == (y >= L'a' && y <= L'z' ? y - 0x20 : y); // NOLINT: option names are ASCII
+					});
+			}
+
+			std::wstring trim(const std::wstring& str)
+			{
+				size_t first = str.find_first_not_of(L" \t");
+				if (first == std::wstring::npos)
+					return std::wstring();
+				return str.substr(first, str.find_last_not_of(L" \t") - first + 1);
+			}
+		} // namespace
+
+		OptionSet::OptionSet(std::initializer_list<entry_t> options)
+		{
+			for (auto&& option : options)
+				set(option.first, option.second);
+		}
+
+		OptionSet::OptionSet(const std::wstring& options)
+		{
+			size_t start = 0;
+			while (start <= options.size())
+			{
+				size_t end = std::min(options.find(L';', start), options.size());
+				std::wstring entry = options.substr(start, end - start);
+				start = end + 1;
+
+				if (trim(entry).empty())
+					continue;
+				size_t equals = entry.find(L'=');
+				std::wstring name = trim(entry.substr(0, equals));
+				if (name.empty())
+					throw std::invalid_argument("Option without a name: " + w_to_u8(entry));
+				set(name, equals == std::wstring::npos ? std::wstring() : entry.substr(equals + 1));
+			}
+		}
+
+		std::vector<OptionSet::entry_t>::const_iterator OptionSet::find(const std::wstring& name) const
+		{
+			return std::find_if(m_entries.begin(), m_entries.end(), [&](const entry_t& entry) { return same_name(entry.first, name); });
+		}
+
+		OptionSet& OptionSet::set(const std::wstring& name, const std::wstring& value)
+		{
+			if (name.empty() || name.find_first_of(L"=;") != std::wstring::npos)
+				throw std::invalid_argument("Invalid option name: " + w_to_u8(name));
+			if (value.find(L';') != std::wstring::npos)
+				throw std::invalid_argument("Invalid value for option " + w_to_u8(name));
+
+			auto it = find(name);
+			if (it != m_entries.end())
+				m_entries[static_cast<size_t>(it - m_entries.begin())].second = value;
+			else
+				m_entries.emplace_back(name, value);
+			encode();
+			return *this;
+		}
+
+		OptionSet& OptionSet::erase(const std::wstring& name)
+		{
+			auto it = find(name);
+			if (it != m_entries.end())
+			{
+				m_entries.erase(it);
+				encode();
+			}
+			return *this;
+		}
+
+		OptionSet& OptionSet::merge(const OptionSet& other)
+		{
+			for (auto&& entry : other.m_entries)
+			{
+				auto it = find(entry.first);
+				if (it != m_entries.end())
+					m_entries[static_cast<size_t>(it - m_entries.begin())].second = entry.second;
+				else
+					m_entries.push_back(entry);
+			}
+			encode();
+			return *this;
+		}
+
+		std::optional<std::wstring> OptionSet::get(const std::wstring& name) const
+		{
+			auto it = find(name);
+			if (it == m_entries.end())
+				return std::nullopt;
+			return it->second;
+		}
+
+		std::wstring OptionSet::str() const
+		{
+			std::wstring result;
+			for (auto&& entry : m_entries)
+			{
+				if (!result.empty())
+					result += L';';
+				result.append(entry.first).append(1, L'=').append(entry.second);
+			}
+			return result;
+		}
+
+		void OptionSet::validate(const std::vector<Option>& available) const
+		{
+			for (auto&& entry : m_entries)
+			{
+				if (std::none_of(available.begin(), available.end(), [&](const Option& option) { return same_name(option.getDisplayName(), entry.first); }))
+					throw std::invalid_argument("Unknown option: " + w_to_u8(entry.first));
+			}
+		}
+
+		void OptionSet::validate(const DocumentFilters& api) const
+		{
+			const Registry& registry = api.getRegistry();
+			for (auto&& entry : m_entries)
+			{
+				if (registry.findOption(entry.first) == nullptr)
+					throw std::invalid_argument("Unknown option: " + w_to_u8(entry.first));
+			}
+		}
+
+		void OptionSet::encode()
+		{
+			m_encoded = w_to_u16(str());
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
@@ -14,6 +14,7 @@
 */
 #include "DocumentFiltersObjects.h"
 #include "DocFiltersCommon.h"
+#include <algorithm>
 
 namespace Hyland
 {
@@ -29,9 +30,12 @@ namespace Hyland
 			IGR_LONG m_word_count = 0;
 			std::optional<std::wstring> m_text;
 			std::optional<std::vector<Word>> m_words;
+			std::optional<WordTable> m_word_table;
+			std::optional<WordIndex> m_word_index;
 			Page::words_t m_words_loader;
 			std::shared_ptr<subfile_enumerable_t> m_images;
 			std::optional<PageElement> m_root_page_element;
+			std::optional<PageElementTree> m_element_tree;
 			std::optional<std::vector<FormElement>> m_form_elements;
 			std::optional<std::vector<Hyperlink>> m_hyperlinks;
 			std::optional<std::vector<std::shared_ptr<Annotation>>> m_annotations;
@@ -76,29 +80,87 @@ namespace Hyland
 				}
 				return *m_text;
 			}
+			/** Fetches every word of the page with one call. The text pointers refer to engine memory owned by the page. */
+			std::vector<IGR_Page_Word> fetch_words() const
+			{
+				std::vector<IGR_Page_Word> words(static_cast<size_t>(m_word_count));
+				if (!words.empty())
+				{
+					Error_Control_Block ecb = { 0 };
+					IGR_LONG count = m_word_count;
+					if (IGR_Get_Page_Words(need_handle(), 0, &count, words.data(), &ecb) == IGR_OK)
+						words.resize(std::min(words.size(), static_cast<size_t>(std::max<IGR_LONG>(count, 0))));
+					else
+					{
+						// Fall back to one word at a time, keeping the words read before a failure
+						size_t i = 0;
+						for (IGR_LONG req = 1; i < words.size(); ++i, req = 1)
+						{
+							if (IGR_Get_Page_Words(need_handle(), static_cast<IGR_LONG>(i), &req, &words[i], &ecb) != IGR_OK)
+								break;
+						}
+						words.resize(i);
+					}
+				}
+				return words;
+			}
+
 			const std::vector<Word>& need_words()
 			{
 				if (!m_words.has_value())
 				{
 					auto&& dest = m_words.emplace();
-					dest.reserve(m_word_count);
+					auto words = fetch_words();
+					dest.reserve(words.size());
+					for (size_t i = 0; i < words.size(); ++i)
+						dest.emplace_back(Word(words[i], i));
 
-					Error_Control_Block ecb = { 0 };
-					IGR_Page_Word w = { 0 };
+					m_words_loader = words_t(dest.size(), [&dest](size_t index) -> Word { return dest[index]; });
+				}
+				return *m_words;
+			}
 
-					for (size_t i = 0, c = static_cast<size_t>(m_word_count); i < c; ++i)
+			const WordTable& need_word_table()
+			{
+				if (!m_word_table.has_value())
+				{
+					auto words = fetch_words();
+					auto&& table = m_word_table.emplace();
+
+					size_t text_length = 0;
+					for (auto&& w : words)
+						text_length += static_cast<size_t>(std::max<IGR_LONG>(w.wordLength, 0));
+
+					table.m_x.reserve(words.size());
+					table.m_y.reserve(words.size());
+					table.m_width.reserve(words.size());
+					table.m_height.reserve(words.size());
+					table.m_char_offset.reserve(words.size());
+					table.m_text_offset.reserve(words.size() + 1);
+					table.m_text.reserve(text_length);
+
+					for (auto&& w : words)
 					{
-						IGR_LONG req = 1;
-						if (IGR_Get_Page_Words(m_handle.getHandle(), static_cast<IGR_LONG>(i), &req, &w, &ecb) == IGR_OK)
-							dest.emplace_back(Word(w, i));
-						else
-							break;
+						table.m_x.push_back(w.x);
+						table.m_y.push_back(w.y);
+						table.m_width.push_back(w.width);
+						table.m_height.push_back(w.height);
+						table.m_char_offset.push_back(static_cast<uint32_t>(w.charoffset));
+						if (w.word != nullptr && w.wordLength > 0)
+							table.m_text.append(reinterpret_cast<const char16_t*>(w.word), static_cast<size_t>(w.wordLength));
+						table.m_text_offset.push_back(static_cast<uint32_t>(table.m_text.size()));
 					}
-
-					m_words_loader = words_t(dest.size(), [&dest](size_t index) -> Word { return dest[index]; });
 				}
-				return *m_words;
+				return *m_word_table;
+			}
+
+			const WordIndex& need_word_index()
+			{
+				if (!m_word_index.has_value())
+					m_word_index.emplace(need_word_table());
+				return *m_word_index;
 			}
+
 			const std::vector<FormElement>& need_form_elements()
 			{
 				if (!m_form_elements.has_value())
@@ -234,6 +296,31 @@ namespace Hyland
 			return m_impl->m_words_loader;
 		}
 
+		const WordTable& Page::getWordTable() const
+		{
+			return m_impl->need_word_table();
+		}
+
+		const WordIndex& Page::getWordIndex() const
+		{
+			return m_impl->need_word_index();
+		}
+
+		std::vector<size_t> Page::wordsInRect(const RectI32& rect) const
+		{
+			return m_impl->need_word_index().wordsInRect(rect);
+		}
+
+		std::optional<size_t> Page::nearestWord(int32_t x, int32_t y) const
+		{
+			return m_impl->need_word_index().nearestWord(x, y);
+		}
+
+		std::vector<size_t> Page::nearestWords(int32_t x, int32_t y, size_t count) const
+		{
+			return m_impl->need_word_index().nearestWords(x, y, count);
+		}
+
 		PageElement Page::getRootPageElement() const
 		{
 			if (!m_impl->m_root_page_element.has_value())
@@ -248,6 +335,13 @@ namespace Hyland
 			return *m_impl->m_root_page_element;
 		}
 
+		const PageElementTree& Page::getElementTree() const
+		{
+			if (!m_impl->m_element_tree.has_value())
+				m_impl->m_element_tree.emplace(getRootPageElement());
+			return *m_impl->m_element_tree;
+		}
+
 		const Page::images_t& Page::images() const
 		{
 			if (!m_impl->m_images)
@@ -293,6 +387,11 @@ namespace Hyland
 			Canvas.RenderPage(*this, options, properties);
 		}
 
+		void Page::Render(Canvas& Canvas, const OptionSet& options, const RenderPageProperties& properties) const
+		{
+			Canvas.RenderPage(*this, options, properties);
+		}
+
 		void Page::Render(Canvas& Canvas, const RenderPageProperties& properties) const
 		{
 			Canvas.RenderPage(*this, properties);
@@ -325,7 +424,22 @@ namespace Hyland
 			return getPixels(type, src_rect, IGR_Size{ src_rect.right - src_rect.left, src_rect.bottom - src_rect.top }, options);
 		}
 
+		PagePixels Page::getPixels(PixelType type, const IGR_Rect& src_rect, const OptionSet& options) const
+		{
+			return getPixels(type, src_rect, IGR_Size{ src_rect.right - src_rect.left, src_rect.bottom - src_rect.top }, options);
+		}
+
 		PagePixels Page::getPixels(PixelType type, const IGR_Rect& src_rect, const IGR_Size& dest_size, const std::wstring& options) const
+		{
+			return DoGetPixels(type, src_rect, dest_size, reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str()));
+		}
+
+		PagePixels Page::getPixels(PixelType type, const IGR_Rect& src_rect, const IGR_Size& dest_size, const OptionSet& options) const
+		{
+			return DoGetPixels(type, src_rect, dest_size, options.data());
+		}
+
+		PagePixels Page::DoGetPixels(PixelType type, const IGR_Rect& src_rect, const IGR_Size& dest_size, const IGR_UCS2* options) const
 		{
 			Error_Control_Block ecb = { 0 };
 			IGR_Page_Pixels pixels = { 0 };
@@ -334,7 +448,7 @@ namespace Hyland
 				, &src_rect
 				, &dest_size
 				, 0
-				, reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str())
+				, options
 				, static_cast<IGR_LONG>(type)
 				, &pixels
 				, &ecb), ecb, "IGR_Get_Page_Pixels");
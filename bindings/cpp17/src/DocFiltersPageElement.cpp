@@ -14,6 +14,9 @@
 */
 #include "DocumentFiltersObjects.h"
 #include "DocFiltersCommon.h"
+#include <algorithm>
+#include <exception>
+#include <unordered_map>
 
 namespace Hyland
 {
@@ -186,5 +189,238 @@ namespace Hyland
 		{
 			return children().end();
 		}
+
+		/** Fills a PageElementTree, in document order, from the elements of a page. */
+		class PageElementTree::builder_t
+		{
+		public:
+			builder_t(PageElementTree& tree, IGR_HPAGE page)
+				: m_tree(tree), m_page(page)
+			{
+			}
+
+			void build(const IGR_Page_Element& root)
+			{
+				if (!enumerate(root))
+				{
+					// Not every document type can enumerate; read the children of each element in batches instead
+					m_tree = PageElementTree();
+					m_last_child.clear();
+					m_string_ids.clear();
+					walk(root);
+				}
+			}
+
+		private:
+			/** Deeper than any page element tree, so the enumeration is never cut short. */
+			static constexpr IGR_ULONG max_depth = 1024;
+			static constexpr size_t batch_size = 64;
+
+			PageElementTree& m_tree;
+			IGR_HPAGE m_page;
+			const void* m_root = nullptr;
+			std::vector<uint32_t> m_last_child;
+			std::vector<std::pair<uint32_t, IGR_ULONG>> m_open;
+			std::unordered_map<std::u16string, uint32_t> m_string_ids;
+			std::vector<IGR_UCS2> m_buffer;
+			std::exception_ptr m_error;
+
+			static uint32_t to_offset(size_t value)
+			{
+				if (value >= npos)
+					throw std::length_error("page element tree is too large");
+				return static_cast<uint32_t>(value);
+			}
+
+			bool enumerate(const IGR_Page_Element& root)
+			{
+				m_root = root.reserved;
+				m_open.assign(1, std::make_pair(add(root, npos), root.depth));
+
+				IGR_PAGE_ELEMENT_CALLBACK cb = [](IGR_HPAGE, const IGR_Page_Element* item, void* context) -> IGR_LONG {
+					auto& self = *reinterpret_cast<builder_t*>(context);
+					try
+					{
+						self.on_element(*item);
+						return IGR_OK;
+					}
+					catch (...)
+					{
+						self.m_error = std::current_exception();
+						return IGR_E_ERROR;
+					}
+				};
+
+				Error_Control_Block ecb = { 0 };
+				IGR_RETURN_CODE rc = IGR_Enum_Page_Elements(m_page, &root, 0, max_depth, cb, this, &ecb);
+				if (m_error)
+					std::rethrow_exception(m_error);
+				return rc == IGR_OK;
+			}
+
+			void on_element(const IGR_Page_Element& element)
+			{
+				if (element.reserved == nullptr || element.reserved == m_root)
+					return;
+
+				// Elements arrive depth first; the parent is the nearest open element above this depth
+				while (m_open.size() > 1 && m_open.back().second >= element.depth)
+					m_open.pop_back();
+				m_open.emplace_back(add(element, m_open.back().first), element.depth);
+			}
+
+			void walk(const IGR_Page_Element& root)
+			{
+				std::vector<std::pair<IGR_Page_Element, uint32_t>> pending{ { root, npos } };
+				std::vector<IGR_Page_Element> children;
+				while (!pending.empty())
+				{
+					auto item = pending.back();
+					pending.pop_back();
+
+					uint32_t index = add(item.first, item.second);
+					fetch_children(item.first, children);
+					for (auto it = children.rbegin(); it != children.rend(); ++it)
+						pending.emplace_back(*it, index);
+				}
+			}
+
+			void fetch_children(const IGR_Page_Element& parent, std::vector<IGR_Page_Element>& children)
+			{
+				children.clear();
+				IGR_Page_Element batch[batch_size];
+				for (IGR_ULONG first = 0;;)
+				{
+					for (auto& element : batch)
+						element = IGR_Page_Element{ sizeof(IGR_Page_Element) };
+
+					Error_Control_Block ecb = { 0 };
+					IGR_ULONG count = batch_size;
+					IGR_RETURN_CODE rc = IGR_Get_Page_Elements(m_page, &parent, first, &count, batch, &ecb);
+					if (rc == IGR_NO_MORE)
+						break;
+					throw_on_error(rc, ecb, "IGR_Get_Page_Elements");
+
+					count = std::min<IGR_ULONG>(count, batch_size);
+					for (IGR_ULONG i = 0; i < count; ++i)
+					{
+						if (batch[i].reserved != nullptr)
+							children.push_back(batch[i]);
+					}
+					if (count < batch_size)
+						break;
+					first += count;
+				}
+			}
+
+			uint32_t add(const IGR_Page_Element& element, uint32_t parent)
+			{
+				auto& t = m_tree;
+				const uint32_t index = to_offset(t.m_type.size());
+				t.m_type.push_back(static_cast<PageElementType>(element.type));
+				t.m_flags.push_back(element.flags);
+				t.m_depth.push_back(element.depth);
+				t.m_rotation.push_back(element.rotation);
+				t.m_bounds.push_back(element.pos);
+				t.m_parent.push_back(parent);
+				t.m_first_child.push_back(npos);
+				t.m_next_sibling.push_back(npos);
+				m_last_child.push_back(npos);
+				if (parent != npos)
+				{
+					if (m_last_child[parent] == npos)
+						t.m_first_child[parent] = index;
+					else
+						t.m_next_sibling[m_last_child[parent]] = index;
+					m_last_child[parent] = index;
+				}
+
+				add_text(element);
+				add_styles(element);
+				return index;
+			}
+
+			void add_text(const IGR_Page_Element& element)
+			{
+				Error_Control_Block ecb = { 0 };
+				IGR_ULONG length = 0;
+				throw_on_error(IGR_Get_Page_Element_Text(m_page, &element, &length, nullptr, &ecb), ecb, "IGR_Get_Page_Element_Text");
+				if (length > 0)
+				{
+					m_buffer.resize(static_cast<size_t>(length) + 1);
+					IGR_ULONG filled = static_cast<IGR_ULONG>(m_buffer.size());
+					throw_on_error(IGR_Get_Page_Element_Text(m_page, &element, &filled, m_buffer.data(), &ecb), ecb, "IGR_Get_Page_Element_Text");
+					auto end = m_buffer.begin() + std::min<size_t>(filled, m_buffer.size());
+					end = std::find(m_buffer.begin(), end, 0);
+					m_tree.m_text.append(reinterpret_cast<const char16_t*>(m_buffer.data()), static_cast<size_t>(end - m_buffer.begin()));
+				}
+				m_tree.m_text_start.push_back(to_offset(m_tree.m_text.size()));
+			}
+
+			void add_styles(const IGR_Page_Element& element)
+			{
+				IGR_PAGE_ELEMENT_STYLES_CALLBACK cb = [](const IGR_UCS2* name, const IGR_UCS2* value, void* context) -> IGR_LONG {
+					auto& self = *reinterpret_cast<builder_t*>(context);
+					try
+					{
+						self.m_tree.m_styles.emplace_back(self.intern(name), self.intern(value));
+						return IGR_OK;
+					}
+					catch (...)
+					{
+						self.m_error = std::current_exception();
+						return IGR_E_ERROR;
+					}
+				};
+
+				Error_Control_Block ecb = { 0 };
+				IGR_RETURN_CODE rc = IGR_Get_Page_Element_Styles(m_page, &element, cb, this, &ecb);
+				if (m_error)
+					std::rethrow_exception(m_error);
+				throw_on_error(rc, ecb, "IGR_Get_Page_Element_Styles");
+				m_tree.m_style_start.push_back(to_offset(m_tree.m_styles.size()));
+			}
+
+			/** Returns the id of a style name or value, storing it the first time it is seen. */
+			uint32_t intern(const IGR_UCS2* str)
+			{
+				std::u16string key = str != nullptr ? std::u16string(reinterpret_cast<const char16_t*>(str)) : std::u16string();
+				auto found = m_string_ids.find(key);
+				if (found != m_string_ids.end())
+					return found->second;
+
+				const uint32_t id = to_offset(m_tree.m_string_start.size() - 1);
+				m_tree.m_strings += key;
+				m_tree.m_string_start.push_back(to_offset(m_tree.m_strings.size()));
+				m_string_ids.emplace(std::move(key), id);
+				return id;
+			}
+		};
+
+		PageElementTree::PageElementTree(const PageElement& root)
+		{
+			if (!root.ok())
+				return;
+
+			builder_t builder(*this, root.m_impl->m_page);
+			builder.build(root.m_impl->m_element);
+		}
+
+		std::pair<std::u16string_view, std::u16string_view> PageElementTree::Node::getStyleAt(size_t index) const
+		{
+			auto&& style = m_tree->m_styles[m_tree->m_style_start[m_index] + index];
+			return std::make_pair(m_tree->DoString(style.first), m_tree->DoString(style.second));
+		}
+
+		std::optional<std::u16string_view> PageElementTree::Node::getStyle(std::u16string_view name) const
+		{
+			for (uint32_t i = m_tree->m_style_start[m_index]; i < m_tree->m_style_start[m_index + 1]; ++i)
+			{
+				auto&& style = m_tree->m_styles[i];
+				if (m_tree->DoString(style.first) == name)
+					return m_tree->DoString(style.second);
+			}
+			return std::nullopt;
+		}
 	} // namespace DocFilters
 } // namespace Hyland
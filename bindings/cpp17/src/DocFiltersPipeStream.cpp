@@ -0,0 +1,298 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		class PipeStream::impl_t
+		{
+		public:
+			// Ring buffer shared by both threads. m_head and m_tail are running byte counts, so the ring is
+			// empty when they are equal and full when they differ by the capacity. The writer only advances
+			// m_tail and the reader only advances m_head.
+			std::unique_ptr<uint8_t[]> m_ring;
+			size_t m_capacity;
+			size_t m_mask;
+			std::atomic<uint64_t> m_head{ 0 };
+			std::atomic<uint64_t> m_tail{ 0 };
+			std::atomic<bool> m_finished{ false };
+			std::atomic<bool> m_cancelled{ false };
+			std::atomic<bool> m_broken{ false };
+
+			// Only used to sleep when one side has to wait for the other; the data path does not lock.
+			std::mutex m_wait_lock;
+			std::condition_variable m_wait;
+			std::atomic<bool> m_writer_waiting{ false };
+			std::atomic<bool> m_reader_waiting{ false };
+			std::atomic<uint64_t> m_stalls{ 0 };
+
+			// Writer side only
+			size_t m_rewrite_window;
+			std::vector<uint8_t> m_window; // bytes [m_tail, m_tail + m_window.size()) not yet published
+			uint64_t m_position = 0;
+
+			explicit impl_t(const Options& options)
+				: m_rewrite_window(options.rewrite_window)
+			{
+				m_capacity = 4096;
+				while (m_capacity < options.capacity && m_capacity < (size_t(1) << (sizeof(size_t) * 8 - 2)))
+					m_capacity <<= 1;
+				m_mask = m_capacity - 1;
+				m_ring.reset(new uint8_t[m_capacity]);
+			}
+
+			uint64_t published() const
+			{
+				return m_tail.load();
+			}
+
+			uint64_t size() const
+			{
+				return published() + m_window.size();
+			}
+
+			void wake(std::atomic<bool>& waiting)
+			{
+				if (waiting.load())
+				{
+					std::lock_guard<std::mutex> lock(m_wait_lock);
+					m_wait.notify_all();
+				}
+			}
+
+			template <typename Pred>
+			void wait(std::atomic<bool>& waiting, Pred pred)
+			{
+				std::unique_lock<std::mutex> lock(m_wait_lock);
+				waiting.store(true);
+				m_wait.wait(lock, pred);
+				waiting.store(false);
+			}
+
+			bool publish(const uint8_t* data, size_t size)
+			{
+				while (size != 0)
+				{
+					uint64_t tail = m_tail.load(std::memory_order_relaxed);
+					size_t space = m_capacity - static_cast<size_t>(tail - m_head.load());
+					if (space == 0)
+					{
+						++m_stalls;
+						wait(m_writer_waiting, [&]() { return m_cancelled.load() || m_head.load() != tail - m_capacity; });
+						if (m_cancelled.load())
+							return false;
+						continue;
+					}
+
+					size_t bytes = std::min(space, size);
+					size_t start = static_cast<size_t>(tail) & m_mask;
+					size_t first = std::min(bytes, m_capacity - start);
+					memcpy(m_ring.get() + start, data, first);
+					memcpy(m_ring.get(), data + first, bytes - first);
+					m_tail.store(tail + bytes);
+					wake(m_reader_waiting);
+
+					data += bytes;
+					size -= bytes;
+				}
+				return true;
+			}
+
+			bool publish_window(size_t keep)
+			{
+				if (m_window.size() <= keep)
+					return true;
+
+				size_t bytes = m_window.size() - keep;
+				if (!publish(m_window.data(), bytes))
+					return false;
+				m_window.erase(m_window.begin(), m_window.begin() + static_cast<std::ptrdiff_t>(bytes));
+				return true;
+			}
+
+			size_t write(const void* buffer, size_t size)
+			{
+				if (m_cancelled.load() || m_finished.load() || m_broken.load())
+					return 0;
+
+				uint64_t base = published();
+				size_t offset = static_cast<size_t>(m_position - base);
+				if (m_window.size() < offset + size)
+					m_window.resize(offset + size);
+				memcpy(m_window.data() + offset, buffer, size);
+				m_position += size;
+
+				// Publish in batches so trimming the window is amortised over at least rewrite_window bytes
+				if (m_window.size() > m_rewrite_window && m_window.size() - m_rewrite_window >= std::max<size_t>(m_rewrite_window, 1))
+				{
+					if (!publish_window(m_rewrite_window))
+						return 0;
+				}
+				return size;
+			}
+
+			size_t read(void* buffer, size_t size)
+			{
+				uint64_t base = published();
+				if (m_position < base || m_position >= base + m_window.size())
+					return 0;
+
+				size_t offset = static_cast<size_t>(m_position - base);
+				size_t bytes = std::min(size, m_window.size() - offset);
+				memcpy(buffer, m_window.data() + offset, bytes);
+				m_position += bytes;
+				return bytes;
+			}
+
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way)
+			{
+				int64_t base = 0;
+				switch (way)
+				{
+				case std::ios::beg:
+					base = 0;
+					break;
+				case std::ios::cur:
+					base = static_cast<int64_t>(m_position);
+					break;
+				case std::ios::end:
+					base = static_cast<int64_t>(size());
+					break;
+				default:
+					throw std::runtime_error("Not implemented");
+				}
+
+				int64_t target = base + static_cast<int64_t>(offset);
+				if (target < static_cast<int64_t>(published()))
+				{
+					// The bytes may already have been sent, so they can no longer be patched
+					if (target >= 0)
+					{
+						m_broken.store(true);
+						wake(m_reader_waiting);
+					}
+					return -1;
+				}
+				m_position = static_cast<uint64_t>(target);
+				return target;
+			}
+
+			void finish()
+			{
+				if (m_finished.load())
+					return;
+				if (!m_broken.load())
+					publish_window(0);
+				m_finished.store(true);
+				wake(m_reader_waiting);
+			}
+
+			size_t consume(void* buffer, size_t size)
+			{
+				auto dest = static_cast<uint8_t*>(buffer);
+				uint64_t head = m_head.load(std::memory_order_relaxed);
+				for (;;)
+				{
+					if (m_broken.load())
+						throw std::runtime_error("The output was rewritten after it may have been consumed; increase PipeStreamOptions::rewrite_window");
+
+					uint64_t tail = m_tail.load();
+					if (tail != head)
+					{
+						size_t bytes = static_cast<size_t>(std::min<uint64_t>(size, tail - head));
+						size_t start = static_cast<size_t>(head) & m_mask;
+						size_t first = std::min(bytes, m_capacity - start);
+						memcpy(dest, m_ring.get() + start, first);
+						memcpy(dest + first, m_ring.get(), bytes - first);
+						m_head.store(head + bytes);
+						wake(m_writer_waiting);
+						return bytes;
+					}
+
+					if (size == 0 || m_cancelled.load())
+						return 0;
+					// Check the tail again after seeing the finished flag, the last bytes may have been published just before it
+					if (m_finished.load() && m_tail.load() == head)
+						return 0;
+
+					wait(m_reader_waiting, [&]() { return m_tail.load() != head || m_finished.load() || m_cancelled.load() || m_broken.load(); });
+				}
+			}
+
+			void cancel()
+			{
+				m_cancelled.store(true);
+				std::lock_guard<std::mutex> lock(m_wait_lock);
+				m_wait.notify_all();
+			}
+		};
+
+		PipeStream::PipeStream(const Options& options)
+			: m_impl(std::make_unique<impl_t>(options))
+		{
+		}
+
+		PipeStream::~PipeStream() = default;
+
+		std::streamoff PipeStream::seek(std::streampos offset, std::ios_base::seekdir way)
+		{
+			return m_impl->seek(offset, way);
+		}
+
+		size_t PipeStream::read(void* buffer, size_t size)
+		{
+			return m_impl->read(buffer, size);
+		}
+
+		size_t PipeStream::write(const void* buffer, size_t size)
+		{
+			return m_impl->write(buffer, size);
+		}
+
+		void PipeStream::finish()
+		{
+			m_impl->finish();
+		}
+
+		size_t PipeStream::consume(void* buffer, size_t size)
+		{
+			return m_impl->consume(buffer, size);
+		}
+
+		void PipeStream::cancel()
+		{
+			m_impl->cancel();
+		}
+
+		uint64_t PipeStream::getPublishedBytes() const
+		{
+			return m_impl->published();
+		}
+
+		uint64_t PipeStream::getWriterStalls() const
+		{
+			return m_impl->m_stalls.load();
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
@@ -0,0 +1,382 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		class PrefetchStream::impl_t
+		{
+		public:
+			using clock_t = std::chrono::steady_clock;
+
+			struct block_t
+			{
+				std::vector<uint8_t> data;
+				size_t length = 0;
+				bool used = false;
+				std::chrono::nanoseconds fetch_time{};
+			};
+
+			Stream* m_inner = nullptr;
+			bool m_own = false;
+			Options m_options;
+
+			// Guards everything below, except the wrapped stream itself
+			mutable std::mutex m_lock;
+			std::condition_variable m_io_ready;
+			std::condition_variable m_block_ready;
+			Stats m_stats;
+			std::map<uint64_t, block_t> m_blocks;
+			std::vector<std::vector<uint8_t>> m_free;
+			std::deque<uint64_t> m_queue;
+			int64_t m_inflight = -1;
+			uint64_t m_window = 0;
+			uint64_t m_eof_block = UINT64_MAX;
+			bool m_stop = false;
+
+			// Only touched by the reading thread
+			uint64_t m_offset = 0;
+			int64_t m_last_block = -1;
+			size_t m_streak = 0;
+
+			// Guards the wrapped stream, which both threads read from
+			std::mutex m_backend_lock;
+			int64_t m_inner_pos = -1;
+
+			std::thread m_thread;
+
+			impl_t(Stream* inner, bool own, const Options& options)
+				: m_inner(inner), m_own(own), m_options(options)
+			{
+				if (m_inner == nullptr)
+					throw std::invalid_argument("stream cannot be null");
+				if (m_options.block_size == 0 || m_options.depth == 0)
+					throw std::invalid_argument("block_size and depth must be greater than 0");
+
+				m_thread = std::thread([this] { io_thread(); });
+			}
+
+			~impl_t()
+			{
+				close();
+				if (m_own)
+					delete m_inner;
+			}
+
+			void close()
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_lock);
+					m_stop = true;
+					m_queue.clear();
+					for (auto&& entry : m_blocks)
+						if (!entry.second.used)
+							++m_stats.wasted_blocks;
+					m_blocks.clear();
+					m_free.clear();
+				}
+				m_io_ready.notify_all();
+				m_block_ready.notify_all();
+				if (m_thread.joinable())
+					m_thread.join();
+			}
+
+			size_t backend_read(uint64_t offset, uint8_t* dest, size_t size)
+			{
+				std::lock_guard<std::mutex> lock(m_backend_lock);
+				if (m_inner_pos != static_cast<int64_t>(offset))
+				{
+					m_inner_pos = m_inner->seek(static_cast<std::streamoff>(offset), std::ios::beg);
+					if (m_inner_pos != static_cast<int64_t>(offset))
+					{
+						m_inner_pos = -1;
+						return 0;
+					}
+				}
+
+				size_t total = 0;
+				while (total < size)
+				{
+					size_t got = m_inner->read(dest + total, size - total);
+					if (got == 0)
+						break;
+					total += got;
+				}
+				m_inner_pos += static_cast<int64_t>(total);
+				return total;
+			}
+
+			int64_t backend_size()
+			{
+				std::lock_guard<std::mutex> lock(m_backend_lock);
+				m_inner_pos = m_inner->seek(0, std::ios::end);
+				return m_inner_pos;
+			}
+
+			std::vector<uint8_t> take_buffer()
+			{
+				if (m_free.empty())
+					return std::vector<uint8_t>(m_options.block_size);
+				auto result = std::move(m_free.back());
+				m_free.pop_back();
+				return result;
+			}
+
+			bool in_window(uint64_t index) const
+			{
+				return index >= m_window && index <= m_window + m_options.depth;
+			}
+
+			void io_thread()
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				for (;;)
+				{
+					m_io_ready.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+					if (m_stop)
+						break;
+
+					uint64_t index = m_queue.front();
+					m_queue.pop_front();
+					if (!in_window(index) || m_blocks.count(index) != 0 || index > m_eof_block)
+						continue;
+
+					m_inflight = static_cast<int64_t>(index);
+					auto buffer = take_buffer();
+					lock.unlock();
+
+					auto start = clock_t::now();
+					size_t length = backend_read(index * m_options.block_size, buffer.data(), m_options.block_size);
+					auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start);
+
+					lock.lock();
+					m_inflight = -1;
+					++m_stats.prefetched_blocks;
+					m_stats.io_time += elapsed;
+					if (length < m_options.block_size)
+						m_eof_block = std::min(m_eof_block, index);
+
+					if (!m_stop && in_window(index))
+					{
+						auto& block = m_blocks[index];
+						block.data = std::move(buffer);
+						block.length = length;
+						block.fetch_time = elapsed;
+					}
+					else
+					{
+						++m_stats.wasted_blocks;
+						m_free.push_back(std::move(buffer));
+					}
+					m_block_ready.notify_all();
+				}
+			}
+
+			// Slides the window to start at index, drops blocks outside of it and queues the next ones.
+			void schedule(uint64_t index)
+			{
+				m_window = index;
+				for (auto it = m_blocks.begin(); it != m_blocks.end();)
+				{
+					if (in_window(it->first))
+						++it;
+					else
+					{
+						if (!it->second.used)
+							++m_stats.wasted_blocks;
+						m_free.push_back(std::move(it->second.data));
+						it = m_blocks.erase(it);
+					}
+				}
+				m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), [this](uint64_t i) { return !in_window(i); }), m_queue.end());
+
+				for (uint64_t next = index + 1; next <= index + m_options.depth && next <= m_eof_block; ++next)
+				{
+					if (m_blocks.count(next) == 0 && m_inflight != static_cast<int64_t>(next)
+						&& std::find(m_queue.begin(), m_queue.end(), next) == m_queue.end())
+						m_queue.push_back(next);
+				}
+				if (!m_queue.empty())
+					m_io_ready.notify_one();
+			}
+
+			void track_access(uint64_t index)
+			{
+				if (static_cast<int64_t>(index) == m_last_block)
+					return;
+				bool forward = static_cast<int64_t>(index) == m_last_block + 1 || (m_last_block < 0 && index == 0);
+				m_streak = forward ? m_streak + 1 : 0;
+				m_last_block = static_cast<int64_t>(index);
+			}
+
+			size_t read(void* buffer, size_t size)
+			{
+				auto dest = static_cast<uint8_t*>(buffer);
+				const size_t bs = m_options.block_size;
+				size_t total = 0;
+
+				std::unique_lock<std::mutex> lock(m_lock);
+				while (total < size && !m_stop)
+				{
+					uint64_t index = m_offset / bs;
+					size_t offset_in_block = static_cast<size_t>(m_offset % bs);
+					track_access(index);
+
+					auto found = m_blocks.find(index);
+					if (found == m_blocks.end() && m_inflight == static_cast<int64_t>(index))
+					{
+						// The I/O thread is already fetching this block, wait for it
+						auto start = clock_t::now();
+						m_block_ready.wait(lock, [&] { return m_stop || m_inflight != static_cast<int64_t>(index); });
+						m_stats.stall_time += std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start);
+						++m_stats.prefetch_waits;
+						found = m_blocks.find(index);
+						if (found != m_blocks.end())
+							found->second.used = true;
+					}
+					else if (found != m_blocks.end() && !found->second.used)
+					{
+						++m_stats.prefetch_hits;
+						m_stats.overlapped_time += found->second.fetch_time;
+						found->second.used = true;
+					}
+
+					if (found == m_blocks.end())
+					{
+						if (m_streak == 0)
+						{
+							// Not a forward scan, read exactly what was asked for
+							lock.unlock();
+							auto start = clock_t::now();
+							size_t got = backend_read(m_offset, dest + total, size - total);
+							auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start);
+							lock.lock();
+							++m_stats.demand_reads;
+							m_stats.stall_time += elapsed;
+							m_offset += got;
+							total += got;
+							break;
+						}
+
+						// Forward scan without a prefetched block, fetch it here and start the pipeline
+						m_queue.erase(std::remove(m_queue.begin(), m_queue.end(), index), m_queue.end());
+						auto data = take_buffer();
+						lock.unlock();
+						auto start = clock_t::now();
+						size_t length = backend_read(index * bs, data.data(), bs);
+						auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start);
+						lock.lock();
+						++m_stats.demand_reads;
+						m_stats.stall_time += elapsed;
+						if (m_stop)
+							break;
+						if (length < bs)
+							m_eof_block = std::min(m_eof_block, index);
+
+						auto& block = m_blocks[index];
+						block.data = std::move(data);
+						block.length = length;
+						block.used = true;
+						found = m_blocks.find(index);
+					}
+
+					if (m_streak > 0)
+						schedule(index);
+
+					const block_t& block = found->second;
+					if (offset_in_block >= block.length)
+						break;
+
+					size_t n = std::min(size - total, block.length - offset_in_block);
+					std::memcpy(dest + total, block.data.data() + offset_in_block, n);
+					total += n;
+					m_offset += n;
+
+					if (block.length < bs && offset_in_block + n >= block.length)
+						break;
+				}
+				return total;
+			}
+
+			int64_t seek(int64_t offset, int origin)
+			{
+				int64_t base = 0;
+				switch (origin)
+				{
+				case std::ios::beg:
+					base = 0;
+					break;
+				case std::ios::cur:
+					base = static_cast<int64_t>(m_offset);
+					break;
+				case std::ios::end:
+					base = backend_size();
+					break;
+				default:
+					return -1;
+				}
+				if (base < 0 || base + offset < 0)
+					return -1;
+				m_offset = static_cast<uint64_t>(base + offset);
+				return static_cast<int64_t>(m_offset);
+			}
+		};
+
+		PrefetchStream::PrefetchStream(Stream* stream, bool own_stream, const Options& options)
+			: m_impl(std::make_unique<impl_t>(stream, own_stream, options))
+		{
+		}
+
+		PrefetchStream::~PrefetchStream() = default;
+
+		std::streamoff PrefetchStream::seek(std::streampos offset, std::ios_base::seekdir way)
+		{
+			return m_impl->seek(static_cast<int64_t>(offset), static_cast<int>(way));
+		}
+
+		size_t PrefetchStream::read(void* buffer, size_t size)
+		{
+			return m_impl->read(buffer, size);
+		}
+
+		std::unique_ptr<Stream> PrefetchStream::get_stream_part(const std::wstring& part_name, const std::wstring& full_name, int index)
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_backend_lock);
+			return m_impl->m_inner->get_stream_part(part_name, full_name, index);
+		}
+
+		PrefetchStream::Stats PrefetchStream::getStats() const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			return m_impl->m_stats;
+		}
+
+		void PrefetchStream::close()
+		{
+			m_impl->close();
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
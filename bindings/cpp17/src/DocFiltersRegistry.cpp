@@ -0,0 +1,442 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		namespace
+		{
+			const char cache_magic[4] = { 'D', 'F', 'R', 'C' };
+			const uint32_t cache_version = 1;
+			const uint32_t max_formats = 0xffff;
+			const uint32_t max_options = 0xffff;
+
+			/** Folds ASCII letters to upper case; names, short names and MIME types are ASCII. */
+			template <typename S>
+			S fold(S str)
+			{
+				for (auto& ch : str)
+				{
+					if (ch >= 'a' && ch <= 'z')
+						ch = static_cast<typename S::value_type>(ch - 0x20); // NOLINT
+				}
+				return str;
+			}
+
+			void write_u32(std::ostream& stream, uint32_t value)
+			{
+				stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+			}
+
+			void write_string(std::ostream& stream, const std::wstring& value)
+			{
+				std::string utf8 = w_to_u8(value);
+				write_u32(stream, static_cast<uint32_t>(utf8.size()));
+				stream.write(utf8.data(), static_cast<std::streamsize>(utf8.size()));
+			}
+
+			bool read_u32(std::istream& stream, uint32_t& value)
+			{
+				return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+			}
+
+			bool read_string(std::istream& stream, std::string& value)
+			{
+				uint32_t size = 0;
+				if (!read_u32(stream, size) || size > 0x10000) // NOLINT: attribute buffers are 4K
+					return false;
+				value.resize(size);
+				return size == 0 || static_cast<bool>(stream.read(&value[0], size));
+			}
+
+			bool read_string(std::istream& stream, std::wstring& value)
+			{
+				std::string utf8;
+				if (!read_string(stream, utf8))
+					return false;
+				value = u8_to_w(utf8.c_str(), utf8.size());
+				return true;
+			}
+		} // namespace
+
+		class Registry::impl_t
+		{
+		public:
+			// The registry of the most recently initialized DocumentFilters, which Extractor looks formats up in
+			inline static std::mutex s_attached_lock;
+			inline static std::weak_ptr<impl_t> s_attached;
+
+			std::mutex m_lock;
+			bool m_attached = false;
+			std::string m_version;
+
+			std::unordered_map<uint32_t, std::optional<Format>> m_probed;
+			std::optional<std::vector<Format>> m_formats;
+			std::unordered_map<uint32_t, size_t> m_by_id;
+			std::unordered_map<std::wstring, size_t> m_by_short_name;
+			std::unordered_map<std::wstring, size_t> m_by_mime_type;
+
+			std::optional<std::vector<Option>> m_options;
+			std::unordered_map<std::wstring, size_t> m_by_option_name;
+
+			void ensure_attached() const
+			{
+				if (!m_attached)
+					throw DocumentFilters::Error("Document filters not initialized");
+			}
+
+			const Format* probe(uint32_t id)
+			{
+				auto it = m_probed.find(id);
+				if (it == m_probed.end())
+				{
+					ensure_attached();
+					Format format(id);
+					it = m_probed.emplace(id, format.id() == id ? std::optional<Format>(std::move(format)) : std::nullopt).first;
+				}
+				return it->second.has_value() ? &*it->second : nullptr;
+			}
+
+			const Format* find_format(uint32_t id)
+			{
+				if (m_formats.has_value())
+				{
+					auto it = m_by_id.find(id);
+					return it != m_by_id.end() ? &(*m_formats)[it->second] : nullptr;
+				}
+				return probe(id);
+			}
+
+			const std::vector<Format>& need_formats()
+			{
+				if (!m_formats.has_value())
+				{
+					ensure_attached();
+
+					// IDs findFormat has not asked for are probed without being remembered; once the table is built,
+					// only the formats findFormat has already handed out are kept, so those pointers stay valid
+					std::vector<Format> formats;
+					for (uint32_t i = 1; i < max_formats; ++i)
+					{
+						auto it = m_probed.find(i);
+						if (it != m_probed.end())
+						{
+							if (it->second.has_value())
+								formats.push_back(*it->second);
+							continue;
+						}
+						Format format(i);
+						if (format.id() == i)
+							formats.push_back(std::move(format));
+					}
+					set_formats(std::move(formats));
+
+					for (auto it = m_probed.begin(); it != m_probed.end();)
+						it = it->second.has_value() ? std::next(it) : m_probed.erase(it);
+				}
+				return *m_formats;
+			}
+
+			const std::vector<Option>& need_options()
+			{
+				if (!m_options.has_value())
+				{
+					ensure_attached();
+
+					std::vector<Option> options;
+					for (uint32_t i = 0; i < max_options; ++i)
+					{
+						Option option(i);
+						if (option.getDisplayName().empty())
+							break;
+						options.push_back(std::move(option));
+					}
+					set_options(std::move(options));
+				}
+				return *m_options;
+			}
+
+			void set_formats(std::vector<Format> formats)
+			{
+				m_formats = std::move(formats);
+				m_by_id.clear();
+				m_by_short_name.clear();
+				m_by_mime_type.clear();
+				for (size_t i = 0; i < m_formats->size(); ++i)
+				{
+					const Format& format = (*m_formats)[i];
+					m_by_id.emplace(format.id(), i);
+					if (!format.getShortName().empty())
+						m_by_short_name.emplace(fold(format.getShortName()), i);
+					if (!format.getMimeType().empty())
+						m_by_mime_type.emplace(fold(format.getMimeType()), i);
+				}
+			}
+
+			void set_options(std::vector<Option> options)
+			{
+				m_options = std::move(options);
+				m_by_option_name.clear();
+				for (size_t i = 0; i < m_options->size(); ++i)
+					m_by_option_name.emplace(fold((*m_options)[i].getDisplayName()), i);
+			}
+
+			template <typename T>
+			static const T* find(const std::vector<T>& items, const std::unordered_map<std::wstring, size_t>& index, const std::wstring& key)
+			{
+				auto it = index.find(fold(key));
+				return it != index.end() ? &items[it->second] : nullptr;
+			}
+		};
+
+		Registry::Registry()
+			: m_impl(std::make_shared<impl_t>())
+		{
+		}
+
+		void Registry::DoAttach(const std::string& engine_version)
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			m_impl->m_attached = true;
+			m_impl->m_version = engine_version;
+
+			std::lock_guard<std::mutex> attached_lock(impl_t::s_attached_lock);
+			impl_t::s_attached = m_impl;
+		}
+
+		bool Registry::DoFetchAttached(uint32_t id, Format::What what, std::wstring& result)
+		{
+			std::shared_ptr<impl_t> impl;
+			{
+				std::lock_guard<std::mutex> lock(impl_t::s_attached_lock);
+				impl = impl_t::s_attached.lock();
+			}
+			if (!impl)
+				return false;
+
+			// Copied under the lock, as LoadFrom may replace the table once it is released
+			std::lock_guard<std::mutex> lock(impl->m_lock);
+			const Format* format = impl->find_format(id);
+			if (format == nullptr)
+				return false;
+
+			switch (what)
+			{
+			case Format::What::LongName:
+				result = format->getDisplayName();
+				return true;
+			case Format::What::ShortName:
+				result = format->getShortName();
+				return true;
+			case Format::What::ConfigName:
+				result = format->getConfigName();
+				return true;
+			case Format::What::MimeType:
+				result = format->getMimeType();
+				return true;
+			case Format::What::FileCategory:
+				result = std::to_wstring(format->getFileTypeCategory());
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		const std::string& Registry::getEngineVersion() const
+		{
+			return m_impl->m_version;
+		}
+
+		const std::vector<Format>& Registry::getFormats() const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			return m_impl->need_formats();
+		}
+
+		const std::vector<Option>& Registry::getOptions() const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			return m_impl->need_options();
+		}
+
+		const Format* Registry::findFormat(uint32_t id) const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			return m_impl->find_format(id);
+		}
+
+		const Format* Registry::findFormatByShortName(const std::wstring& short_name) const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			return impl_t::find(m_impl->need_formats(), m_impl->m_by_short_name, short_name);
+		}
+
+		const Format* Registry::findFormatByMimeType(const std::wstring& mime_type) const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			return impl_t::find(m_impl->need_formats(), m_impl->m_by_mime_type, mime_type);
+		}
+
+		const Option* Registry::findOption(const std::wstring& name) const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			return impl_t::find(m_impl->need_options(), m_impl->m_by_option_name, name);
+		}
+
+		std::optional<CanvasType> Registry::findCanvasType(const std::string& extension)
+		{
+			static const std::unordered_map<std::string, CanvasType> canvas_types = {
+				{ "BMP", CanvasType::BMP }, { "BRK", CanvasType::BRK }, { "DCX", CanvasType::DCX },
+				{ "EPS", CanvasType::EPS }, { "GIF", CanvasType::GIF }, { "HTM", CanvasType::HTML },
+				{ "HTML", CanvasType::HTML }, { "JPK", CanvasType::JPEG2000 }, { "JPG", CanvasType::JPG },
+				{ "JPEG", CanvasType::JPG }, { "JSON", CanvasType::JSON }, { "MD", CanvasType::MARKDOWN },
+				{ "MARKDOWN", CanvasType::MARKDOWN }, { "PBM", CanvasType::PBM }, { "PCX", CanvasType::PCX },
+				{ "PDF", CanvasType::PDF }, { "PGM", CanvasType::PGM }, { "PNG", CanvasType::PNG },
+				{ "PPM", CanvasType::PPM }, { "PS", CanvasType::PS }, { "SVG", CanvasType::SVG },
+				{ "TGA", CanvasType::TGA }, { "TIF", CanvasType::TIF }, { "TIFF", CanvasType::TIF },
+				{ "WEBP", CanvasType::WEBP }, { "WEBSAFE", CanvasType::WEBSAFE }, { "XML", CanvasType::XML },
+				{ "XPS", CanvasType::XPS },
+			};
+
+			auto it = canvas_types.find(fold(!extension.empty() && extension[0] == '.' ? extension.substr(1) : extension));
+			if (it == canvas_types.end())
+				return std::nullopt;
+			return it->second;
+		}
+
+		std::optional<CanvasType> Registry::findCanvasType(const std::wstring& extension)
+		{
+			return findCanvasType(w_to_u8(extension));
+		}
+
+		bool Registry::LoadFrom(const std::wstring& filename)
+		{
+			std::ifstream stream(w_to_u8(filename), std::ios::binary);
+			if (!stream)
+				return false;
+
+			char magic[sizeof(cache_magic)] = { 0 };
+			uint32_t version = 0;
+			std::string engine_version;
+			if (!stream.read(&magic[0], sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), std::begin(cache_magic))
+				|| !read_u32(stream, version) || version != cache_version
+				|| !read_string(stream, engine_version))
+				return false;
+
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			m_impl->ensure_attached();
+			if (engine_version != m_impl->m_version)
+				return false;
+
+			uint32_t count = 0;
+			if (!read_u32(stream, count) || count > max_formats)
+				return false;
+			std::vector<Format> formats;
+			formats.reserve(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				uint32_t id = 0;
+				uint32_t category = 0;
+				std::wstring display_name, short_name, config_name, mime_type;
+				if (!read_u32(stream, id) || !read_string(stream, display_name) || !read_string(stream, short_name)
+					|| !read_string(stream, config_name) || !read_string(stream, mime_type) || !read_u32(stream, category))
+					return false;
+				formats.emplace_back(id, display_name, short_name, config_name, mime_type, category);
+			}
+
+			if (!read_u32(stream, count) || count > max_options)
+				return false;
+			std::vector<Option> options;
+			options.reserve(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				uint32_t flags = 0;
+				uint32_t value_count = 0;
+				std::wstring display_name, description, default_value, type;
+				if (!read_string(stream, display_name) || !read_string(stream, description) || !read_string(stream, default_value)
+					|| !read_string(stream, type) || !read_u32(stream, flags) || !read_u32(stream, value_count) || value_count > max_options)
+					return false;
+				std::vector<std::wstring> possible_values(value_count);
+				for (auto& value : possible_values)
+				{
+					if (!read_string(stream, value))
+						return false;
+				}
+				options.emplace_back(display_name, description, default_value, type, flags, possible_values);
+			}
+
+			// The magic is repeated at the end so a truncated file is never taken for a complete one
+			if (!stream.read(&magic[0], sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), std::begin(cache_magic)))
+				return false;
+
+			m_impl->set_formats(std::move(formats));
+			m_impl->set_options(std::move(options));
+			m_impl->m_probed.clear();
+			return true;
+		}
+
+		void Registry::SaveTo(const std::wstring& filename) const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			const std::vector<Format>& formats = m_impl->need_formats();
+			const std::vector<Option>& options = m_impl->need_options();
+
+			std::ofstream stream(w_to_u8(filename), std::ios::binary | std::ios::trunc);
+			if (!stream)
+				throw std::runtime_error("Failed to create registry cache " + w_to_u8(filename));
+
+			stream.write(&cache_magic[0], sizeof(cache_magic));
+			write_u32(stream, cache_version);
+			write_u32(stream, static_cast<uint32_t>(m_impl->m_version.size()));
+			stream.write(m_impl->m_version.data(), static_cast<std::streamsize>(m_impl->m_version.size()));
+
+			write_u32(stream, static_cast<uint32_t>(formats.size()));
+			for (const Format& format : formats)
+			{
+				write_u32(stream, format.id());
+				write_string(stream, format.getDisplayName());
+				write_string(stream, format.getShortName());
+				write_string(stream, format.getConfigName());
+				write_string(stream, format.getMimeType());
+				write_u32(stream, format.getFileTypeCategory());
+			}
+
+			write_u32(stream, static_cast<uint32_t>(options.size()));
+			for (const Option& option : options)
+			{
+				write_string(stream, option.getDisplayName());
+				write_string(stream, option.getDescription());
+				write_string(stream, option.getDefaultValue());
+				write_string(stream, option.getType());
+				write_u32(stream, option.getFlags());
+				write_u32(stream, static_cast<uint32_t>(option.getPossibleValues().size()));
+				for (const std::wstring& value : option.getPossibleValues())
+					write_string(stream, value);
+			}
+
+			stream.write(&cache_magic[0], sizeof(cache_magic));
+			if (!stream.flush())
+				throw std::runtime_error("Failed to write registry cache " + w_to_u8(filename));
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
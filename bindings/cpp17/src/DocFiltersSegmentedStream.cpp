@@ -0,0 +1,312 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		class SegmentPool::impl_t
+		{
+		public:
+			size_t m_segment_size = 0;
+			size_t m_max_cached = 0;
+			mutable std::mutex m_lock;
+			std::vector<uint8_t*> m_cached;
+
+			impl_t(size_t segment_size, size_t max_cached)
+				: m_segment_size(segment_size), m_max_cached(max_cached)
+			{
+			}
+
+			~impl_t()
+			{
+				trim();
+			}
+
+			uint8_t* acquire()
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_lock);
+					if (!m_cached.empty())
+					{
+						uint8_t* result = m_cached.back();
+						m_cached.pop_back();
+						return result;
+					}
+				}
+				return new uint8_t[m_segment_size];
+			}
+
+			void release(uint8_t* segment)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_lock);
+					if (m_cached.size() < m_max_cached)
+					{
+						m_cached.push_back(segment);
+						return;
+					}
+				}
+				delete[] segment;
+			}
+
+			void trim()
+			{
+				std::vector<uint8_t*> cached;
+				{
+					std::lock_guard<std::mutex> lock(m_lock);
+					cached.swap(m_cached);
+				}
+				for (auto* segment : cached)
+					delete[] segment;
+			}
+		};
+
+		void SegmentPool::Deleter::operator()(uint8_t* segment) const
+		{
+			if (segment == nullptr)
+				return;
+			if (m_pool)
+				m_pool->release(segment);
+			else
+				delete[] segment;
+		}
+
+		SegmentPool::SegmentPool(size_t segment_size, size_t max_cached)
+		{
+			if (segment_size == 0)
+				throw std::invalid_argument("segment_size must be greater than 0");
+			m_impl = std::make_shared<impl_t>(segment_size, max_cached);
+		}
+
+		SegmentPool::segment_ptr SegmentPool::acquire()
+		{
+			Deleter deleter;
+			deleter.m_pool = m_impl;
+			return segment_ptr(m_impl->acquire(), deleter);
+		}
+
+		size_t SegmentPool::segmentSize() const
+		{
+			return m_impl->m_segment_size;
+		}
+
+		size_t SegmentPool::cachedCount() const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_lock);
+			return m_impl->m_cached.size();
+		}
+
+		void SegmentPool::trim()
+		{
+			m_impl->trim();
+		}
+
+		// --------------------------------------------------------------------------------
+
+		class SegmentedStream::impl_t
+		{
+		public:
+			SegmentPool m_pool;
+			size_t m_segment_size;
+			std::vector<SegmentPool::segment_ptr> m_segments;
+			size_t m_size = 0;
+			size_t m_offset = 0;
+
+			explicit impl_t(const SegmentPool& pool)
+				: m_pool(pool), m_segment_size(pool.segmentSize())
+			{
+			}
+
+			// Makes sure segments cover [0, end), zero filling anything between the old size and from
+			void extend(size_t from, size_t end)
+			{
+				size_t needed = (end + m_segment_size - 1) / m_segment_size;
+				while (m_segments.size() < needed)
+					m_segments.push_back(m_pool.acquire());
+
+				for (size_t pos = m_size; pos < from;)
+				{
+					size_t index = pos / m_segment_size;
+					size_t offset = pos % m_segment_size;
+					size_t n = std::min(m_segment_size - offset, from - pos);
+					std::memset(m_segments[index].get() + offset, 0, n);
+					pos += n;
+				}
+			}
+
+			size_t write(const void* buffer, size_t size)
+			{
+				if (size == 0)
+					return 0;
+
+				size_t end = m_offset + size;
+				if (end > m_size)
+					extend(m_offset, end);
+
+				auto src = static_cast<const uint8_t*>(buffer);
+				size_t written = 0;
+				while (written < size)
+				{
+					size_t index = m_offset / m_segment_size;
+					size_t offset = m_offset % m_segment_size;
+					size_t n = std::min(m_segment_size - offset, size - written);
+					std::memcpy(m_segments[index].get() + offset, src + written, n);
+					written += n;
+					m_offset += n;
+				}
+				m_size = std::max(m_size, m_offset);
+				return written;
+			}
+
+			size_t read(void* buffer, size_t size)
+			{
+				if (m_offset >= m_size)
+					return 0;
+
+				auto dest = static_cast<uint8_t*>(buffer);
+				size_t total = std::min(size, m_size - m_offset);
+				size_t done = 0;
+				while (done < total)
+				{
+					size_t index = m_offset / m_segment_size;
+					size_t offset = m_offset % m_segment_size;
+					size_t n = std::min(m_segment_size - offset, total - done);
+					std::memcpy(dest + done, m_segments[index].get() + offset, n);
+					done += n;
+					m_offset += n;
+				}
+				return done;
+			}
+
+			size_t segment_length(size_t index) const
+			{
+				size_t begin = index * m_segment_size;
+				return std::min(m_segment_size, m_size - begin);
+			}
+
+			void clear()
+			{
+				m_segments.clear();
+				m_size = 0;
+				m_offset = 0;
+			}
+		};
+
+		SegmentedStream::SegmentedStream()
+			: SegmentedStream(SegmentPool())
+		{
+		}
+
+		SegmentedStream::SegmentedStream(const SegmentPool& pool)
+			: m_impl(std::make_unique<impl_t>(pool))
+		{
+		}
+
+		SegmentedStream::~SegmentedStream() = default;
+
+		std::streamoff SegmentedStream::seek(std::streampos offset, std::ios_base::seekdir way)
+		{
+			int64_t base = 0;
+			switch (way)
+			{
+			case std::ios::beg:
+				base = 0;
+				break;
+			case std::ios::cur:
+				base = static_cast<int64_t>(m_impl->m_offset);
+				break;
+			case std::ios::end:
+				base = static_cast<int64_t>(m_impl->m_size);
+				break;
+			default:
+				throw std::runtime_error("Not implemented");
+			}
+			int64_t target = base + static_cast<int64_t>(offset);
+			if (target < 0)
+				return -1;
+			m_impl->m_offset = static_cast<size_t>(target);
+			return target;
+		}
+
+		size_t SegmentedStream::read(void* buffer, size_t size)
+		{
+			return m_impl->read(buffer, size);
+		}
+
+		size_t SegmentedStream::write(const void* buffer, size_t size)
+		{
+			return m_impl->write(buffer, size);
+		}
+
+		bool SegmentedStream::get_memory_view(const void*& data, size_t& size) const
+		{
+			if (m_impl->m_size == 0 || m_impl->m_size > m_impl->m_segment_size)
+				return false;
+			data = m_impl->m_segments.front().get();
+			size = m_impl->m_size;
+			return true;
+		}
+
+		size_t SegmentedStream::size() const
+		{
+			return m_impl->m_size;
+		}
+
+		std::vector<SegmentedStream::Segment> SegmentedStream::getSegments() const
+		{
+			std::vector<Segment> result;
+			size_t count = (m_impl->m_size + m_impl->m_segment_size - 1) / m_impl->m_segment_size;
+			result.reserve(count);
+			for (size_t i = 0; i < count; ++i)
+				result.push_back({ m_impl->m_segments[i].get(), m_impl->segment_length(i) });
+			return result;
+		}
+
+		std::vector<SegmentedStream::OwnedSegment> SegmentedStream::takeSegments()
+		{
+			std::vector<OwnedSegment> result;
+			size_t count = (m_impl->m_size + m_impl->m_segment_size - 1) / m_impl->m_segment_size;
+			result.reserve(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				size_t length = m_impl->segment_length(i);
+				result.push_back({ std::move(m_impl->m_segments[i]), length });
+			}
+			m_impl->clear();
+			return result;
+		}
+
+		std::vector<uint8_t> SegmentedStream::toVector() const
+		{
+			std::vector<uint8_t> result;
+			result.reserve(m_impl->m_size);
+			for (auto&& segment : getSegments())
+				result.insert(result.end(), segment.data, segment.data + segment.size);
+			return result;
+		}
+
+		void SegmentedStream::clear()
+		{
+			m_impl->clear();
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
@@ -0,0 +1,355 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		class SpillStream::impl_t
+		{
+		public:
+			size_t m_threshold;
+			std::string m_temp_directory;
+			SegmentedStream m_memory;
+			Backing m_backing = Backing::Memory;
+			uint64_t m_spilled = 0;
+			uint64_t m_size = 0;
+			uint64_t m_offset = 0;
+#ifdef _WIN32
+			HANDLE m_file = INVALID_HANDLE_VALUE;
+#else
+			int m_fd = -1;
+#endif
+
+			impl_t(size_t threshold, const SegmentPool& pool, const std::string& temp_directory)
+				: m_threshold(threshold), m_temp_directory(temp_directory), m_memory(pool)
+			{
+			}
+
+			~impl_t()
+			{
+#ifdef _WIN32
+				if (m_file != INVALID_HANDLE_VALUE)
+					CloseHandle(m_file);
+#else
+				if (m_fd >= 0)
+					::close(m_fd);
+#endif
+			}
+
+#ifdef _WIN32
+			void open_temp_file()
+			{
+				std::wstring dir;
+				if (!m_temp_directory.empty())
+					dir = u8_to_w(m_temp_directory);
+				else
+				{
+					wchar_t path[MAX_PATH + 1];
+					DWORD len = GetTempPathW(MAX_PATH + 1, path);
+					if (len == 0)
+						throw std::runtime_error("Failed to get temporary directory");
+					dir.assign(path, len);
+				}
+
+				wchar_t name[MAX_PATH + 1];
+				if (GetTempFileNameW(dir.c_str(), L"dfs", 0, name) == 0)
+					throw std::runtime_error("Failed to create temporary file");
+
+				m_file = CreateFileW(name, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+					FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+				if (m_file == INVALID_HANDLE_VALUE)
+				{
+					DeleteFileW(name);
+					throw std::runtime_error("Failed to create temporary file");
+				}
+			}
+
+			/** Opens the temporary file, or empties it if an earlier spill left it open. */
+			void reset_temp_file()
+			{
+				if (m_file == INVALID_HANDLE_VALUE)
+					return open_temp_file();
+
+				LARGE_INTEGER zero = { 0 };
+				if (!SetFilePointerEx(m_file, zero, nullptr, FILE_BEGIN) || !SetEndOfFile(m_file))
+					throw std::runtime_error("Failed to truncate temporary file");
+			}
+
+			size_t write_at(const void* buffer, size_t size, uint64_t offset)
+			{
+				auto src = static_cast<const uint8_t*>(buffer);
+				size_t total = 0;
+				while (total < size)
+				{
+					OVERLAPPED ov = { 0 };
+					ov.Offset = static_cast<DWORD>(offset + total);
+					ov.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+					DWORD chunk = static_cast<DWORD>(std::min<size_t>(size - total, 0x40000000));
+					DWORD done = 0;
+					if (!WriteFile(m_file, src + total, chunk, &done, &ov) || done == 0)
+						break;
+					total += done;
+				}
+				return total;
+			}
+
+			size_t read_at(void* buffer, size_t size, uint64_t offset)
+			{
+				auto dest = static_cast<uint8_t*>(buffer);
+				size_t total = 0;
+				while (total < size)
+				{
+					OVERLAPPED ov = { 0 };
+					ov.Offset = static_cast<DWORD>(offset + total);
+					ov.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+					DWORD chunk = static_cast<DWORD>(std::min<size_t>(size - total, 0x40000000));
+					DWORD done = 0;
+					if (!ReadFile(m_file, dest + total, chunk, &done, &ov) || done == 0)
+						break;
+					total += done;
+				}
+				return total;
+			}
+#else
+			void open_temp_file()
+			{
+				std::string dir = m_temp_directory;
+				if (dir.empty())
+				{
+					const char* env = std::getenv("TMPDIR");
+					dir = env && *env ? env : "/tmp";
+				}
+
+#if defined(O_TMPFILE)
+				m_fd = ::open(dir.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+				if (m_fd >= 0)
+					return;
+#endif
+				// O_TMPFILE is unsupported on this platform or file system, create and unlink a named file
+				std::string name = dir + "/docfilters-spill-XXXXXX";
+				m_fd = mkstemp(&name[0]);
+				if (m_fd < 0)
+					throw std::runtime_error("Failed to create temporary file");
+				::unlink(name.c_str());
+				fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+			}
+
+			/** Opens the temporary file, or empties it if an earlier spill left it open. */
+			void reset_temp_file()
+			{
+				if (m_fd < 0)
+					return open_temp_file();
+
+#if defined(__APPLE__)
+				int rc = ftruncate(m_fd, 0);
+#else
+				int rc = ftruncate64(m_fd, 0);
+#endif
+				if (rc != 0)
+					throw std::runtime_error("Failed to truncate temporary file");
+			}
+
+			size_t write_at(const void* buffer, size_t size, uint64_t offset)
+			{
+				auto src = static_cast<const uint8_t*>(buffer);
+				size_t total = 0;
+				while (total < size)
+				{
+#if defined(__APPLE__)
+					ssize_t done = pwrite(m_fd, src + total, size - total, static_cast<off_t>(offset + total));
+#else
+					ssize_t done = pwrite64(m_fd, src + total, size - total, static_cast<off64_t>(offset + total));
+#endif
+					if (done < 0 && errno == EINTR)
+						continue;
+					if (done <= 0)
+						break;
+					total += static_cast<size_t>(done);
+				}
+				return total;
+			}
+
+			size_t read_at(void* buffer, size_t size, uint64_t offset)
+			{
+				auto dest = static_cast<uint8_t*>(buffer);
+				size_t total = 0;
+				while (total < size)
+				{
+#if defined(__APPLE__)
+					ssize_t done = pread(m_fd, dest + total, size - total, static_cast<off_t>(offset + total));
+#else
+					ssize_t done = pread64(m_fd, dest + total, size - total, static_cast<off64_t>(offset + total));
+#endif
+					if (done < 0 && errno == EINTR)
+						continue;
+					if (done <= 0)
+						break;
+					total += static_cast<size_t>(done);
+				}
+				return total;
+			}
+#endif
+
+			void spill()
+			{
+				// A spill that failed part way leaves the file open; it is emptied and reused on the next attempt
+				reset_temp_file();
+
+				uint64_t offset = 0;
+				for (auto&& segment : m_memory.getSegments())
+				{
+					if (write_at(segment.data, segment.size, offset) != segment.size)
+						throw std::runtime_error("Failed to write temporary file");
+					offset += segment.size;
+				}
+				m_spilled += offset;
+				m_memory.clear();
+				m_backing = Backing::File;
+			}
+
+			size_t write(const void* buffer, size_t size)
+			{
+				if (size == 0)
+					return 0;
+
+				if (m_backing == Backing::Memory && m_offset + size > m_threshold)
+					spill();
+
+				size_t written = 0;
+				if (m_backing == Backing::Memory)
+				{
+					m_memory.seek(static_cast<std::streamoff>(m_offset), std::ios::beg);
+					written = m_memory.write(buffer, size);
+				}
+				else
+				{
+					written = write_at(buffer, size, m_offset);
+					m_spilled += written;
+				}
+				m_offset += written;
+				m_size = std::max(m_size, m_offset);
+				return written;
+			}
+
+			size_t read(void* buffer, size_t size)
+			{
+				if (m_offset >= m_size || size == 0)
+					return 0;
+
+				size_t bytes = static_cast<size_t>(std::min<uint64_t>(size, m_size - m_offset));
+				if (m_backing == Backing::Memory)
+				{
+					m_memory.seek(static_cast<std::streamoff>(m_offset), std::ios::beg);
+					bytes = m_memory.read(buffer, bytes);
+				}
+				else
+					bytes = read_at(buffer, bytes, m_offset);
+
+				m_offset += bytes;
+				return bytes;
+			}
+		};
+
+		SpillStream::SpillStream(size_t memory_threshold, const std::string& temp_directory)
+			: SpillStream(memory_threshold, SegmentPool(), temp_directory)
+		{
+		}
+
+		SpillStream::SpillStream(size_t memory_threshold, const SegmentPool& pool, const std::string& temp_directory)
+			: m_impl(std::make_unique<impl_t>(memory_threshold, pool, temp_directory))
+		{
+		}
+
+		SpillStream::~SpillStream() = default;
+
+		std::streamoff SpillStream::seek(std::streampos offset, std::ios_base::seekdir way)
+		{
+			int64_t base = 0;
+			switch (way)
+			{
+			case std::ios::beg:
+				base = 0;
+				break;
+			case std::ios::cur:
+				base = static_cast<int64_t>(m_impl->m_offset);
+				break;
+			case std::ios::end:
+				base = static_cast<int64_t>(m_impl->m_size);
+				break;
+			default:
+				throw std::runtime_error("Not implemented");
+			}
+			int64_t target = base + static_cast<int64_t>(offset);
+			if (target < 0)
+				return -1;
+			m_impl->m_offset = static_cast<uint64_t>(target);
+			return target;
+		}
+
+		size_t SpillStream::read(void* buffer, size_t size)
+		{
+			return m_impl->read(buffer, size);
+		}
+
+		size_t SpillStream::write(const void* buffer, size_t size)
+		{
+			return m_impl->write(buffer, size);
+		}
+
+		bool SpillStream::get_memory_view(const void*& data, size_t& size) const
+		{
+			return m_impl->m_backing == Backing::Memory && m_impl->m_memory.get_memory_view(data, size);
+		}
+
+		uint64_t SpillStream::size() const
+		{
+			return m_impl->m_size;
+		}
+
+		SpillStream::Backing SpillStream::getBacking() const
+		{
+			return m_impl->m_backing;
+		}
+
+		uint64_t SpillStream::getSpilledBytes() const
+		{
+			return m_impl->m_spilled;
+		}
+
+		size_t SpillStream::getMemoryThreshold() const
+		{
+			return m_impl->m_threshold;
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
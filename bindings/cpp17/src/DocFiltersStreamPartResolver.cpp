@@ -0,0 +1,387 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <condition_variable>
+#include <cwctype>
+#include <deque>
+#include <future>
+#include <list>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		namespace
+		{
+			/** An opened part, shared between the cache and every stream handed out for it. */
+			struct part_t
+			{
+				std::unique_ptr<Stream> stream;
+				std::mutex lock;
+			};
+
+			/** A stream with its own position over a shared part. */
+			class part_view_t : public Stream
+			{
+			public:
+				explicit part_view_t(std::shared_ptr<part_t> part)
+					: m_part(std::move(part))
+				{
+				}
+
+				std::streamoff seek(std::streampos offset, std::ios_base::seekdir way) override
+				{
+					std::lock_guard<std::mutex> lock(m_part->lock);
+					if (way == std::ios::cur)
+					{
+						offset = m_offset + static_cast<std::streamoff>(offset);
+						way = std::ios::beg;
+					}
+					std::streamoff result = m_part->stream->seek(offset, way);
+					if (result >= 0)
+						m_offset = result;
+					return result;
+				}
+
+				size_t read(void* buffer, size_t size) override
+				{
+					std::lock_guard<std::mutex> lock(m_part->lock);
+					if (m_part->stream->seek(m_offset, std::ios::beg) != m_offset)
+						return 0;
+					size_t bytes = m_part->stream->read(buffer, size);
+					m_offset += static_cast<std::streamoff>(bytes);
+					return bytes;
+				}
+
+				bool get_memory_view(const void*& data, size_t& size) const override
+				{
+					return m_part->stream->get_memory_view(data, size);
+				}
+
+			private:
+				std::shared_ptr<part_t> m_part;
+				std::streamoff m_offset = 0;
+			};
+
+			/** Increments the last number in the file name portion of a path, preserving its width.
+			 *  Returns an empty string if the name has no number. */
+			std::wstring next_part_name(const std::wstring& name, size_t delta)
+			{
+				size_t name_start = name.find_last_of(L"/\\");
+				name_start = name_start == std::wstring::npos ? 0 : name_start + 1;
+
+				size_t end = name.size();
+				while (end > name_start && !iswdigit(name[end - 1]))
+					--end;
+				if (end == name_start)
+					return std::wstring();
+
+				size_t begin = end;
+				while (begin > name_start && iswdigit(name[begin - 1]))
+					--begin;
+
+				std::wstring digits = name.substr(begin, end - begin);
+				if (digits.size() > 18)
+					return std::wstring();
+
+				std::wstring next = std::to_wstring(std::stoull(digits) + delta);
+				if (next.size() < digits.size())
+					next.insert(0, digits.size() - next.size(), L'0');
+
+				return name.substr(0, begin) + next + name.substr(end);
+			}
+		} // namespace
+
+		class StreamPartResolver::impl_t
+		{
+		public:
+			typedef std::promise<std::shared_ptr<part_t>> promise_t;
+			typedef std::shared_future<std::shared_ptr<part_t>> future_t;
+
+			struct entry_t
+			{
+				future_t part;
+				std::list<std::wstring>::iterator lru;
+			};
+
+			/** A part waiting for the prefetch worker. Its cache entry stays pending until the promise is set. */
+			struct job_t
+			{
+				std::wstring part_name;
+				std::wstring full_name;
+				int index = 0;
+				std::shared_ptr<promise_t> promise;
+			};
+
+			opener_t m_opener;
+			Options m_options;
+			std::mutex m_lock;
+			std::condition_variable m_work_ready;
+			std::list<std::wstring> m_lru;
+			std::unordered_map<std::wstring, entry_t> m_entries;
+			std::deque<job_t> m_queue;
+			std::thread m_worker;
+			bool m_stop = false;
+
+			impl_t(const opener_t& opener, const Options& options)
+				: m_opener(opener), m_options(options)
+			{
+			}
+
+			~impl_t()
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_lock);
+					m_stop = true;
+					drop_queued(nullptr);
+				}
+				m_work_ready.notify_all();
+
+				// Waits for an open already in progress; the opener may still be using the part
+				if (m_worker.joinable())
+					m_worker.join();
+			}
+
+			static std::shared_ptr<part_t> open(const opener_t& opener, const std::wstring& part_name, const std::wstring& full_name, int index)
+			{
+				try
+				{
+					auto stream = opener(part_name, full_name, index);
+					if (!stream)
+						return nullptr;
+
+					auto part = std::make_shared<part_t>();
+					part->stream = std::move(stream);
+					return part;
+				}
+				catch (...)
+				{
+					return nullptr;
+				}
+			}
+
+			/** Fails the queued jobs for a part, or every queued job if part_name is null, so no entry waits on a
+			 *  promise that is never set. Must be called with m_lock held. */
+			void drop_queued(const std::wstring* part_name)
+			{
+				for (auto it = m_queue.begin(); it != m_queue.end();)
+				{
+					if (part_name == nullptr || it->part_name == *part_name)
+					{
+						it->promise->set_value(nullptr);
+						it = m_queue.erase(it);
+					}
+					else
+						++it;
+				}
+			}
+
+			/** Removes the queued job for a part, if the worker has not started it, and returns its promise.
+			 *  Must be called with m_lock held. */
+			std::shared_ptr<promise_t> take_queued(const std::wstring& part_name)
+			{
+				for (auto it = m_queue.begin(); it != m_queue.end(); ++it)
+				{
+					if (it->part_name == part_name)
+					{
+						auto promise = std::move(it->promise);
+						m_queue.erase(it);
+						return promise;
+					}
+				}
+				return nullptr;
+			}
+
+			/** Returns the cache entry for a part, or inserts a pending one and returns its promise.
+			 *  Must be called with m_lock held. */
+			future_t find_or_insert(const std::wstring& part_name, std::shared_ptr<promise_t>& promise)
+			{
+				auto it = m_entries.find(part_name);
+				if (it != m_entries.end())
+				{
+					m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+					return it->second.part;
+				}
+
+				promise = std::make_shared<promise_t>();
+				m_lru.push_front(part_name);
+				future_t part = promise->get_future().share();
+				m_entries.emplace(part_name, entry_t{ part, m_lru.begin() });
+
+				while (m_entries.size() > std::max<size_t>(m_options.cache_size, 1))
+				{
+					drop_queued(&m_lru.back());
+					m_entries.erase(m_lru.back());
+					m_lru.pop_back();
+				}
+				return part;
+			}
+
+			void forget(const std::wstring& part_name)
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				auto it = m_entries.find(part_name);
+				if (it == m_entries.end())
+					return;
+				m_lru.erase(it->second.lru);
+				m_entries.erase(it);
+			}
+
+			void clear()
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				drop_queued(nullptr);
+				m_entries.clear();
+				m_lru.clear();
+			}
+
+			void work()
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				for (;;)
+				{
+					m_work_ready.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+					if (m_stop)
+						break;
+
+					job_t job = std::move(m_queue.front());
+					m_queue.pop_front();
+					lock.unlock();
+					job.promise->set_value(open(m_opener, job.part_name, job.full_name, job.index));
+					lock.lock();
+				}
+			}
+
+			void prefetch(const std::wstring& part_name, const std::wstring& full_name, int index)
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				if (m_options.prefetch == 0 || m_stop)
+					return;
+
+				// One worker opens parts in order; prefetching is best effort, so a worker that cannot start is skipped
+				if (!m_worker.joinable())
+				{
+					try
+					{
+						m_worker = std::thread([this] { work(); });
+					}
+					catch (const std::system_error&)
+					{
+						return;
+					}
+				}
+
+				bool queued = false;
+				for (size_t i = 1; i <= m_options.prefetch && m_queue.size() < m_options.prefetch; ++i)
+				{
+					std::wstring next_name = next_part_name(part_name, i);
+					if (next_name.empty())
+						break;
+					std::wstring next_full_name = next_part_name(full_name, i);
+					if (next_full_name.empty())
+						next_full_name = next_name;
+
+					std::shared_ptr<promise_t> promise;
+					find_or_insert(next_name, promise);
+					if (!promise)
+						continue;
+
+					try
+					{
+						m_queue.push_back(job_t{ next_name, next_full_name, index + static_cast<int>(i), promise });
+					}
+					catch (...)
+					{
+						// resolve opens the part itself when a prefetch comes back empty
+						promise->set_value(nullptr);
+						break;
+					}
+					queued = true;
+				}
+				if (queued)
+					m_work_ready.notify_one();
+			}
+
+			std::unique_ptr<Stream> resolve(const std::wstring& part_name, const std::wstring& full_name, int index)
+			{
+				std::shared_ptr<promise_t> promise;
+				future_t future;
+				{
+					std::lock_guard<std::mutex> lock(m_lock);
+					future = find_or_insert(part_name, promise);
+
+					// A part still waiting for the worker is opened here rather than behind the parts queued before it
+					if (!promise)
+						promise = take_queued(part_name);
+				}
+
+				if (promise)
+					promise->set_value(open(m_opener, part_name, full_name, index));
+
+				prefetch(part_name, full_name, index);
+
+				std::shared_ptr<part_t> part = future.get();
+				if (!part)
+				{
+					// Don't cache failures; the part may appear later, for example while a download is still running
+					forget(part_name);
+					if (promise)
+						return nullptr;
+
+					// The failure came from a prefetch, which may have run before the part was available; try again now
+					{
+						std::lock_guard<std::mutex> lock(m_lock);
+						future = find_or_insert(part_name, promise);
+						if (!promise)
+							promise = take_queued(part_name);
+					}
+					if (promise)
+						promise->set_value(open(m_opener, part_name, full_name, index));
+
+					part = future.get();
+					if (!part)
+					{
+						forget(part_name);
+						return nullptr;
+					}
+				}
+				return std::make_unique<part_view_t>(std::move(part));
+			}
+		};
+
+		StreamPartResolver::StreamPartResolver(const opener_t& opener, const Options& options)
+		{
+			if (!opener)
+				throw std::invalid_argument("opener must not be empty");
+			m_impl = std::make_shared<impl_t>(opener, options);
+		}
+
+		std::unique_ptr<Stream> StreamPartResolver::operator()(const std::wstring& part_name, const std::wstring& full_name, int index) const
+		{
+			return m_impl->resolve(part_name, full_name, index);
+		}
+
+		void StreamPartResolver::clear()
+		{
+			m_impl->clear();
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
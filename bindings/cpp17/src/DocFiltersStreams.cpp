@@ -15,55 +15,13 @@
 #include "DocumentFiltersObjects.h"
 #include "DocFiltersCommon.h"
 #include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 namespace Hyland
 {
 	namespace DocFilters
 	{
-
-		template <typename InnerStream, typename Traits>
-		IGR_Stream* bridge_stream_t(InnerStream* stream, bool own_stream, IGR_Stream** igr_stream)
-		{
-			struct funcs
-			{
-				static IGR_ULONG IGR_EXPORT read(void* handle, void* buffer, IGR_ULONG size)
-				{
-					return Traits::read(reinterpret_cast<InnerStream*>(handle), buffer, size);
-				}
-				static IGR_ULONG IGR_EXPORT write(void* handle, const void* buffer, IGR_ULONG size)
-				{
-					return Traits::write(reinterpret_cast<InnerStream*>(handle), buffer, size);
-				}
-				static IGR_LONGLONG IGR_EXPORT seek(void* handle, IGR_LONGLONG offset, IGR_ULONG origin)
-				{
-					return Traits::seek(reinterpret_cast<InnerStream*>(handle), offset, origin);
-				}
-				static void IGR_EXPORT destroy(void* handle)
-				{
-					Traits::destroy(reinterpret_cast<InnerStream*>(handle));
-				}
-				static void IGR_EXPORT destroy_noop(void* handle)
-				{
-				}
-			};
-			if (!stream)
-				throw std::invalid_argument("stream cannot be null");
-			if (!igr_stream)
-				throw std::invalid_argument("igr_stream cannot be null");
-
-			Error_Control_Block ecb = { 0 };
-			throw_on_error(IGR_Make_Stream_From_Functions(stream
-				, 0
-				, funcs::seek
-				, funcs::read
-				, funcs::write
-				, nullptr // no actions
-				, own_stream ? funcs::destroy : funcs::destroy_noop, igr_stream, &ecb),
-				ecb, "IGR_Make_Stream_From_Functions", "Failed to create stream from file");
-
-			return *igr_stream;
-		}
-
 		struct iostream_traits
 		{
 			static IGR_ULONG read(std::istream* stream, void* buffer, IGR_ULONG size)
@@ -167,6 +125,30 @@ namespace Hyland
 				{
 					return stream->seek(offset, static_cast<std::ios_base::seekdir>(origin));
 				}
+				static IGR_LONG action(Hyland::DocFilters::Stream* stream, int action_id, void* action_data)
+				{
+					if (action_id != IGR_ACTION_GET_STREAM_PART || action_data == nullptr)
+						return IGR_E_NOT_VALID_FOR_THIS_CLASS;
+
+					// Exceptions must not reach the engine
+					try
+					{
+						auto request = reinterpret_cast<IGR_T_ACTION_GET_STREAM_PART*>(action_data);
+						std::unique_ptr<Stream> part = stream->get_stream_part(
+							request->partName ? request->partName : L"",
+							request->partFullName ? request->partFullName : L"",
+							request->partIndex);
+						if (!part)
+							return IGR_E_NOT_FOUND;
+
+						Stream::bridge_input_stream(part.release(), true, &request->istr);
+						return IGR_OK;
+					}
+					catch (...)
+					{
+						return IGR_E_ERROR;
+					}
+				}
 				static void destroy(Hyland::DocFilters::Stream* stream)
 				{
 					delete stream;
@@ -188,6 +170,74 @@ namespace Hyland
 				return bridge_stream_t<Hyland::DocFilters::Stream, traits>(stream, own_stream, igr_stream);
 		}
 
+		namespace
+		{
+			/// Streams whose memory views were handed to IGR_Make_Stream_From_Memory, keyed by the view.
+			/// The engine only passes the buffer pointer to the destructor, so the owner is looked up here.
+			class memory_view_owners_t
+			{
+			public:
+				static memory_view_owners_t& instance()
+				{
+					static memory_view_owners_t owners;
+					return owners;
+				}
+
+				bool add(const void* data, Stream* owner)
+				{
+					std::lock_guard<std::mutex> lock(m_lock);
+					return m_owners.emplace(data, owner).second;
+				}
+
+				void remove(const void* data)
+				{
+					std::lock_guard<std::mutex> lock(m_lock);
+					m_owners.erase(data);
+				}
+
+				static void release(void* data)
+				{
+					auto& owners = instance();
+					Stream* owner = nullptr;
+					{
+						std::lock_guard<std::mutex> lock(owners.m_lock);
+						auto found = owners.m_owners.find(data);
+						if (found == owners.m_owners.end())
+							return;
+						owner = found->second;
+						owners.m_owners.erase(found);
+					}
+					delete owner;
+				}
+			private:
+				std::mutex m_lock;
+				std::unordered_map<const void*, Stream*> m_owners;
+			};
+		} // namespace
+
+		IGR_Stream* Stream::bridge_input_stream(Hyland::DocFilters::Stream* stream, bool own_stream, IGR_Stream** igr_stream)
+		{
+			if (stream == nullptr || igr_stream == nullptr)
+				throw std::invalid_argument("stream and igr_stream cannot be null");
+
+			const void* data = nullptr;
+			size_t size = 0;
+			if (!stream->get_memory_view(data, size) || data == nullptr || size == 0)
+				return bridge_stream(stream, own_stream, igr_stream);
+
+			// Two owned streams over the same buffer can't be told apart in the destructor, bridge the second one
+			if (own_stream && !memory_view_owners_t::instance().add(data, stream))
+				return bridge_stream(stream, own_stream, igr_stream);
+
+			Error_Control_Block ecb = { 0 };
+			DocumentFilters::memory_destruct_t destruct = own_stream ? &memory_view_owners_t::release : nullptr;
+			auto rc = IGR_Make_Stream_From_Memory(const_cast<void*>(data), size, reinterpret_cast<void*>(destruct), igr_stream, &ecb); // NOLINT
+			if (rc != IGR_OK && own_stream)
+				memory_view_owners_t::instance().remove(data);
+			throw_on_error(rc, ecb, "IGR_Make_Stream_From_Memory", "Failed to create stream from memory");
+			return *igr_stream;
+		}
+
 		// --------------------------------------------------------------------------------
 		std::streamoff Stream::getSize()
 		{
@@ -241,7 +291,7 @@ namespace Hyland
 		{
 			if (m_offset >= m_size || m_offset >= m_capacity)
 				return 0;
-			size_t bytes = std::min(size, m_capacity - m_offset);
+			size_t bytes = std::min(size, std::min(m_size, m_capacity) - m_offset);
 			std::memcpy(buffer, static_cast<uint8_t*>(m_buffer) + m_offset, bytes);
 			m_offset += bytes;
 			return bytes;
@@ -260,6 +310,15 @@ namespace Hyland
 			return size;
 		}
 
+		bool MemStream::get_memory_view(const void*& data, size_t& size) const
+		{
+			if (m_buffer == nullptr || m_size == 0)
+				return false;
+			data = m_buffer;
+			size = std::min(m_size, m_capacity);
+			return true;
+		}
+
 		void MemStream::set_size(size_t size)
 		{
 			m_size = size;
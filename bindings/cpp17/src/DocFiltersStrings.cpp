@@ -14,6 +14,24 @@
 */
 #include "DocumentFiltersObjects.h"
 #include "DocFiltersCommon.h"
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DOCFILTERS_STRINGS_SSE2 1
+#include <emmintrin.h>
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define DOCFILTERS_STRINGS_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DOCFILTERS_STRINGS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
 
 namespace Hyland
 {
@@ -21,6 +39,22 @@ namespace Hyland
 	{
         namespace
         {
+            // wchar_t holds UTF-16 on Windows and UTF-32 everywhere else
+            typedef std::conditional<sizeof(wchar_t) == 2, char16_t, char32_t>::type wide_unit_t;
+
+            constexpr char32_t replacement_char = 0xFFFD;
+
+            inline unsigned count_trailing_zeros(uint32_t mask)
+            {
+#if defined(_MSC_VER) && !defined(__clang__)
+                unsigned long index;
+                _BitScanForward(&index, mask);
+                return static_cast<unsigned>(index);
+#else
+                return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+            }
+
             template <typename S>
             size_t find_len(const S* text, size_t max_length)
             {
@@ -30,157 +64,1006 @@ namespace Hyland
                 return len;
             }
 
-            template <typename T>
-            T u8_to_uX(const char* str, size_t str_len)
+            inline size_t find_len(const char* text, size_t max_length)
             {
-                if (str == nullptr || str_len == 0)
-                    return T();
-                if (str_len == std::wstring::npos)
-                    str_len = std::char_traits<char>::length(str);
+                auto zero = static_cast<const char*>(memchr(text, 0, max_length));
+                return zero == nullptr ? max_length : static_cast<size_t>(zero - text);
+            }
 
+            // What a conversion does besides changing the encoding. With strip set, the control characters
+            // Extractor::getText strips are dropped and \xE becomes a new line; with swap set, UTF-16 and UTF-32
+            // code units are written in the opposite byte order.
+            template <bool Strip, bool Swap>
+            struct output_mode_t
+            {
+                static constexpr bool strip = Strip;
+                static constexpr bool swap = Swap;
+            };
+            typedef output_mode_t<false, false> plain_t;
 
-                T result;
-                for (size_t i = 0; i < str_len; ++i)
+            inline char swap_unit(char unit)
+            {
+                return unit;
+            }
+
+            inline char16_t swap_unit(char16_t unit)
+            {
+                return static_cast<char16_t>((unit >> 8) | (unit << 8)); // NOLINT
+            }
+
+            inline char32_t swap_unit(char32_t unit)
+            {
+                return (unit >> 24) | ((unit >> 8) & 0xFF00) | ((unit << 8) & 0xFF0000) | (unit << 24); // NOLINT
+            }
+
+            // ---------------------------------------------------------------------------------------------
+            // Fast path for runs of code units that convert one to one, a vector at a time: ASCII whenever
+            // UTF-8 is on either side, otherwise any BMP character that is not a surrogate (and, when
+            // stripping, not a control character). direct_length measures such a run and copy_direct widens
+            // or narrows it to the destination code unit size.
+            // ---------------------------------------------------------------------------------------------
+
+            template <typename S, typename D, typename M = plain_t>
+            inline bool is_direct(S unit)
+            {
+                auto u = static_cast<uint32_t>(unit);
+                if (M::strip && u < 0x20) // NOLINT
+                    return false;
+                if (sizeof(S) == 1 || sizeof(D) == 1)
+                    return u < 0x80; // NOLINT
+                return u < 0xD800 || (u >= 0xE000 && u < 0x10000); // NOLINT
+            }
+
+#if defined(DOCFILTERS_STRINGS_SSE2)
+            template <typename S, typename D>
+            inline uint32_t unconvertible_mask(__m128i v)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                if (sizeof(S) == 1)
+                    return static_cast<uint32_t>(_mm_movemask_epi8(v));
+                if (sizeof(D) == 1)
                 {
-                    unsigned char ch = str[i];
-                    if (ch == 0)
-                        break;
-                    if (ch <= 0x7F) // NOLINT
-                        result.push_back(static_cast<typename T::value_type>(ch));
-                    else if (ch <= 0xDF && i + 1 < str_len)  // NOLINT
+                    const __m128i high = sizeof(S) == 2 ? _mm_set1_epi16(static_cast<short>(0xFF80)) : _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+                    __m128i ascii = sizeof(S) == 2 ? _mm_cmpeq_epi16(_mm_and_si128(v, high), zero) : _mm_cmpeq_epi32(_mm_and_si128(v, high), zero);
+                    return static_cast<uint32_t>(_mm_movemask_epi8(ascii)) ^ 0xFFFF;
+                }
+                if (sizeof(S) == 2)
+                    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xF800))), _mm_set1_epi16(static_cast<short>(0xD800)))));
+                __m128i bmp = _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xFFFF0000))), zero);
+                __m128i surrogate = _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xFFFFF800))), _mm_set1_epi32(0xD800));
+                return static_cast<uint32_t>(_mm_movemask_epi8(_mm_andnot_si128(surrogate, bmp))) ^ 0xFFFF;
+            }
+
+            // Returns a byte mask with bits set for the code units that cannot be copied directly
+            template <typename S, typename D, typename M>
+            inline uint32_t indirect_mask(__m128i v)
+            {
+                uint32_t mask = unconvertible_mask<S, D>(v);
+                if (M::strip)
+                {
+                    const __m128i zero = _mm_setzero_si128();
+                    __m128i control = sizeof(S) == 1 ? _mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8(static_cast<char>(0xE0))), zero)
+                        : sizeof(S) == 2 ? _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFFE0))), zero)
+                        : _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xFFFFFFE0))), zero);
+                    mask |= static_cast<uint32_t>(_mm_movemask_epi8(control));
+                }
+                return mask;
+            }
+
+            template <typename D, typename M>
+            inline __m128i swap_lanes(__m128i v)
+            {
+                if (!M::swap || sizeof(D) == 1)
+                    return v;
+                if (sizeof(D) == 4)
+                    v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+                return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            }
+#elif defined(DOCFILTERS_STRINGS_NEON)
+            template <typename M>
+            inline uint16x8_t swap_lanes(uint16x8_t v)
+            {
+                return M::swap ? vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(v))) : v;
+            }
+
+            template <typename M>
+            inline uint32x4_t swap_lanes(uint32x4_t v)
+            {
+                return M::swap ? vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(v))) : v;
+            }
+#endif
+
+#ifdef DOCFILTERS_STRINGS_AVX2
+            bool has_avx2()
+            {
+                static const bool result = __builtin_cpu_supports("avx2") != 0;
+                return result;
+            }
+
+            template <typename S, typename D, typename M>
+            __attribute__((target("avx2")))
+            size_t direct_length_avx2(const S* str, size_t len, size_t i)
+            {
+                constexpr size_t per_block = 32 / sizeof(S);
+                const __m256i zero = _mm256_setzero_si256();
+                for (; i + per_block <= len; i += per_block)
+                {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i));
+                    uint32_t mask;
+                    if (sizeof(S) == 1)
+                        mask = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+                    else if (sizeof(D) == 1)
                     {
-                        result.push_back(static_cast<typename T::value_type>(((ch & 0x1F) << 6) | (str[i + 1] & 0x3F)));  // NOLINT
-                        ++i;
+                        const __m256i high = sizeof(S) == 2 ? _mm256_set1_epi16(static_cast<short>(0xFF80)) : _mm256_set1_epi32(static_cast<int>(0xFFFFFF80));
+                        __m256i ascii = sizeof(S) == 2 ? _mm256_cmpeq_epi16(_mm256_and_si256(v, high), zero) : _mm256_cmpeq_epi32(_mm256_and_si256(v, high), zero);
+                        mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(ascii));
                     }
-                    else if (ch <= 0xEF && i + 2 < str_len)  // NOLINT
+                    else if (sizeof(S) == 2)
+                        mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_set1_epi16(static_cast<short>(0xF800))), _mm256_set1_epi16(static_cast<short>(0xD800)))));
+                    else
                     {
-                        result.push_back(static_cast<typename T::value_type>(((ch & 0x0F) << 12) | ((str[i + 1] & 0x3F) << 6) | (str[i + 2] & 0x3F)));  // NOLINT
-                        i += 2;
+                        __m256i bmp = _mm256_cmpeq_epi32(_mm256_and_si256(v, _mm256_set1_epi32(static_cast<int>(0xFFFF0000))), zero);
+                        __m256i surrogate = _mm256_cmpeq_epi32(_mm256_and_si256(v, _mm256_set1_epi32(static_cast<int>(0xFFFFF800))), _mm256_set1_epi32(0xD800));
+                        mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_andnot_si256(surrogate, bmp)));
                     }
-                    else if (ch <= 0xF7 && i + 3 < str_len)  // NOLINT
+                    if (M::strip)
                     {
-                        uint32_t codepoint = ((ch & 0x07) << 18) | ((str[i + 1] & 0x3F) << 12) | ((str[i + 2] & 0x3F) << 6) | (str[i + 3] & 0x3F);  // NOLINT
-                        if (sizeof(typename T::value_type) == 4 || codepoint <= 0xFFFF)  // NOLINT
-                            result.push_back(static_cast<typename T::value_type>(codepoint));
-                        else
+                        __m256i control = sizeof(S) == 1 ? _mm256_cmpeq_epi8(_mm256_and_si256(v, _mm256_set1_epi8(static_cast<char>(0xE0))), zero)
+                            : sizeof(S) == 2 ? _mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_set1_epi16(static_cast<short>(0xFFE0))), zero)
+                            : _mm256_cmpeq_epi32(_mm256_and_si256(v, _mm256_set1_epi32(static_cast<int>(0xFFFFFFE0))), zero);
+                        mask |= static_cast<uint32_t>(_mm256_movemask_epi8(control));
+                    }
+                    if (mask != 0)
+                        return i + count_trailing_zeros(mask) / sizeof(S);
+                }
+                return i;
+            }
+#endif
+
+            template <typename S, typename D, typename M = plain_t>
+            size_t direct_length(const S* str, size_t len)
+            {
+                size_t i = 0;
+#if defined(DOCFILTERS_STRINGS_SSE2)
+                constexpr size_t per_block = 16 / sizeof(S);
+                for (; i + per_block <= len; i += per_block)
+                {
+                    uint32_t mask = indirect_mask<S, D, M>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i)));
+                    if (mask != 0)
+                        return i + count_trailing_zeros(mask) / sizeof(S);
+#if defined(DOCFILTERS_STRINGS_AVX2)
+                    // Only a run that fills the first vector is worth the call into the wider loop
+                    if (i == 0 && len >= 4 * per_block && has_avx2())
+                    {
+                        i = direct_length_avx2<S, D, M>(str, len, per_block);
+                        if (i + per_block > len || indirect_mask<S, D, M>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i))) != 0)
+                            break;
+                    }
+#endif
+                }
+#elif defined(DOCFILTERS_STRINGS_NEON)
+                if (sizeof(S) == 1)
+                {
+                    for (; i + 16 <= len; i += 16)
+                    {
+                        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(str + i));
+                        if (vmaxvq_u8(v) >= 0x80 || (M::strip && vminvq_u8(v) < 0x20))
+                            break;
+                    }
+                }
+                else if (sizeof(S) == 2)
+                {
+                    for (; i + 8 <= len; i += 8)
+                    {
+                        uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t*>(str + i));
+                        uint16x8_t bad = sizeof(D) == 1 ? vcgeq_u16(v, vdupq_n_u16(0x80)) : vceqq_u16(vandq_u16(v, vdupq_n_u16(0xF800)), vdupq_n_u16(0xD800));
+                        if (M::strip)
+                            bad = vorrq_u16(bad, vcltq_u16(v, vdupq_n_u16(0x20)));
+                        if (vmaxvq_u16(bad) != 0)
+                            break;
+                    }
+                }
+                else
+                {
+                    for (; i + 4 <= len; i += 4)
+                    {
+                        uint32x4_t v = vld1q_u32(reinterpret_cast<const uint32_t*>(str + i));
+                        uint32x4_t bad = sizeof(D) == 1 ? vcgeq_u32(v, vdupq_n_u32(0x80))
+                            : vorrq_u32(vcgeq_u32(v, vdupq_n_u32(0x10000)), vceqq_u32(vandq_u32(v, vdupq_n_u32(0xFFFFF800)), vdupq_n_u32(0xD800)));
+                        if (M::strip)
+                            bad = vorrq_u32(bad, vcltq_u32(v, vdupq_n_u32(0x20)));
+                        if (vmaxvq_u32(bad) != 0)
+                            break;
+                    }
+                }
+#endif
+                while (i < len && is_direct<S, D, M>(str[i]))
+                    ++i;
+                return i;
+            }
+
+            template <typename S, typename D, typename M = plain_t>
+            void copy_direct(const S* src, size_t len, D* dest)
+            {
+                size_t i = 0;
+#if defined(DOCFILTERS_STRINGS_SSE2)
+                const __m128i zero = _mm_setzero_si128();
+                if (sizeof(S) == 1 && sizeof(D) == 2)
+                {
+                    for (; i + 16 <= len; i += 16)
+                    {
+                        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), swap_lanes<D, M>(_mm_unpacklo_epi8(v, zero)));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 8), swap_lanes<D, M>(_mm_unpackhi_epi8(v, zero)));
+                    }
+                }
+                else if (sizeof(S) == 1 && sizeof(D) == 4)
+                {
+                    for (; i + 16 <= len; i += 16)
+                    {
+                        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                        __m128i lo = _mm_unpacklo_epi8(v, zero);
+                        __m128i hi = _mm_unpackhi_epi8(v, zero);
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), swap_lanes<D, M>(_mm_unpacklo_epi16(lo, zero)));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 4), swap_lanes<D, M>(_mm_unpackhi_epi16(lo, zero)));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 8), swap_lanes<D, M>(_mm_unpacklo_epi16(hi, zero)));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 12), swap_lanes<D, M>(_mm_unpackhi_epi16(hi, zero)));
+                    }
+                }
+                else if (sizeof(S) == 2 && sizeof(D) == 1)
+                {
+                    for (; i + 16 <= len; i += 16)
+                    {
+                        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(a, b));
+                    }
+                }
+                else if (sizeof(S) == 2 && sizeof(D) == 4)
+                {
+                    for (; i + 8 <= len; i += 8)
+                    {
+                        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), swap_lanes<D, M>(_mm_unpacklo_epi16(v, zero)));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 4), swap_lanes<D, M>(_mm_unpackhi_epi16(v, zero)));
+                    }
+                }
+                else if (sizeof(S) == 4 && sizeof(D) == 1)
+                {
+                    for (; i + 16 <= len; i += 16)
+                    {
+                        __m128i a = _mm_packs_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)));
+                        __m128i b = _mm_packs_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12)));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(a, b));
+                    }
+                }
+                else if (sizeof(S) == 4 && sizeof(D) == 2)
+                {
+                    // packs saturates signed values, so sign extend the low halves first to keep them intact
+                    for (; i + 8 <= len; i += 8)
+                    {
+                        __m128i a = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), 16), 16);
+                        __m128i b = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)), 16), 16);
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), swap_lanes<D, M>(_mm_packs_epi32(a, b)));
+                    }
+                }
+                else if (sizeof(S) == sizeof(D) && M::swap)
+                {
+                    for (; i + 16 / sizeof(S) <= len; i += 16 / sizeof(S))
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), swap_lanes<D, M>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+                }
+#elif defined(DOCFILTERS_STRINGS_NEON)
+                if (sizeof(S) == 1 && sizeof(D) == 2)
+                {
+                    for (; i + 16 <= len; i += 16)
+                    {
+                        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+                        vst1q_u16(reinterpret_cast<uint16_t*>(dest + i), swap_lanes<M>(vmovl_u8(vget_low_u8(v))));
+                        vst1q_u16(reinterpret_cast<uint16_t*>(dest + i + 8), swap_lanes<M>(vmovl_u8(vget_high_u8(v))));
+                    }
+                }
+                else if (sizeof(S) == 2 && sizeof(D) == 1)
+                {
+                    for (; i + 16 <= len; i += 16)
+                    {
+                        uint8x8_t a = vmovn_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(src + i)));
+                        uint8x8_t b = vmovn_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(src + i + 8)));
+                        vst1q_u8(reinterpret_cast<uint8_t*>(dest + i), vcombine_u8(a, b));
+                    }
+                }
+                else if (sizeof(S) == 2 && sizeof(D) == 4)
+                {
+                    for (; i + 8 <= len; i += 8)
+                    {
+                        uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t*>(src + i));
+                        vst1q_u32(reinterpret_cast<uint32_t*>(dest + i), swap_lanes<M>(vmovl_u16(vget_low_u16(v))));
+                        vst1q_u32(reinterpret_cast<uint32_t*>(dest + i + 4), swap_lanes<M>(vmovl_u16(vget_high_u16(v))));
+                    }
+                }
+                else if (sizeof(S) == 4 && sizeof(D) == 2)
+                {
+                    for (; i + 8 <= len; i += 8)
+                    {
+                        uint16x4_t a = vmovn_u32(vld1q_u32(reinterpret_cast<const uint32_t*>(src + i)));
+                        uint16x4_t b = vmovn_u32(vld1q_u32(reinterpret_cast<const uint32_t*>(src + i + 4)));
+                        vst1q_u16(reinterpret_cast<uint16_t*>(dest + i), swap_lanes<M>(vcombine_u16(a, b)));
+                    }
+                }
+                else if (sizeof(S) == 2 && sizeof(D) == 2 && M::swap)
+                {
+                    for (; i + 8 <= len; i += 8)
+                        vst1q_u16(reinterpret_cast<uint16_t*>(dest + i), swap_lanes<M>(vld1q_u16(reinterpret_cast<const uint16_t*>(src + i))));
+                }
+                else if (sizeof(S) == 4 && sizeof(D) == 4 && M::swap)
+                {
+                    for (; i + 4 <= len; i += 4)
+                        vst1q_u32(reinterpret_cast<uint32_t*>(dest + i), swap_lanes<M>(vld1q_u32(reinterpret_cast<const uint32_t*>(src + i))));
+                }
+#endif
+                for (; i < len; ++i)
+                    dest[i] = M::swap ? swap_unit(static_cast<D>(src[i])) : static_cast<D>(src[i]);
+            }
+
+            // ---------------------------------------------------------------------------------------------
+            // Code point decoding and encoding. Ill-formed input (invalid or truncated UTF-8, unpaired
+            // surrogates, values beyond U+10FFFF) decodes to U+FFFD and clears `valid`.
+            // ---------------------------------------------------------------------------------------------
+
+            inline bool in_range(const char* p, const char* end, unsigned char lo, unsigned char hi)
+            {
+                return p != end && static_cast<unsigned char>(*p) >= lo && static_cast<unsigned char>(*p) <= hi;
+            }
+
+            // The accepted range of the first continuation byte rules out overlong forms, surrogates and values
+            // beyond U+10FFFF, so an invalid sequence is rejected at its first bad byte. That byte is left in place
+            // to start the next sequence, giving one U+FFFD for each maximal invalid subpart.
+            inline char32_t decode(const char*& p, const char* end, bool& valid)
+            {
+                auto ch = static_cast<unsigned char>(*p++);
+                if (ch < 0x80) // NOLINT
+                    return ch;
+
+                // Well-formed 2 and 3 byte sequences (everything in the BMP but the E0 and ED leads) need no range checks
+                if (end - p >= 2)
+                {
+                    auto c1 = static_cast<unsigned char>(p[0]);
+                    auto c2 = static_cast<unsigned char>(p[1]);
+                    if (ch >= 0xC2 && ch <= 0xDF && (c1 & 0xC0) == 0x80) // NOLINT
+                    {
+                        p += 1;
+                        return (static_cast<char32_t>(ch & 0x1F) << 6) | (c1 & 0x3F); // NOLINT
+                    }
+                    if (ch > 0xE0 && ch <= 0xEF && ch != 0xED && (c1 & 0xC0) == 0x80 && (c2 & 0xC0) == 0x80) // NOLINT
+                    {
+                        p += 2;
+                        return (static_cast<char32_t>(ch & 0x0F) << 12) | (static_cast<char32_t>(c1 & 0x3F) << 6) | (c2 & 0x3F); // NOLINT
+                    }
+                }
+
+                if (ch >= 0xC2 && ch <= 0xDF) // NOLINT
+                {
+                    if (in_range(p, end, 0x80, 0xBF)) // NOLINT
+                        return (static_cast<char32_t>(ch & 0x1F) << 6) | (*p++ & 0x3F); // NOLINT
+                }
+                else if (ch >= 0xE0 && ch <= 0xEF) // NOLINT
+                {
+                    unsigned char lo = ch == 0xE0 ? 0xA0 : 0x80; // NOLINT
+                    unsigned char hi = ch == 0xED ? 0x9F : 0xBF; // NOLINT
+                    if (in_range(p, end, lo, hi))
+                    {
+                        if (in_range(p + 1, end, 0x80, 0xBF)) // NOLINT
                         {
-                            result.push_back(static_cast<typename T::value_type>(0xD800 + ((codepoint - 0x10000) >> 10))); // NOLINT
-                            result.push_back(static_cast<typename T::value_type>(0xDC00 + ((codepoint - 0x10000) & 0x3FF)));  // NOLINT
+                            char32_t cp = (static_cast<char32_t>(ch & 0x0F) << 12) | (static_cast<char32_t>(p[0] & 0x3F) << 6) | (p[1] & 0x3F); // NOLINT
+                            p += 2;
+                            return cp;
                         }
-                        i += 3;
+                        ++p;
                     }
                 }
-                return result;
+                else if (ch >= 0xF0 && ch <= 0xF4) // NOLINT
+                {
+                    unsigned char lo = ch == 0xF0 ? 0x90 : 0x80; // NOLINT
+                    unsigned char hi = ch == 0xF4 ? 0x8F : 0xBF; // NOLINT
+                    if (in_range(p, end, lo, hi))
+                    {
+                        ++p;
+                        if (in_range(p, end, 0x80, 0xBF)) // NOLINT
+                        {
+                            ++p;
+                            if (in_range(p, end, 0x80, 0xBF)) // NOLINT
+                            {
+                                char32_t cp = (static_cast<char32_t>(ch & 0x07) << 18) | (static_cast<char32_t>(p[-2] & 0x3F) << 12) | (static_cast<char32_t>(p[-1] & 0x3F) << 6) | (p[0] & 0x3F); // NOLINT
+                                ++p;
+                                return cp;
+                            }
+                        }
+                    }
+                }
+                valid = false;
+                return replacement_char;
             }
 
-        } // namespace
+            inline char32_t decode(const char16_t*& p, const char16_t* end, bool& valid)
+            {
+                char16_t ch = *p++;
+                if (ch < 0xD800 || ch > 0xDFFF) // NOLINT
+                    return ch;
+                if (ch <= 0xDBFF && p != end && *p >= 0xDC00 && *p <= 0xDFFF) // NOLINT
+                    return ((static_cast<char32_t>(ch) - 0xD800) << 10) + (*p++ - 0xDC00) + 0x10000; // NOLINT
+                valid = false;
+                return replacement_char;
+            }
 
+            inline char32_t decode(const char32_t*& p, const char32_t*, bool& valid)
+            {
+                char32_t ch = *p++;
+                if ((ch >= 0xD800 && ch <= 0xDFFF) || ch > 0x10FFFF) // NOLINT
+                {
+                    valid = false;
+                    return replacement_char;
+                }
+                return ch;
+            }
 
-        std::wstring u16_to_w(const char16_t* str, size_t str_len)
-        {
-            if (str == nullptr || str_len == 0)
-                return std::wstring();
+            inline size_t encoded_length(char32_t cp, char)
+            {
+                return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4; // NOLINT
+            }
 
-            if (str_len == std::wstring::npos)
-                str_len = std::char_traits<char16_t>::length(str);
+            inline size_t encoded_length(char32_t cp, char16_t)
+            {
+                return cp < 0x10000 ? 1 : 2; // NOLINT
+            }
 
-            if (sizeof(wchar_t) == 2)
-                return std::wstring(reinterpret_cast<const wchar_t*>(str), find_len(str, str_len));
+            inline size_t encoded_length(char32_t, char32_t)
+            {
+                return 1;
+            }
+
+            inline char* encode(char32_t cp, char* out)
+            {
+                if (cp < 0x80) // NOLINT
+                    *out++ = static_cast<char>(cp);
+                else if (cp < 0x800) // NOLINT
+                {
+                    *out++ = static_cast<char>(0xC0 | (cp >> 6)); // NOLINT
+                    *out++ = static_cast<char>(0x80 | (cp & 0x3F)); // NOLINT
+                }
+                else if (cp < 0x10000) // NOLINT
+                {
+                    *out++ = static_cast<char>(0xE0 | (cp >> 12)); // NOLINT
+                    *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F)); // NOLINT
+                    *out++ = static_cast<char>(0x80 | (cp & 0x3F)); // NOLINT
+                }
+                else
+                {
+                    *out++ = static_cast<char>(0xF0 | (cp >> 18)); // NOLINT
+                    *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F)); // NOLINT
+                    *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F)); // NOLINT
+                    *out++ = static_cast<char>(0x80 | (cp & 0x3F)); // NOLINT
+                }
+                return out;
+            }
+
+            inline char16_t* encode(char32_t cp, char16_t* out)
+            {
+                if (cp < 0x10000) // NOLINT
+                    *out++ = static_cast<char16_t>(cp);
+                else
+                {
+                    *out++ = static_cast<char16_t>(0xD800 + ((cp - 0x10000) >> 10)); // NOLINT
+                    *out++ = static_cast<char16_t>(0xDC00 + ((cp - 0x10000) & 0x3FF)); // NOLINT
+                }
+                return out;
+            }
+
+            inline char32_t* encode(char32_t cp, char32_t* out)
+            {
+                *out++ = cp;
+                return out;
+            }
+
+            // ---------------------------------------------------------------------------------------------
+            // Output sizing. unit_length is what one source code unit contributes to the output when the
+            // input is well-formed: a UTF-8 lead byte or UTF-16 high surrogate is charged for the whole
+            // sequence and the units that follow it for nothing. The per-unit counts have no branches, so
+            // the sizing loop vectorizes.
+            // ---------------------------------------------------------------------------------------------
+
+            inline size_t unit_length(unsigned char, char)
+            {
+                return 1;
+            }
+
+            inline size_t unit_length(unsigned char b, char16_t)
+            {
+                return static_cast<size_t>((b & 0xC0) != 0x80) + static_cast<size_t>(b >= 0xF0); // NOLINT
+            }
 
-            std::wstring result;
-            for (size_t i = 0; i < str_len; ++i)
+            inline size_t unit_length(unsigned char b, char32_t)
             {
-                char16_t ch = str[i];
-                if (ch == 0)
-                    break;
-                if (ch >= 0xD800 && ch <= 0xDBFF && i + 1 < str_len) // NOLINT
+                return static_cast<size_t>((b & 0xC0) != 0x80); // NOLINT
+            }
+
+            inline size_t unit_length(char16_t u, char)
+            {
+                size_t surrogate = static_cast<size_t>((u & 0xF800) == 0xD800); // NOLINT
+                size_t high = static_cast<size_t>((u & 0xFC00) == 0xD800); // NOLINT
+                size_t bmp = 1 + static_cast<size_t>(u >= 0x80) + static_cast<size_t>(u >= 0x800); // NOLINT
+                return bmp * (1 - surrogate) + 4 * high; // NOLINT
+            }
+
+            inline size_t unit_length(char16_t, char16_t)
+            {
+                return 1;
+            }
+
+            inline size_t unit_length(char16_t u, char32_t)
+            {
+                return static_cast<size_t>((u & 0xFC00) != 0xDC00); // NOLINT
+            }
+
+            inline size_t unit_length(char32_t u, char)
+            {
+                return 1 + static_cast<size_t>(u >= 0x80) + static_cast<size_t>(u >= 0x800) + static_cast<size_t>(u >= 0x10000); // NOLINT
+            }
+
+            inline size_t unit_length(char32_t u, char16_t)
+            {
+                return 1 + static_cast<size_t>(u >= 0x10000); // NOLINT
+            }
+
+            inline size_t unit_length(char32_t, char32_t)
+            {
+                return 1;
+            }
+
+            template <typename S, typename D>
+            size_t estimate_length_scalar(const S* str, size_t len)
+            {
+                typedef typename std::conditional<std::is_same<S, char>::value, unsigned char, S>::type unsigned_t;
+                auto units = reinterpret_cast<const unsigned_t*>(str);
+                size_t result = 0;
+                for (size_t i = 0; i < len; ++i)
+                    result += unit_length(units[i], D());
+                return result;
+            }
+
+#if defined(DOCFILTERS_STRINGS_SSE2)
+            // Per-lane lengths from comparison masks (-1 where true), summed in 16 or 32 bit lanes and folded into
+            // the total before a lane can overflow
+            inline size_t sum_u16_lanes(__m128i acc)
+            {
+                __m128i pairs = _mm_madd_epi16(acc, _mm_set1_epi16(1));
+                alignas(16) uint32_t lanes[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes), pairs);
+                return static_cast<size_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+            }
+
+            inline size_t sum_u32_lanes(__m128i acc)
+            {
+                alignas(16) uint32_t lanes[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+                return static_cast<size_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+            }
+
+            template <typename D>
+            size_t estimate_vector(const char* str, size_t len, size_t& i)
+            {
+                const __m128i not_continuation = _mm_set1_epi8(static_cast<char>(0xBF)); // signed: bytes above it are leads or ASCII
+                const __m128i four_byte_lead = _mm_set1_epi8(static_cast<char>(0xEF)); // signed: 0xF0 to 0xFF, and ASCII
+                const __m128i zero = _mm_setzero_si128();
+                size_t result = 0;
+                while (i + 16 <= len)
                 {
-                    char16_t lowSurrogate = str[i + 1];
-                    if (lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF) // NOLINT
+                    // Byte lanes hold at most 2 per round, so fold them into 64 bit sums every 127 rounds
+                    __m128i acc = _mm_setzero_si128();
+                    for (size_t rounds = 0; rounds < 127 && i + 16 <= len; ++rounds, i += 16)
                     {
-                        uint32_t codepoint = ((ch - 0xD800) << 10) + (lowSurrogate - 0xDC00) + 0x10000; // NOLINT
-                        result.push_back(static_cast<wchar_t>(codepoint));
-                        ++i;
-                        continue;
+                        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+                        acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(v, not_continuation));
+                        if (sizeof(D) == 2)
+                            acc = _mm_sub_epi8(acc, _mm_and_si128(_mm_cmpgt_epi8(v, four_byte_lead), _mm_cmplt_epi8(v, zero)));
                     }
+                    __m128i sums = _mm_sad_epu8(acc, zero);
+                    alignas(16) uint64_t lanes[2];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), sums);
+                    result += static_cast<size_t>(lanes[0] + lanes[1]);
                 }
-                result.push_back(static_cast<wchar_t>(ch));
+                return result;
             }
-            return result;
-        }
 
-        std::string u16_to_u8(const char16_t* str, size_t str_len)
-        {
-            if (str == nullptr || str_len == 0)
-                return std::string();
-            if (str_len == std::wstring::npos)
-                str_len = std::char_traits<char16_t>::length(str);
-            std::string result;
-            for (size_t i = 0; i < str_len; ++i)
+            template <typename D>
+            size_t estimate_vector(const char16_t* str, size_t len, size_t& i)
             {
-                char16_t ch = str[i];
-                if (ch == 0)
-                    break;
-                if (ch >= 0xD800 && ch <= 0xDBFF && i + 1 < str_len) // NOLINT
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i surrogate_bits = _mm_set1_epi16(static_cast<short>(0xF800));
+                const __m128i surrogate_half = _mm_set1_epi16(static_cast<short>(0xFC00));
+                const __m128i high = _mm_set1_epi16(static_cast<short>(0xD800));
+                const __m128i low = _mm_set1_epi16(static_cast<short>(0xDC00));
+                size_t result = 0;
+                while (i + 8 <= len)
                 {
-                    char16_t lowSurrogate = str[i + 1];
-                    if (lowSurrogate >= 0xDC00 && lowSurrogate <= 0xDFFF) // NOLINT
+                    // 16 bit lanes hold at most 4 per round
+                    __m128i acc = zero;
+                    for (size_t rounds = 0; rounds < 8191 && i + 8 <= len; ++rounds, i += 8)
                     {
-                        uint32_t codepoint = ((ch - 0xD800) << 10) + (lowSurrogate - 0xDC00) + 0x10000; // NOLINT
-                        if (codepoint <= 0x7F) // NOLINT
-                            result.push_back(static_cast<char>(codepoint));
-                        else if (codepoint <= 0x7FF) // NOLINT
+                        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+                        __m128i is_low = _mm_cmpeq_epi16(_mm_and_si128(v, surrogate_half), low);
+                        if (sizeof(D) == 1)
                         {
-                            result.push_back(static_cast<char>(0xC0 | (codepoint >> 6))); // NOLINT
-                            result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F))); // NOLINT
+                            // 3 bytes for anything from U+0800, less one below U+0800 and one more below U+0080;
+                            // a high surrogate is charged 4 for the pair and a low surrogate nothing
+                            __m128i below_80 = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80))), zero);
+                            __m128i below_800 = _mm_cmpeq_epi16(_mm_and_si128(v, surrogate_bits), zero);
+                            __m128i is_high = _mm_cmpeq_epi16(_mm_and_si128(v, surrogate_half), high);
+                            __m128i lane = _mm_add_epi16(_mm_set1_epi16(3), _mm_add_epi16(below_80, below_800));
+                            lane = _mm_sub_epi16(lane, is_high);
+                            lane = _mm_add_epi16(lane, _mm_add_epi16(is_low, _mm_add_epi16(is_low, is_low)));
+                            acc = _mm_add_epi16(acc, lane);
                         }
-                        else if (codepoint <= 0xFFFF) // NOLINT
+                        else
+                            acc = _mm_add_epi16(acc, _mm_add_epi16(_mm_set1_epi16(1), is_low));
+                    }
+                    result += sum_u16_lanes(acc);
+                }
+                return result;
+            }
+
+            template <typename D>
+            size_t estimate_vector(const char32_t* str, size_t len, size_t& i)
+            {
+                // SSE2 only compares signed values, so flip the sign bit on both sides to compare them unsigned
+                const __m128i sign = _mm_set1_epi32(static_cast<int>(0x80000000));
+                size_t result = 0;
+                while (i + 4 <= len)
+                {
+                    __m128i acc = _mm_setzero_si128();
+                    for (size_t rounds = 0; rounds < 65536 && i + 4 <= len; ++rounds, i += 4)
+                    {
+                        __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i)), sign);
+                        __m128i below_10000 = _mm_cmplt_epi32(v, _mm_set1_epi32(static_cast<int>(0x80010000)));
+                        if (sizeof(D) == 1)
                         {
-                            result.push_back(static_cast<char>(0xE0 | (codepoint >> 12))); // NOLINT
-                            result.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F))); // NOLINT
-                            result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F))); // NOLINT
+                            __m128i below_80 = _mm_cmplt_epi32(v, _mm_set1_epi32(static_cast<int>(0x80000080)));
+                            __m128i below_800 = _mm_cmplt_epi32(v, _mm_set1_epi32(static_cast<int>(0x80000800)));
+                            acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_set1_epi32(4), _mm_add_epi32(below_10000, _mm_add_epi32(below_80, below_800))));
                         }
                         else
+                            acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_set1_epi32(2), below_10000));
+                    }
+                    result += sum_u32_lanes(acc);
+                }
+                return result;
+            }
+#elif defined(DOCFILTERS_STRINGS_NEON)
+            template <typename D>
+            size_t estimate_vector(const char* str, size_t len, size_t& i)
+            {
+                size_t result = 0;
+                for (; i + 16 <= len; i += 16)
+                {
+                    int8x16_t v = vld1q_s8(reinterpret_cast<const int8_t*>(str + i));
+                    uint8x16_t lane = vshrq_n_u8(vcgtq_s8(v, vdupq_n_s8(-65)), 7);
+                    if (sizeof(D) == 2)
+                        lane = vaddq_u8(lane, vshrq_n_u8(vcgtq_s8(v, vdupq_n_s8(-17)), 7));
+                    result += vaddlvq_u8(lane);
+                }
+                return result;
+            }
+
+            template <typename D, typename S>
+            size_t estimate_vector(const S*, size_t, size_t&)
+            {
+                return 0;
+            }
+#endif
+
+            template <typename S, typename D>
+            size_t estimate_length(const S* str, size_t len)
+            {
+                size_t i = 0;
+                size_t result = 0;
+                if (sizeof(S) != sizeof(D))
+                {
+#if defined(DOCFILTERS_STRINGS_SSE2) || defined(DOCFILTERS_STRINGS_NEON)
+                    result = estimate_vector<D>(str, len, i);
+#endif
+                }
+                return result + estimate_length_scalar<S, D>(str + i, len - i);
+            }
+
+            // Exact output length for any input, charging U+FFFD for every ill-formed sequence
+            template <typename S, typename D>
+            size_t measure(const S* str, size_t len)
+            {
+                const S* p = str;
+                const S* end = str + len;
+                size_t result = 0;
+                bool valid = true;
+                while (p != end)
+                {
+                    if (is_direct<S, D>(*p))
+                    {
+                        size_t direct = direct_length<S, D>(p, static_cast<size_t>(end - p));
+                        p += direct;
+                        result += direct;
+                        continue;
+                    }
+                    result += encoded_length(decode(p, end, valid), D());
+                }
+                return result;
+            }
+
+            inline bool is_stripped(uint32_t unit)
+            {
+                return (unit >= 0x01 && unit <= 0x08) || (unit >= 0x0B && unit <= 0x10 && unit != 0x0E); // NOLINT
+            }
+
+            // Converts str into out. With `strict` set this gives up and returns nullptr at the first
+            // ill-formed sequence, which is what keeps estimate_length a safe bound for the output.
+            template <typename S, typename D, typename M = plain_t>
+            D* transcode(const S* str, size_t len, D* out, bool strict)
+            {
+                const S* p = str;
+                const S* end = str + len;
+                bool valid = true;
+                while (p != end)
+                {
+                    if (is_direct<S, D, M>(*p))
+                    {
+                        size_t direct = direct_length<S, D, M>(p, static_cast<size_t>(end - p));
+                        copy_direct<S, D, M>(p, direct, out);
+                        p += direct;
+                        out += direct;
+                        continue;
+                    }
+
+                    char32_t cp;
+                    if (M::strip && static_cast<uint32_t>(*p) < 0x20) // NOLINT
+                    {
+                        // Same mapping as Extractor::getText: \xE becomes a new line, \x01-\x08 and \x0B-\x10 are dropped
+                        cp = static_cast<char32_t>(*p++);
+                        if (cp == 0x0E) // NOLINT
+                            cp = U'\n';
+                        else if (is_stripped(cp))
+                            continue;
+                    }
+                    else if (M::strip && sizeof(S) == 2 && static_cast<uint32_t>(*p) >= 0xD800 && static_cast<uint32_t>(*p) <= 0xDBFF) // NOLINT
+                    {
+                        // getText strips before anything is decoded, so a pair split only by stripped characters still joins up
+                        const S* low = p + 1;
+                        while (low != end && is_stripped(static_cast<uint32_t>(*low)))
+                            ++low;
+                        if (low != end && static_cast<uint32_t>(*low) >= 0xDC00 && static_cast<uint32_t>(*low) <= 0xDFFF) // NOLINT
                         {
-                            result.push_back(static_cast<char>(0xF0 | (codepoint >> 18))); // NOLINT
-                            result.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F))); // NOLINT
-                            result.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F))); // NOLINT
-                            result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F))); // NOLINT
+                            cp = ((static_cast<char32_t>(*p) - 0xD800) << 10) + (static_cast<char32_t>(*low) - 0xDC00) + 0x10000; // NOLINT
+                            p = low + 1;
                         }
-                        i++;
-                        continue;
+                        else
+                        {
+                            cp = replacement_char;
+                            ++p;
+                            valid = false;
+                            if (strict)
+                                return nullptr;
+                        }
+                    }
+                    else
+                    {
+                        cp = decode(p, end, valid);
+                        if (!valid && strict)
+                            return nullptr;
+                    }
+
+                    D* first = out;
+                    out = encode(cp, out);
+                    if (M::swap)
+                    {
+                        for (D* unit = first; unit != out; ++unit)
+                            *unit = swap_unit(*unit);
                     }
                 }
-                if (ch <= 0x7F) // NOLINT
-                    result.push_back(static_cast<char>(ch));
-                else if (ch <= 0x7FF) // NOLINT
+                return out;
+            }
+
+            // Appends the conversion of str to dest, stopping at a zero code unit unless `stop_at_zero` is off.
+            // Well-formed input (the usual case) is sized by estimate_length and converted in a single pass;
+            // anything else is measured exactly and converted again with replacement characters. Stripping
+            // only ever shortens the output, so both sizes remain bounds when M strips.
+            template <typename M = plain_t, typename R, typename S>
+            void append_transcoded(R& dest, const S* str, size_t str_len, bool stop_at_zero = true)
+            {
+                typedef typename std::conditional<sizeof(typename R::value_type) == 1, char,
+                    typename std::conditional<sizeof(typename R::value_type) == 2, char16_t, char32_t>::type>::type unit_t;
+
+                if (str == nullptr || str_len == 0)
+                    return;
+                if (str_len == std::wstring::npos)
+                    str_len = std::char_traits<S>::length(str);
+                else if (stop_at_zero)
+                    str_len = find_len(str, str_len);
+                if (str_len == 0)
+                    return;
+
+                size_t start = dest.size();
+                dest.resize(start + estimate_length<S, unit_t>(str, str_len));
+                auto out = reinterpret_cast<unit_t*>(&dest[0] + start);
+                auto last = transcode<S, unit_t, M>(str, str_len, out, true);
+                if (last == nullptr)
                 {
-                    result.push_back(static_cast<char>(0xC0 | (ch >> 6))); // NOLINT
-                    result.push_back(static_cast<char>(0x80 | (ch & 0x3F))); // NOLINT
+                    dest.resize(start + measure<S, unit_t>(str, str_len));
+                    out = reinterpret_cast<unit_t*>(&dest[0] + start);
+                    last = transcode<S, unit_t, M>(str, str_len, out, false);
                 }
+                dest.resize(start + static_cast<size_t>(last - out));
+            }
+
+            template <typename R>
+            void append_encoded(R& dest, const char16_t* str, size_t str_len, bool strip, bool swap)
+            {
+                if (strip && swap)
+                    append_transcoded<output_mode_t<true, true>>(dest, str, str_len);
+                else if (strip)
+                    append_transcoded<output_mode_t<true, false>>(dest, str, str_len);
+                else if (swap)
+                    append_transcoded<output_mode_t<false, true>>(dest, str, str_len);
                 else
+                    append_transcoded(dest, str, str_len);
+            }
+
+            // ---------------------------------------------------------------------------------------------
+            // UTF-16 to UTF-16: code units are passed through as they are, unpaired surrogates included,
+            // so only control characters need looking at. Runs without any are copied (and byte swapped)
+            // a vector at a time.
+            // ---------------------------------------------------------------------------------------------
+
+            inline size_t control_free_length(const char16_t* str, size_t len)
+            {
+                size_t i = 0;
+#if defined(DOCFILTERS_STRINGS_SSE2)
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i high = _mm_set1_epi16(static_cast<short>(0xFFE0));
+                for (; i + 8 <= len; i += 8)
+                {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+                    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, high), zero)));
+                    if (mask != 0)
+                        return i + count_trailing_zeros(mask) / 2;
+                }
+#elif defined(DOCFILTERS_STRINGS_NEON)
+                for (; i + 8 <= len; i += 8)
                 {
-                    result.push_back(static_cast<char>(0xE0 | (ch >> 12))); // NOLINT
-                    result.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F))); // NOLINT
-                    result.push_back(static_cast<char>(0x80 | (ch & 0x3F))); // NOLINT
+                    uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t*>(str + i));
+                    if (vminvq_u16(v) < 0x20)
+                        break;
                 }
+#endif
+                while (i < len && static_cast<uint32_t>(str[i]) >= 0x20) // NOLINT
+                    ++i;
+                return i;
             }
-            return result;
+
+            template <typename M>
+            void copy_units(const char16_t* src, size_t len, char16_t* dest)
+            {
+                if (!M::swap)
+                {
+                    memcpy(dest, src, len * sizeof(char16_t));
+                    return;
+                }
+
+                size_t i = 0;
+#if defined(DOCFILTERS_STRINGS_SSE2)
+                for (; i + 8 <= len; i += 8)
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), swap_lanes<char16_t, M>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+#elif defined(DOCFILTERS_STRINGS_NEON)
+                for (; i + 8 <= len; i += 8)
+                    vst1q_u16(reinterpret_cast<uint16_t*>(dest + i), swap_lanes<M>(vld1q_u16(reinterpret_cast<const uint16_t*>(src + i))));
+#endif
+                for (; i < len; ++i)
+                    dest[i] = swap_unit(src[i]);
+            }
+
+            template <typename M>
+            void append_units(std::u16string& dest, const char16_t* str, size_t str_len)
+            {
+                size_t start = dest.size();
+                dest.resize(start + str_len);
+                char16_t* first = &dest[start];
+                char16_t* out = first;
+                for (size_t i = 0; i < str_len;)
+                {
+                    size_t run = M::strip ? control_free_length(str + i, str_len - i) : str_len - i;
+                    copy_units<M>(str + i, run, out);
+                    out += run;
+                    i += run;
+                    if (i == str_len)
+                        break;
+
+                    // Same mapping as Extractor::getText: \xE becomes a new line, \x01-\x08 and \x0B-\x10 are dropped
+                    char16_t unit = str[i++];
+                    if (unit == u'\xE')
+                        unit = u'\n';
+                    else if (is_stripped(unit))
+                        continue;
+                    *out++ = M::swap ? swap_unit(unit) : unit;
+                }
+                dest.resize(start + static_cast<size_t>(out - first));
+            }
+
+            template <typename R, typename S>
+            R transcoded(const S* str, size_t str_len)
+            {
+                R result;
+                append_transcoded(result, str, str_len);
+                return result;
+            }
+
+        } // namespace
+
+        std::wstring u16_to_w(const char16_t* str, size_t str_len)
+        {
+            if (str == nullptr || str_len == 0)
+                return std::wstring();
+
+            if (str_len == std::wstring::npos)
+                str_len = std::char_traits<char16_t>::length(str);
+
+            // Wide strings are UTF-16 on Windows, where unpaired surrogates are kept as they are
+            if (sizeof(wchar_t) == 2)
+                return std::wstring(reinterpret_cast<const wchar_t*>(str), find_len(str, str_len));
+
+            return transcoded<std::wstring>(str, str_len);
+        }
+
+        void u16_append_u8(std::string& dest, const char16_t* str, size_t str_len)
+        {
+            append_transcoded(dest, str, str_len);
+        }
+
+        void u16_append_encoded(std::string& dest, const char16_t* str, size_t str_len, bool strip_control_chars)
+        {
+            append_encoded(dest, str, str_len, strip_control_chars, false);
+        }
+
+        void u16_append_encoded(std::u16string& dest, const char16_t* str, size_t str_len, bool strip_control_chars, bool swap_bytes)
+        {
+            if (str == nullptr || str_len == 0)
+                return;
+            if (strip_control_chars && swap_bytes)
+                append_units<output_mode_t<true, true>>(dest, str, str_len);
+            else if (strip_control_chars)
+                append_units<output_mode_t<true, false>>(dest, str, str_len);
+            else if (swap_bytes)
+                append_units<output_mode_t<false, true>>(dest, str, str_len);
+            else
+                dest.append(str, str_len);
+        }
+
+        void u16_append_encoded(std::u32string& dest, const char16_t* str, size_t str_len, bool strip_control_chars, bool swap_bytes)
+        {
+            append_encoded(dest, str, str_len, strip_control_chars, swap_bytes);
+        }
+
+        std::string u16_to_u8(const char16_t* str, size_t str_len)
+        {
+            return transcoded<std::string>(str, str_len);
         }
 
         std::u32string u8_to_u32(const char* str, size_t str_len)
         {
-            return u8_to_uX<std::u32string>(str, str_len);
+            return transcoded<std::u32string>(str, str_len);
         }
 
         std::u16string u8_to_u16(const char* str, size_t str_len)
         {
-            return u8_to_uX<std::u16string>(str, str_len);
+            return transcoded<std::u16string>(str, str_len);
         }
 
         std::wstring u8_to_w(const char* str, size_t str_len)
         {
-            return u8_to_uX<std::wstring>(str, str_len);
+            return transcoded<std::wstring>(str, str_len);
         }
 
         std::u16string w_to_u16(const wchar_t* str, size_t str_len)
@@ -194,83 +1077,21 @@ namespace Hyland
             if (sizeof(wchar_t) == 2)
                 return std::u16string(reinterpret_cast<const char16_t*>(str), str_len);
 
-            std::u16string result;
-
-            for (size_t i = 0; i < str_len; ++i)
-            {
-                wchar_t ch = str[i];
-                if (ch == 0)
-                    break;
-                if (ch <= 0xFFFF) // NOLINT
-                    result.push_back(static_cast<char16_t>(ch));
-                else
-                {
-                    uint32_t codepoint = ch - 0x10000; // NOLINT
-                    char16_t highSurrogate = static_cast<char16_t>((codepoint >> 10) + 0xD800); // NOLINT
-                    char16_t lowSurrogate = static_cast<char16_t>((codepoint & 0x3FF) + 0xDC00); // NOLINT
-                    result.push_back(highSurrogate);
-                    result.push_back(lowSurrogate);
-                }
-            }
-
-            return result;
+            return transcoded<std::u16string>(reinterpret_cast<const wide_unit_t*>(str), str_len);
         }
+
         std::string w_to_u8(const wchar_t* str, size_t str_len)
         {
-            if (str == nullptr || str_len == 0)
-                return std::string();
-            if (str_len == std::wstring::npos)
-                str_len = std::char_traits<wchar_t>::length(str);
-            std::string result;
-            for (size_t i = 0; i < str_len; ++i)
-            {
-                wchar_t ch = str[i];
-                if (ch == 0)
-                    break;
-                if (ch <= 0x7F) // NOLINT
-                    result.push_back(static_cast<char>(ch));
-                else if (ch <= 0x7FF) // NOLINT
-                {
-                    result.push_back(static_cast<char>(0xC0 | (ch >> 6))); // NOLINT
-                    result.push_back(static_cast<char>(0x80 | (ch & 0x3F))); // NOLINT
-                }
-                else if (ch <= 0xFFFF) // NOLINT
-                {
-                    result.push_back(static_cast<char>(0xE0 | (ch >> 12))); // NOLINT
-                    result.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F))); // NOLINT
-                    result.push_back(static_cast<char>(0x80 | (ch & 0x3F))); // NOLINT
-                }
-                else
-                {
-                    uint32_t codepoint = ch - 0x10000; // NOLINT
-                    char16_t highSurrogate = static_cast<char16_t>((codepoint >> 10) + 0xD800); // NOLINT
-                    char16_t lowSurrogate = static_cast<char16_t>((codepoint & 0x3FF) + 0xDC00); // NOLINT
-                    result.push_back(static_cast<char>(highSurrogate)); 
-                    result.push_back(static_cast<char>(lowSurrogate));
-                }
-            }
-            return result;
+            return transcoded<std::string>(reinterpret_cast<const wide_unit_t*>(str), str_len);
         }
 
         std::u32string w_to_u32(const std::wstring& wstr)
         {
-            std::u32string result;
             if (sizeof(wchar_t) == sizeof(char32_t))
                 return std::u32string(reinterpret_cast<const char32_t*>(wstr.c_str()), wstr.size());
 
-            for (const auto& ch : wstr)
-            {
-                if (ch <= 0xFFFF) // NOLINT
-                    result.push_back(static_cast<char32_t>(ch));
-                else
-                {
-                    uint32_t codepoint = ch - 0x10000; // NOLINT
-                    char32_t highSurrogate = static_cast<char32_t>((codepoint >> 10) + 0xD800); // NOLINT
-                    char32_t lowSurrogate = static_cast<char32_t>((codepoint & 0x3FF) + 0xDC00); // NOLINT
-                    result.push_back(highSurrogate);
-                    result.push_back(lowSurrogate);
-                }
-            }
+            std::u32string result;
+            append_transcoded(result, reinterpret_cast<const wide_unit_t*>(wstr.c_str()), wstr.size(), false);
             return result;
         }
 
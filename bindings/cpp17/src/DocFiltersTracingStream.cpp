@@ -0,0 +1,211 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		namespace
+		{
+			size_t histogram_bucket(uint64_t value)
+			{
+				size_t bucket = 0;
+				while (value != 0)
+				{
+					++bucket;
+					value >>= 1;
+				}
+				return bucket;
+			}
+		} // namespace
+
+		class TracingStream::impl_t
+		{
+		public:
+			typedef std::chrono::steady_clock clock_t;
+
+			Stream* m_stream;
+			bool m_own;
+
+			mutable std::mutex m_lock;
+			std::vector<IoTraceEvent> m_ring; // preallocated; m_next wraps around once full
+			size_t m_next = 0;
+			uint64_t m_recorded = 0;
+			clock_t::time_point m_start;
+
+			IoTraceStats m_stats;
+			std::map<uint64_t, uint64_t> m_ranges; // start -> end of the merged ranges read so far
+			int64_t m_position = 0;
+			int64_t m_last_read_end = -1;
+			uint64_t m_size = 0;
+
+			impl_t(Stream* stream, bool own, const Options& options)
+				: m_stream(stream), m_own(own), m_ring(options.capacity), m_start(clock_t::now())
+			{
+				if (m_stream == nullptr)
+					throw std::invalid_argument("stream cannot be null");
+				m_position = std::max<int64_t>(0, m_stream->seek(0, std::ios::cur));
+				m_size = static_cast<uint64_t>(std::max<std::streamoff>(0, m_stream->getSize()));
+			}
+
+			~impl_t()
+			{
+				if (m_own)
+					delete m_stream;
+			}
+
+			void record(IoTraceEvent::Kind kind, uint64_t offset, uint64_t length, uint64_t requested)
+			{
+				++m_recorded;
+				if (m_ring.empty())
+					return;
+
+				auto& event = m_ring[m_next];
+				event.kind = kind;
+				event.offset = offset;
+				event.length = length;
+				event.requested = requested;
+				event.timestamp_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - m_start).count());
+				event.thread = std::this_thread::get_id();
+				m_next = (m_next + 1) % m_ring.size();
+			}
+
+			void add_range(uint64_t start, uint64_t end)
+			{
+				auto it = m_ranges.upper_bound(start);
+				if (it != m_ranges.begin())
+				{
+					auto prev = std::prev(it);
+					if (prev->second >= start)
+					{
+						if (prev->second >= end)
+							return;
+						start = prev->first;
+						m_stats.unique_bytes -= prev->second - prev->first;
+						it = m_ranges.erase(prev);
+					}
+				}
+				while (it != m_ranges.end() && it->first <= end)
+				{
+					end = std::max(end, it->second);
+					m_stats.unique_bytes -= it->second - it->first;
+					it = m_ranges.erase(it);
+				}
+				m_ranges.emplace(start, end);
+				m_stats.unique_bytes += end - start;
+			}
+
+			std::streamoff seek(std::streampos offset, std::ios_base::seekdir way)
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				std::streamoff result = m_stream->seek(offset, way);
+				++m_stats.seeks;
+				record(IoTraceEvent::Kind::Seek, static_cast<uint64_t>(m_position), static_cast<uint64_t>(std::max<std::streamoff>(result, 0)), 0);
+				if (result >= 0)
+					m_position = result;
+				return result;
+			}
+
+			size_t read(void* buffer, size_t size)
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				size_t bytes = m_stream->read(buffer, size);
+				uint64_t offset = static_cast<uint64_t>(m_position);
+				m_position += static_cast<int64_t>(bytes);
+
+				++m_stats.reads;
+				m_stats.bytes_read += bytes;
+				++m_stats.read_sizes[histogram_bucket(bytes)];
+				if (m_last_read_end == static_cast<int64_t>(offset))
+					++m_stats.sequential_reads;
+				else if (m_last_read_end >= 0)
+				{
+					int64_t distance = static_cast<int64_t>(offset) - m_last_read_end;
+					++m_stats.seek_distances[histogram_bucket(static_cast<uint64_t>(distance < 0 ? -distance : distance))];
+				}
+				m_last_read_end = m_position;
+
+				if (bytes != 0)
+					add_range(offset, offset + bytes);
+				record(IoTraceEvent::Kind::Read, offset, bytes, size);
+				return bytes;
+			}
+
+			IoTraceStats stats() const
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				IoTraceStats result = m_stats;
+				result.stream_size = m_size;
+
+				size_t count = static_cast<size_t>(std::min<uint64_t>(m_recorded, m_ring.size()));
+				result.dropped_events = m_recorded - count;
+				result.events.reserve(count);
+				size_t first = count < m_ring.size() ? 0 : m_next;
+				for (size_t i = 0; i < count; ++i)
+					result.events.push_back(m_ring[(first + i) % m_ring.size()]);
+				return result;
+			}
+
+			void reset()
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				m_stats = IoTraceStats();
+				m_ranges.clear();
+				m_next = 0;
+				m_recorded = 0;
+				m_last_read_end = -1;
+				m_start = clock_t::now();
+			}
+		};
+
+		TracingStream::TracingStream(Stream* stream, bool own_stream, const Options& options)
+			: m_impl(std::make_unique<impl_t>(stream, own_stream, options))
+		{
+		}
+
+		TracingStream::~TracingStream() = default;
+
+		std::streamoff TracingStream::seek(std::streampos offset, std::ios_base::seekdir way)
+		{
+			return m_impl->seek(offset, way);
+		}
+
+		size_t TracingStream::read(void* buffer, size_t size)
+		{
+			return m_impl->read(buffer, size);
+		}
+
+		std::unique_ptr<Stream> TracingStream::get_stream_part(const std::wstring& part_name, const std::wstring& full_name, int index)
+		{
+			return m_impl->m_stream->get_stream_part(part_name, full_name, index);
+		}
+
+		IoTraceStats TracingStream::getStats() const
+		{
+			return m_impl->stats();
+		}
+
+		void TracingStream::reset()
+		{
+			m_impl->reset();
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
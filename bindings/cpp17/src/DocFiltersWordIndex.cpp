@@ -0,0 +1,330 @@
+/*
+# (c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "DocumentFiltersObjects.h"
+#include "DocFiltersCommon.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace Hyland
+{
+	namespace DocFilters
+	{
+		namespace
+		{
+			/** Distances are capped so that adding two squares cannot overflow; nothing on a page is this far apart. */
+			const int64_t max_distance = (int64_t(1) << 30) - 1;
+
+			/** Squared distance from a point to the nearest unit of a half-open box. */
+			int64_t distance_squared(int64_t x, int64_t y, int64_t left, int64_t top, int64_t right, int64_t bottom)
+			{
+				int64_t dx = std::min(x < left ? left - x : (x >= right ? x - right + 1 : 0), max_distance);
+				int64_t dy = std::min(y < top ? top - y : (y >= bottom ? y - bottom + 1 : 0), max_distance);
+				return dx * dx + dy * dy;
+			}
+
+			int32_t clamp_to_int32(int64_t value)
+			{
+				return static_cast<int32_t>(std::clamp<int64_t>(value, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()));
+			}
+		} // namespace
+
+		WordIndex::WordIndex(const WordTable& table)
+			: WordIndex(table.getX(), table.getY(), table.getWidth(), table.getHeight())
+		{
+		}
+
+		WordIndex::WordIndex(span_t<const int32_t> x, span_t<const int32_t> y, span_t<const int32_t> width, span_t<const int32_t> height)
+		{
+			if (y.size() != x.size() || width.size() != x.size() || height.size() != x.size())
+				throw std::invalid_argument("columns must be the same size");
+			if (x.size() >= std::numeric_limits<uint32_t>::max())
+				throw std::invalid_argument("too many words");
+
+			m_left.resize(x.size());
+			m_top.resize(x.size());
+			m_right.resize(x.size());
+			m_bottom.resize(x.size());
+			for (size_t i = 0; i < x.size(); ++i)
+			{
+				m_left[i] = x[i];
+				m_top[i] = y[i];
+				m_right[i] = clamp_to_int32(static_cast<int64_t>(x[i]) + std::max(width[i], 1));
+				m_bottom[i] = clamp_to_int32(static_cast<int64_t>(y[i]) + std::max(height[i], 1));
+			}
+			DoBuild();
+		}
+
+		void WordIndex::DoBuild()
+		{
+			const size_t count = m_left.size();
+			m_cell_start.assign(1, 0);
+			m_cell_words.clear();
+			if (count == 0)
+				return;
+
+			int64_t left = *std::min_element(m_left.begin(), m_left.end());
+			int64_t top = *std::min_element(m_top.begin(), m_top.end());
+			int64_t right = *std::max_element(m_right.begin(), m_right.end());
+			int64_t bottom = *std::max_element(m_bottom.begin(), m_bottom.end());
+			int64_t extent_x = std::max<int64_t>(right - left, 1);
+			int64_t extent_y = std::max<int64_t>(bottom - top, 1);
+
+			// Aim for about one cell per word, but never make a cell smaller than the average word, or each word
+			// would be listed in many cells.
+			double sum_width = 0;
+			double sum_height = 0;
+			for (size_t i = 0; i < count; ++i)
+			{
+				sum_width += static_cast<double>(m_right[i]) - m_left[i];
+				sum_height += static_cast<double>(m_bottom[i]) - m_top[i];
+			}
+			double columns = std::sqrt(static_cast<double>(count) * static_cast<double>(extent_x) / static_cast<double>(extent_y));
+			columns = std::clamp(columns, 1.0, static_cast<double>(count));
+			double rows = std::clamp(static_cast<double>(count) / columns, 1.0, static_cast<double>(count));
+
+			m_origin_x = static_cast<int32_t>(left);
+			m_origin_y = static_cast<int32_t>(top);
+			m_cell_width = std::max(static_cast<int64_t>(std::ceil(static_cast<double>(extent_x) / columns)), static_cast<int64_t>(sum_width / static_cast<double>(count)));
+			m_cell_height = std::max(static_cast<int64_t>(std::ceil(static_cast<double>(extent_y) / rows)), static_cast<int64_t>(sum_height / static_cast<double>(count)));
+			m_cell_width = std::max<int64_t>(m_cell_width, 1);
+			m_cell_height = std::max<int64_t>(m_cell_height, 1);
+			m_columns = static_cast<size_t>((extent_x + m_cell_width - 1) / m_cell_width);
+			m_rows = static_cast<size_t>((extent_y + m_cell_height - 1) / m_cell_height);
+
+			// Count the words of each cell, then lay the cells out one after another
+			m_first_column.resize(count);
+			m_last_column.resize(count);
+			m_first_row.resize(count);
+			m_last_row.resize(count);
+			std::vector<size_t> start(m_columns * m_rows + 1, 0);
+			for (size_t i = 0; i < count; ++i)
+			{
+				m_first_column[i] = static_cast<uint32_t>(DoColumn(m_left[i]));
+				m_last_column[i] = static_cast<uint32_t>(DoColumn(static_cast<int64_t>(m_right[i]) - 1));
+				m_first_row[i] = static_cast<uint32_t>(DoRow(m_top[i]));
+				m_last_row[i] = static_cast<uint32_t>(DoRow(static_cast<int64_t>(m_bottom[i]) - 1));
+				for (size_t r = m_first_row[i]; r <= m_last_row[i]; ++r)
+					for (size_t c = m_first_column[i]; c <= m_last_column[i]; ++c)
+						++start[r * m_columns + c + 1];
+			}
+			for (size_t cell = 1; cell < start.size(); ++cell)
+				start[cell] += start[cell - 1];
+			if (start.back() >= std::numeric_limits<uint32_t>::max())
+				throw std::invalid_argument("too many words");
+
+			m_cell_start.assign(start.begin(), start.end());
+			m_cell_words.resize(start.back());
+			for (size_t i = 0; i < count; ++i)
+			{
+				for (size_t r = m_first_row[i]; r <= m_last_row[i]; ++r)
+					for (size_t c = m_first_column[i]; c <= m_last_column[i]; ++c)
+						m_cell_words[start[r * m_columns + c]++] = static_cast<uint32_t>(i);
+			}
+		}
+
+		size_t WordIndex::DoColumn(int64_t x) const
+		{
+			if (x <= m_origin_x)
+				return 0;
+			return std::min(static_cast<size_t>((x - m_origin_x) / m_cell_width), m_columns - 1);
+		}
+
+		size_t WordIndex::DoRow(int64_t y) const
+		{
+			if (y <= m_origin_y)
+				return 0;
+			return std::min(static_cast<size_t>((y - m_origin_y) / m_cell_height), m_rows - 1);
+		}
+
+		std::vector<size_t> WordIndex::wordsInRect(const RectI32& rect) const
+		{
+			std::vector<size_t> result;
+			wordsInRect(rect, result);
+			return result;
+		}
+
+		void WordIndex::wordsInRect(const RectI32& rect, std::vector<size_t>& result) const
+		{
+			result.clear();
+			if (empty())
+				return;
+
+			int64_t left = std::min(rect.left, rect.right);
+			int64_t top = std::min(rect.top, rect.bottom);
+			int64_t right = std::max<int64_t>(std::max(rect.left, rect.right), left + 1);
+			int64_t bottom = std::max<int64_t>(std::max(rect.top, rect.bottom), top + 1);
+			if (right <= m_origin_x || bottom <= m_origin_y
+				|| left >= m_origin_x + m_cell_width * static_cast<int64_t>(m_columns)
+				|| top >= m_origin_y + m_cell_height * static_cast<int64_t>(m_rows))
+				return;
+
+			auto intersects = [&](size_t i) {
+				return m_left[i] < right && m_right[i] > left && m_top[i] < bottom && m_bottom[i] > top;
+			};
+
+			const size_t c0 = DoColumn(left), c1 = DoColumn(right - 1);
+			const size_t r0 = DoRow(top), r1 = DoRow(bottom - 1);
+			if ((c1 - c0 + 1) * (r1 - r0 + 1) * 4 >= m_columns * m_rows)
+			{
+				for (size_t i = 0; i < size(); ++i)
+				{
+					if (intersects(i))
+						result.push_back(i);
+				}
+				return;
+			}
+
+			for (size_t r = r0; r <= r1; ++r)
+			{
+				for (size_t c = c0; c <= c1; ++c)
+				{
+					// Every word listed in a cell inside the rectangle intersects it; only the cells along the
+					// edges need the words checked
+					const bool edge = c == c0 || c == c1 || r == r0 || r == r1;
+					const size_t cell = r * m_columns + c;
+					for (uint32_t k = m_cell_start[cell]; k < m_cell_start[cell + 1]; ++k)
+					{
+						const uint32_t i = m_cell_words[k];
+						// A word listed in several cells is reported only from the first of them within the rectangle
+						if ((c != c0 && m_first_column[i] != c) || (r != r0 && m_first_row[i] != r))
+							continue;
+						if (edge && !intersects(i))
+							continue;
+						result.push_back(i);
+					}
+				}
+			}
+
+			// The words were found cell by cell; put them back in reading order, through a bit per word when
+			// there are enough of them that sorting would cost more
+			if (result.size() * 256 < size())
+				std::sort(result.begin(), result.end());
+			else
+			{
+				std::vector<uint64_t> found((size() + 63) / 64, 0);
+				for (size_t i : result)
+					found[i / 64] |= uint64_t(1) << (i % 64);
+				result.clear();
+				for (size_t block = 0; block < found.size(); ++block)
+				{
+					size_t i = block * 64;
+					for (uint64_t bits = found[block]; bits != 0; bits >>= 1, ++i)
+					{
+						if (bits & 1)
+							result.push_back(i);
+					}
+				}
+			}
+		}
+
+		std::optional<size_t> WordIndex::nearestWord(int32_t x, int32_t y) const
+		{
+			auto words = nearestWords(x, y, 1);
+			if (words.empty())
+				return std::nullopt;
+			return words.front();
+		}
+
+		std::vector<size_t> WordIndex::nearestWords(int32_t x, int32_t y, size_t count) const
+		{
+			count = std::min(count, size());
+			if (count == 0)
+				return std::vector<size_t>();
+
+			// The best candidates so far, worst on top
+			typedef std::pair<int64_t, uint32_t> candidate_t;
+			std::priority_queue<candidate_t> best;
+
+			const int64_t cx = static_cast<int64_t>(DoColumn(x));
+			const int64_t cy = static_cast<int64_t>(DoRow(y));
+			const int64_t columns = static_cast<int64_t>(m_columns);
+			const int64_t rows = static_cast<int64_t>(m_rows);
+
+			auto visit = [&](int64_t c, int64_t r)
+			{
+				const size_t cell = static_cast<size_t>(r * columns + c);
+				for (uint32_t k = m_cell_start[cell]; k < m_cell_start[cell + 1]; ++k)
+				{
+					const uint32_t i = m_cell_words[k];
+					// A word spanning several cells is looked at only from its cell closest to the starting cell,
+					// which is the first of its cells the search reaches
+					int64_t wc = std::clamp<int64_t>(cx, m_first_column[i], m_last_column[i]);
+					int64_t wr = std::clamp<int64_t>(cy, m_first_row[i], m_last_row[i]);
+					if (wc != c || wr != r)
+						continue;
+
+					candidate_t candidate(distance_squared(x, y, m_left[i], m_top[i], m_right[i], m_bottom[i]), i);
+					if (best.size() < count)
+						best.push(candidate);
+					else if (candidate < best.top())
+					{
+						best.pop();
+						best.push(candidate);
+					}
+				}
+			};
+
+			// Search ring after ring of cells around the cell of the point, until no word outside the rings
+			// searched so far could be closer than the candidates found
+			for (int64_t ring = 0;; ++ring)
+			{
+				const int64_t c0 = cx - ring, c1 = cx + ring, r0 = cy - ring, r1 = cy + ring;
+				if (ring == 0)
+					visit(cx, cy);
+				else
+				{
+					for (int64_t c = std::max<int64_t>(c0, 0); c <= std::min(c1, columns - 1); ++c)
+					{
+						if (r0 >= 0)
+							visit(c, r0);
+						if (r1 < rows)
+							visit(c, r1);
+					}
+					for (int64_t r = std::max<int64_t>(r0 + 1, 0); r <= std::min(r1 - 1, rows - 1); ++r)
+					{
+						if (c0 >= 0)
+							visit(c0, r);
+						if (c1 < columns)
+							visit(c1, r);
+					}
+				}
+
+				int64_t bound = std::numeric_limits<int64_t>::max();
+				if (c0 > 0)
+					bound = std::min(bound, std::max<int64_t>(x - (m_origin_x + c0 * m_cell_width) + 1, 0));
+				if (c1 < columns - 1)
+					bound = std::min(bound, std::max<int64_t>(m_origin_x + (c1 + 1) * m_cell_width - x, 0));
+				if (r0 > 0)
+					bound = std::min(bound, std::max<int64_t>(y - (m_origin_y + r0 * m_cell_height) + 1, 0));
+				if (r1 < rows - 1)
+					bound = std::min(bound, std::max<int64_t>(m_origin_y + (r1 + 1) * m_cell_height - y, 0));
+
+				if (bound == std::numeric_limits<int64_t>::max())
+					break;
+				bound = std::min(bound, max_distance);
+				if (best.size() == count && best.top().first < bound * bound)
+					break;
+			}
+
+			std::vector<size_t> result(best.size());
+			for (size_t k = result.size(); k-- > 0; best.pop())
+				result[k] = best.top().second;
+			return result;
+		}
+
+	} // namespace DocFilters
+} // namespace Hyland
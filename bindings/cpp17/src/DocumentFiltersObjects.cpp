@@ -14,8 +14,14 @@
 */
 #include "DocumentFiltersObjects.h"
 #include "DocFiltersCommon.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <mutex>
-#include <optional>
+#include <system_error>
+#include <thread>
 #include <vector>
 #include <cstdint>
 
@@ -24,80 +30,195 @@ namespace Hyland
 	namespace DocFilters
 	{
 
-		class DocumentFilters::impl_t
+		/** One call to ConvertFiles, worked on by its calling thread and by the pool workers that join it. */
+		struct convert_batch_t
 		{
-		public:
-			IGR_SHORT m_instance = 0;
-			std::mutex m_lock;
-			std::optional<std::vector<Format>> m_formats;
-			std::optional<std::vector<Option>> m_options;
+			const std::vector<ConvertJob>& jobs;
+			std::vector<ConvertJobResult>& results;
+			std::function<Result<void>(const ConvertJob&)> convert;
+			size_t max_workers = 1;
+			size_t workers = 1; ///< Threads working on the batch, counting the caller; guarded by the pool lock.
+			std::atomic<size_t> next_job{ 0 };
+		};
 
-			void ensure_initialized() const
+		/** Worker threads that live as long as the DocumentFilters object, so batches of conversions reuse the same
+		    engine threads instead of starting new ones on every call. */
+		class convert_pool_t
+		{
+		public:
+			~convert_pool_t()
 			{
-				if (m_instance == 0)
-					throw DocumentFilters::Error("Document filters not initialized");
+				std::lock_guard<std::mutex> lock(m_threads_lock);
+				stop();
 			}
 
-			const std::vector<Format> &getFormats()
+			/** Starts workers until there are at least count of them. If a thread cannot be started, every worker is
+			    stopped and joined before the error is thrown, so no joinable thread is left behind. */
+			void reserve(size_t count)
 			{
-				std::lock_guard<std::mutex> lock(m_lock);
-				if (!m_formats.has_value())
-					m_formats = load_formats();
-
-				return *m_formats;
+				std::lock_guard<std::mutex> lock(m_threads_lock);
+				try
+				{
+					while (m_threads.size() < count)
+					{
+						const size_t worker_index = m_threads.size() + 1;
+						m_threads.emplace_back([this, worker_index] { work(worker_index); });
+					}
+				}
+				catch (const std::system_error& e)
+				{
+					stop();
+					throw DocumentFilters::Error(IGR_E_ERROR, std::string("Failed to start conversion worker: ") + e.what());
+				}
 			}
 
-			const std::vector<Option> &getOptions()
+			/** Runs a batch to completion. The calling thread works on it as worker 0 alongside the pool, and returns
+			    only once no pool worker is still looking at the batch. */
+			void run(convert_batch_t& batch)
 			{
-				std::lock_guard<std::mutex> lock(m_lock);
-				if (!m_options.has_value())
-					m_options = load_options();
+				{
+					std::lock_guard<std::mutex> lock(m_lock);
+					m_queue.push_back(&batch);
+				}
+				m_work_ready.notify_all();
+
+				process(batch, 0);
 
-				return *m_options;
+				std::unique_lock<std::mutex> lock(m_lock);
+				m_queue.erase(std::remove(m_queue.begin(), m_queue.end(), &batch), m_queue.end());
+				--batch.workers;
+				m_batch_left.wait(lock, [&batch] { return batch.workers == 0; });
 			}
 
-			[[nodiscard]]
-			std::vector<Format> load_formats() const
-			{
-				static const size_t max_formats = 0xffff;
-				std::vector<Format> result;
+		private:
+			std::mutex m_threads_lock; ///< Guards m_threads.
+			std::vector<std::thread> m_threads;
 
-				ensure_initialized();
+			std::mutex m_lock; ///< Guards m_queue and the worker count of each batch.
+			std::condition_variable m_work_ready;
+			std::condition_variable m_batch_left;
+			std::deque<convert_batch_t*> m_queue;
+			std::atomic<bool> m_stop{ false };
 
-				for (uint32_t i = 1; i < max_formats; ++i)
+			/** Stops and joins every worker; m_threads_lock must be held. A batch in flight is finished by its caller. */
+			void stop()
+			{
+				m_stop = true;
 				{
-					Format format(static_cast<uint32_t>(i));
-					if (format.id() != static_cast<uint32_t>(-1))
-						result.push_back(format);
+					// Taking the lock orders the store before any worker's wait, so none of them misses the wake up
+					std::lock_guard<std::mutex> lock(m_lock);
 				}
-				return result;
+				m_work_ready.notify_all();
+				for (auto&& thread : m_threads)
+					thread.join();
+				m_threads.clear();
+				m_stop = false;
 			}
 
-			[[nodiscard]]
-			std::vector<Option> load_options() const
+			convert_batch_t* find_batch()
 			{
-				static const size_t max_options = 0xffff;
-				std::vector<Option> result;
+				while (!m_queue.empty() && m_queue.front()->next_job >= m_queue.front()->jobs.size())
+					m_queue.pop_front();
+				for (auto&& batch : m_queue)
+				{
+					if (batch->workers < batch->max_workers && batch->next_job < batch->jobs.size())
+						return batch;
+				}
+				return nullptr;
+			}
 
-				ensure_initialized();
+			void work(size_t worker_index)
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				for (;;)
+				{
+					convert_batch_t* batch = nullptr;
+					m_work_ready.wait(lock, [&] { return m_stop || (batch = find_batch()) != nullptr; });
+					if (m_stop)
+						return;
+
+					++batch->workers;
+					lock.unlock();
+					process(*batch, worker_index);
+					lock.lock();
+					if (--batch->workers == 0)
+						m_batch_left.notify_all();
+				}
+			}
 
-				for (uint32_t i = 0; i < max_options; ++i)
+			void process(convert_batch_t& batch, size_t worker_index)
+			{
+				// Pool workers leave between jobs when stopping; the caller (worker 0) always finishes the batch
+				for (size_t i = batch.next_job++; i < batch.jobs.size(); i = batch.next_job++)
 				{
-					Option option(static_cast<uint32_t>(i));
-					if (!option.getDisplayName().empty())
-						result.push_back(option);
-					else
+					ConvertJobResult& result = batch.results[i];
+					result.worker = worker_index;
+					auto start = std::chrono::steady_clock::now();
+					try
+					{
+						result.status = batch.convert(batch.jobs[i]);
+					}
+					catch (const std::exception& e)
+					{
+						result.status = ErrorInfo(IGR_E_ERROR, e.what(), "ConvertFiles");
+					}
+					result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+					if (worker_index != 0 && m_stop)
 						break;
 				}
-				return result;
 			}
 		};
 
+		class DocumentFilters::impl_t
+		{
+		public:
+			IGR_SHORT m_instance = 0;
+			Registry m_registry;
+
+			// The access method and hint are read and written together, so GetExtractor never mixes two settings
+			mutable std::mutex m_file_access_lock;
+			FileAccess m_file_access = FileAccess::Default;
+			FileAccessHint m_file_access_hint = FileAccessHint::Random;
+			convert_pool_t m_convert_pool;
+		};
+
 		DocumentFilters::Error::Error(IGR_RETURN_CODE code, const std::string &message)
 			: std::runtime_error(message), m_code(code)
 		{
 		}
 
+		ErrorInfo::ErrorInfo(IGR_RETURN_CODE code, const Error_Control_Block& ecb, const char* function)
+			: ErrorInfo(code, &ecb.Msg[0], function)
+		{
+		}
+
+		ErrorInfo::ErrorInfo(IGR_RETURN_CODE code, const char* detail, const char* function)
+			: m_code(code)
+			, m_function(function)
+		{
+			if (detail != nullptr)
+			{
+				size_t length = 0;
+				while (length + 1 < m_detail.size() && detail[length] != 0)
+					++length;
+				std::copy(detail, detail + length, m_detail.begin());
+			}
+		}
+
+		std::string ErrorInfo::message() const
+		{
+			std::string result = m_detail[0] != 0 ? std::string(m_detail.data()) : "Error " + std::to_string(m_code);
+			if (m_function != nullptr && m_function[0] != 0)
+				result.append(" in ").append(m_function);
+			return result;
+		}
+
+		void ErrorInfo::raise() const
+		{
+			throw DocumentFilters::Error(m_code, message());
+		}
+
 		DocumentFilters::DocumentFilters()
 			: m_impl(std::make_shared<impl_t>())
 		{
@@ -128,16 +249,95 @@ namespace Hyland
 			copy_string(license, isb.Licensee_ID1);
 			Init_Instance(0, path.c_str(), &isb, &m_impl->m_instance, &ecb);
 			throw_on_error(IGR_OK, ecb, "Init_Instance", "Failed to initialize document filters");
+			m_impl->m_registry.DoAttach(std::string(isb.DLL_Version, strnlen(isb.DLL_Version, sizeof(isb.DLL_Version))));
+		}
+
+		void DocumentFilters::ConvertFile(const std::wstring& source, const std::wstring& destination, uint32_t flags, const std::wstring& options)
+		{
+			DoConvertFile(source, destination, flags, reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str())).value();
+		}
+
+		void DocumentFilters::ConvertFile(const std::wstring& source, const std::wstring& destination, uint32_t flags, const OptionSet& options)
+		{
+			TryConvertFile(source, destination, flags, options).value();
+		}
+
+		Result<void> DocumentFilters::TryConvertFile(const std::wstring& source, const std::wstring& destination, uint32_t flags, const OptionSet& options)
+		{
+			return DoConvertFile(source, destination, flags, options.data());
+		}
+
+		Result<void> DocumentFilters::DoConvertFile(const std::wstring& source, const std::wstring& destination, uint32_t flags, const IGR_UCS2* options)
+		{
+			if (source.empty())
+				throw std::invalid_argument("source");
+			if (destination.empty())
+				throw std::invalid_argument("destination");
+
+			Error_Control_Block ecb = {0};
+			IGR_RETURN_CODE rc = IGR_Convert_File(reinterpret_cast<const IGR_UCS2*>(w_to_u16(source).c_str()), static_cast<IGR_OPEN_FLAGS_TYPE>(flags), options, reinterpret_cast<const IGR_UCS2*>(w_to_u16(destination).c_str()), &ecb);
+			if (failed(rc))
+				return ErrorInfo(rc, ecb, "IGR_Convert_File");
+			return Result<void>();
+		}
+
+		std::vector<ConvertJobResult> DocumentFilters::ConvertFiles(const std::vector<ConvertJob>& jobs, uint32_t flags, const OptionSet& options, size_t threads)
+		{
+			std::vector<ConvertJobResult> results(jobs.size());
+			if (jobs.empty())
+				return results;
+
+			if (threads == 0)
+				threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+			threads = std::min(threads, jobs.size());
+
+			// The calling thread is worker 0, so the pool needs one thread fewer than the batch
+			m_impl->m_convert_pool.reserve(threads - 1);
+
+			convert_batch_t batch{ jobs, results, [&](const ConvertJob& job) { return TryConvertFile(job.source, job.destination, flags, options); } };
+			batch.max_workers = threads;
+			m_impl->m_convert_pool.run(batch);
+
+			return results;
+		}
+
+		void DocumentFilters::setFileAccess(FileAccess access, FileAccessHint hint)
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_file_access_lock);
+			m_impl->m_file_access = access;
+			m_impl->m_file_access_hint = hint;
+		}
+
+		FileAccess DocumentFilters::getFileAccess() const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_file_access_lock);
+			return m_impl->m_file_access;
+		}
+
+		FileAccessHint DocumentFilters::getFileAccessHint() const
+		{
+			std::lock_guard<std::mutex> lock(m_impl->m_file_access_lock);
+			return m_impl->m_file_access_hint;
 		}
 
 		const std::vector<Format> &DocumentFilters::getFormats() const
 		{
-			return m_impl->getFormats();
+			return m_impl->m_registry.getFormats();
 		}
 
 		const std::vector<Option> &DocumentFilters::getOptions() const
 		{
-			return m_impl->getOptions();
+			return m_impl->m_registry.getOptions();
+		}
+
+		const Registry &DocumentFilters::getRegistry() const
+		{
+			return m_impl->m_registry;
+		}
+
+		Registry &DocumentFilters::getRegistry()
+		{
+			return m_impl->m_registry;
 		}
 
 		Extractor DocumentFilters::GetExtractor(const std::string &filename)
@@ -146,13 +346,36 @@ namespace Hyland
 		}
 
 		Extractor DocumentFilters::GetExtractor(const std::wstring &filename)
+		{
+			FileAccess access;
+			FileAccessHint hint;
+			{
+				std::lock_guard<std::mutex> lock(m_impl->m_file_access_lock);
+				access = m_impl->m_file_access;
+				hint = m_impl->m_file_access_hint;
+			}
+			return GetExtractor(filename, access, hint);
+		}
+
+		Extractor DocumentFilters::GetExtractor(const std::string &filename, FileAccess access, FileAccessHint hint)
+		{
+			return GetExtractor(u8_to_w(filename), access, hint);
+		}
+
+		Extractor DocumentFilters::GetExtractor(const std::wstring &filename, FileAccess access, FileAccessHint hint)
 		{
 			if (filename.empty())
 				throw std::invalid_argument("filename");
 
-			Error_Control_Block ecb = {0};
 			IGR_Stream *Stream = nullptr;
 
+			if (access == FileAccess::MemoryMapped)
+			{
+				auto mapped = std::make_unique<MappedFileStream>(filename, hint);
+				return Extractor(Stream::bridge_input_stream(mapped.release(), true, &Stream));
+			}
+
+			Error_Control_Block ecb = {0};
 			throw_on_error(IGR_Make_Stream_From_File(reinterpret_cast<const IGR_UCS2 *>(w_to_u16(filename).c_str()), 0, &Stream, &ecb), ecb, "IGR_Make_Stream_From_File", "Failed to create stream from file");
 			return Extractor(Stream);
 		}
@@ -171,6 +394,11 @@ namespace Hyland
 			return Extractor(Stream);
 		}
 
+		Extractor DocumentFilters::GetExtractor(const PixelBufferView &bitmap)
+		{
+			return Extractor(bitmap);
+		}
+
 		Extractor DocumentFilters::GetExtractor(IGR_Stream *stream)
 		{
 			if (stream == nullptr)
@@ -208,7 +436,7 @@ namespace Hyland
 		Extractor DocumentFilters::GetExtractor(Stream& stream)
 		{
 			IGR_Stream* igr_stream = nullptr;
-			return Extractor(Stream::bridge_stream(&stream, false, &igr_stream));
+			return Extractor(Stream::bridge_input_stream(&stream, false, &igr_stream));
 		}
 
 		Extractor DocumentFilters::GetExtractor(Stream* stream, bool own_stream)
@@ -217,7 +445,7 @@ namespace Hyland
 				throw std::invalid_argument("stream");
 
 			IGR_Stream* igr_stream = nullptr;
-			return Extractor(Stream::bridge_stream(stream, own_stream, &igr_stream));
+			return Extractor(Stream::bridge_input_stream(stream, own_stream, &igr_stream));
 		}
 
 		Extractor DocumentFilters::OpenExtractor(const std::string &filename, OpenMode mode, int open_flags, const std::wstring &options, const open_callback_t& callback)
@@ -225,6 +453,11 @@ namespace Hyland
 			return OpenExtractor(u8_to_w(filename), mode, open_flags, options, callback);
 		}
 
+		Extractor DocumentFilters::OpenExtractor(const std::string &filename, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback)
+		{
+			return OpenExtractor(u8_to_w(filename), mode, open_flags, options, callback);
+		}
+
 		Extractor DocumentFilters::OpenExtractor(const std::wstring &filename, OpenMode mode, int open_flags, const std::wstring &options, const open_callback_t& callback)
 		{
 			Extractor res = GetExtractor(filename);
@@ -232,6 +465,13 @@ namespace Hyland
 			return res;
 		}
 
+		Extractor DocumentFilters::OpenExtractor(const std::wstring &filename, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback)
+		{
+			Extractor res = GetExtractor(filename);
+			res.Open(mode, open_flags, options, callback);
+			return res;
+		}
+
 		Extractor DocumentFilters::OpenExtractor(const void *data, size_t size, memory_destruct_t deleter, OpenMode mode, int open_flags, const std::wstring &option, const open_callback_t& callback)
 		{
 			Extractor res = GetExtractor(data, size, deleter);
@@ -239,6 +479,27 @@ namespace Hyland
 			return res;
 		}
 
+		Extractor DocumentFilters::OpenExtractor(const void *data, size_t size, memory_destruct_t deleter, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback)
+		{
+			Extractor res = GetExtractor(data, size, deleter);
+			res.Open(mode, open_flags, options, callback);
+			return res;
+		}
+
+		Extractor DocumentFilters::OpenExtractor(const PixelBufferView &bitmap, OpenMode mode, int open_flags, const std::wstring &option)
+		{
+			Extractor res = GetExtractor(bitmap);
+			res.Open(mode, open_flags, option);
+			return res;
+		}
+
+		Extractor DocumentFilters::OpenExtractor(const PixelBufferView &bitmap, OpenMode mode, int open_flags, const OptionSet& options)
+		{
+			Extractor res = GetExtractor(bitmap);
+			res.Open(mode, open_flags, options);
+			return res;
+		}
+
 		Extractor DocumentFilters::OpenExtractor(IGR_Stream *stream, OpenMode mode, int open_flags, const std::wstring &option, const open_callback_t& callback)
 		{
 			Extractor res = GetExtractor(stream);
@@ -246,6 +507,13 @@ namespace Hyland
 			return res;
 		}
 
+		Extractor DocumentFilters::OpenExtractor(IGR_Stream *stream, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback)
+		{
+			Extractor res = GetExtractor(stream);
+			res.Open(mode, open_flags, options, callback);
+			return res;
+		}
+
 		Extractor DocumentFilters::OpenExtractor(std::istream &stream, OpenMode mode, int open_flags, const std::wstring &option, const open_callback_t& callback)
 		{
 			Extractor res = GetExtractor(stream);
@@ -253,6 +521,13 @@ namespace Hyland
 			return res;
 		}
 
+		Extractor DocumentFilters::OpenExtractor(std::istream &stream, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback)
+		{
+			Extractor res = GetExtractor(stream);
+			res.Open(mode, open_flags, options, callback);
+			return res;
+		}
+
 		Extractor DocumentFilters::OpenExtractor(std::istream *stream, bool own_stream, OpenMode mode, int open_flags, const std::wstring &option, const open_callback_t& callback)
 		{
 			Extractor res = GetExtractor(stream, own_stream);
@@ -260,6 +535,13 @@ namespace Hyland
 			return res;
 		}
 
+		Extractor DocumentFilters::OpenExtractor(std::istream *stream, bool own_stream, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback)
+		{
+			Extractor res = GetExtractor(stream, own_stream);
+			res.Open(mode, open_flags, options, callback);
+			return res;
+		}
+
 		Extractor DocumentFilters::OpenExtractor(FILE* file, bool own_file, OpenMode mode, int open_flags, const std::wstring& option, const open_callback_t& callback)
 		{
 			Extractor res = GetExtractor(file, own_file);
@@ -267,6 +549,13 @@ namespace Hyland
 			return res;
 		}
 
+		Extractor DocumentFilters::OpenExtractor(FILE* file, bool own_file, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback)
+		{
+			Extractor res = GetExtractor(file, own_file);
+			res.Open(mode, open_flags, options, callback);
+			return res;
+		}
+
 		Extractor DocumentFilters::OpenExtractor(Stream& stream, OpenMode mode, int open_flags, const std::wstring& option, const open_callback_t& callback)
 		{
 			Extractor res = GetExtractor(stream);
@@ -274,6 +563,13 @@ namespace Hyland
 			return res;
 		}
 
+		Extractor DocumentFilters::OpenExtractor(Stream& stream, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback)
+		{
+			Extractor res = GetExtractor(stream);
+			res.Open(mode, open_flags, options, callback);
+			return res;
+		}
+
 		Extractor DocumentFilters::OpenExtractor(Stream* stream, bool own_stream, OpenMode mode, int open_flags, const std::wstring& option, const open_callback_t& callback)
 		{
 			Extractor res = GetExtractor(stream, own_stream);
@@ -281,23 +577,31 @@ namespace Hyland
 			return res;
 		}
 
+		Extractor DocumentFilters::OpenExtractor(Stream* stream, bool own_stream, OpenMode mode, int open_flags, const OptionSet& options, const open_callback_t& callback)
+		{
+			Extractor res = GetExtractor(stream, own_stream);
+			res.Open(mode, open_flags, options, callback);
+			return res;
+		}
+
 		Canvas DocumentFilters::MakeOutputCanvas(const std::string& filename, CanvasType type, const std::wstring& options)
 		{
 			return MakeOutputCanvas(u8_to_w(filename), type, options);
 		}
 
-		Canvas DocumentFilters::MakeOutputCanvas(const std::wstring& filename, CanvasType type, const std::wstring& options)
+		Canvas DocumentFilters::MakeOutputCanvas(const std::string& filename, CanvasType type, const OptionSet& options)
 		{
-			Error_Control_Block ecb = { 0 };
-			IGR_HCANVAS handle = 0;
+			return MakeOutputCanvas(u8_to_w(filename), type, options);
+		}
 
-			throw_on_error(IGR_Make_Output_Canvas(static_cast<int>(type)
-				, reinterpret_cast<const IGR_UCS2*>(w_to_u16(filename).c_str())
-				, reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str())
-				, &handle
-				, &ecb), ecb, "IGR_Make_Output_Canvas");
+		Canvas DocumentFilters::MakeOutputCanvas(const std::wstring& filename, CanvasType type, const std::wstring& options)
+		{
+			return DoMakeOutputCanvas(filename, type, reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str()));
+		}
 
-			return Canvas(handle, nullptr, false);
+		Canvas DocumentFilters::MakeOutputCanvas(const std::wstring& filename, CanvasType type, const OptionSet& options)
+		{
+			return DoMakeOutputCanvas(filename, type, options.data());
 		}
 
 		Canvas DocumentFilters::MakeOutputCanvas(std::iostream& stream, CanvasType type, const std::wstring& options)
@@ -307,6 +611,13 @@ namespace Hyland
 			return DoMakeOutputCanvas(igr_stream, type, options, true);
 		}
 
+		Canvas DocumentFilters::MakeOutputCanvas(std::iostream& stream, CanvasType type, const OptionSet& options)
+		{
+			IGR_Writable_Stream* igr_stream = nullptr;
+			Stream::bridge_iostream(&stream, false, reinterpret_cast<IGR_Stream**>(&igr_stream));
+			return DoMakeOutputCanvas(igr_stream, type, options.data(), true);
+		}
+
 		Canvas DocumentFilters::MakeOutputCanvas(std::iostream* stream, bool own_stream, CanvasType type, const std::wstring& options)
 		{
 			IGR_Writable_Stream* igr_stream = nullptr;
@@ -314,6 +625,13 @@ namespace Hyland
 			return DoMakeOutputCanvas(igr_stream, type, options, true);
 		}
 
+		Canvas DocumentFilters::MakeOutputCanvas(std::iostream* stream, bool own_stream, CanvasType type, const OptionSet& options)
+		{
+			IGR_Writable_Stream* igr_stream = nullptr;
+			Stream::bridge_iostream(stream, own_stream, reinterpret_cast<IGR_Stream**>(&igr_stream));
+			return DoMakeOutputCanvas(igr_stream, type, options.data(), true);
+		}
+
 		Canvas DocumentFilters::MakeOutputCanvas(FILE* file, bool own_file, CanvasType type, const std::wstring& options)
 		{
 			IGR_Writable_Stream* igr_stream = nullptr;
@@ -321,6 +639,13 @@ namespace Hyland
 			return DoMakeOutputCanvas(igr_stream, type, options, true);
 		}
 
+		Canvas DocumentFilters::MakeOutputCanvas(FILE* file, bool own_file, CanvasType type, const OptionSet& options)
+		{
+			IGR_Writable_Stream* igr_stream = nullptr;
+			Stream::bridge_file(file, own_file, reinterpret_cast<IGR_Stream**>(&igr_stream));
+			return DoMakeOutputCanvas(igr_stream, type, options.data(), true);
+		}
+
 		Canvas DocumentFilters::MakeOutputCanvas(Stream& stream, CanvasType type, const std::wstring& options)
 		{
 			IGR_Writable_Stream* igr_stream = nullptr;
@@ -328,6 +653,13 @@ namespace Hyland
 			return DoMakeOutputCanvas(igr_stream, type, options, true);
 		}
 
+		Canvas DocumentFilters::MakeOutputCanvas(Stream& stream, CanvasType type, const OptionSet& options)
+		{
+			IGR_Writable_Stream* igr_stream = nullptr;
+			Stream::bridge_stream(&stream, false, reinterpret_cast<IGR_Stream**>(&igr_stream));
+			return DoMakeOutputCanvas(igr_stream, type, options.data(), true);
+		}
+
 		Canvas DocumentFilters::MakeOutputCanvas(Stream* stream, bool own_stream, CanvasType type, const std::wstring& options)
 		{
 			IGR_Writable_Stream* igr_stream = nullptr;
@@ -335,22 +667,53 @@ namespace Hyland
 			return DoMakeOutputCanvas(igr_stream, type, options, true);
 		}
 
+		Canvas DocumentFilters::MakeOutputCanvas(Stream* stream, bool own_stream, CanvasType type, const OptionSet& options)
+		{
+			IGR_Writable_Stream* igr_stream = nullptr;
+			Stream::bridge_stream(stream, own_stream, reinterpret_cast<IGR_Stream**>(&igr_stream));
+			return DoMakeOutputCanvas(igr_stream, type, options.data(), true);
+		}
+
 		Canvas DocumentFilters::MakeOutputCanvas(IGR_Writable_Stream* stream, CanvasType type, const std::wstring& options)
 		{
 			return DoMakeOutputCanvas(stream, type, options, false);
 		}
+
+		Canvas DocumentFilters::MakeOutputCanvas(IGR_Writable_Stream* stream, CanvasType type, const OptionSet& options)
+		{
+			return DoMakeOutputCanvas(stream, type, options.data(), false);
+		}
 		
 		Canvas DocumentFilters::DoMakeOutputCanvas(IGR_Writable_Stream* stream, CanvasType type, const std::wstring& options, bool own_stream)
+		{
+			return DoMakeOutputCanvas(stream, type, reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str()), own_stream);
+		}
+
+		Canvas DocumentFilters::DoMakeOutputCanvas(IGR_Writable_Stream* stream, CanvasType type, const IGR_UCS2* options, bool own_stream)
 		{
 			Error_Control_Block ecb = { 0 };
 			IGR_HCANVAS handle = 0;
 			throw_on_error(IGR_Make_Output_Canvas_On(static_cast<int>(type)
 				, stream
-				, reinterpret_cast<const IGR_UCS2*>(w_to_u16(options).c_str())
+				, options
 				, &handle
 				, &ecb), ecb, "IGR_Make_Output_Canvas_On");
 			return Canvas(handle, stream, own_stream);            
 		}
 
+		Canvas DocumentFilters::DoMakeOutputCanvas(const std::wstring& filename, CanvasType type, const IGR_UCS2* options)
+		{
+			Error_Control_Block ecb = { 0 };
+			IGR_HCANVAS handle = 0;
+
+			throw_on_error(IGR_Make_Output_Canvas(static_cast<int>(type)
+				, reinterpret_cast<const IGR_UCS2*>(w_to_u16(filename).c_str())
+				, options
+				, &handle
+				, &ecb), ecb, "IGR_Make_Output_Canvas");
+
+			return Canvas(handle, nullptr, false);
+		}
+
 	} // namespace DocFilters
 } // namespace Hyland
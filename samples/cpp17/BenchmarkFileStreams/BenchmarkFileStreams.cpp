@@ -0,0 +1,307 @@
+/*
+(c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/****************************************************************************
+* Document Filters Example - Benchmark the file stream implementations
+****************************************************************************/
+
+#include <DocumentFiltersObjects.h>
+#include <DocumentFiltersSamples.h>
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace DF = Hyland::DocFilters;
+
+struct options_t
+{
+	std::vector<std::string> filenames;
+	std::string license_key;
+	int iterations = 5;
+	size_t random_reads = 10000;
+	size_t read_size = 4096;
+	bool skip_extract = false;
+	std::vector<size_t> concurrency = { 1, 16, 256 };
+};
+
+using clock_type = std::chrono::steady_clock;
+using stream_factory_t = std::function<IGR_Stream*(const std::string&)>;
+
+struct source_t
+{
+	std::string name;
+	stream_factory_t make;
+};
+
+std::vector<source_t> make_sources()
+{
+	return {
+		{ "std::ifstream", [](const std::string& filename) {
+			IGR_Stream* result = nullptr;
+			auto strm = new std::ifstream(filename, std::ios::binary);
+			return DF::Stream::bridge_istream(strm, true, &result);
+		} },
+		{ "IGR_Make_Stream_From_File", [](const std::string& filename) {
+			IGR_Stream* result = nullptr;
+			Error_Control_Block ecb = { 0 };
+			auto u16 = DF::u8_to_u16(filename);
+			if (IGR_Make_Stream_From_File(reinterpret_cast<const IGR_UCS2*>(u16.c_str()), 0, &result, &ecb) != IGR_OK)
+				throw std::runtime_error(ecb.Msg);
+			return result;
+		} },
+		{ "BufferedStream(ifstream)", [](const std::string& filename) {
+			IGR_Stream* result = nullptr;
+			auto strm = new std::ifstream(filename, std::ios::binary);
+			return DF::Stream::bridge_stream(new DF::BufferedStream(strm, true), true, &result);
+		} },
+		{ "PrefetchStream(ifstream)", [](const std::string& filename) {
+			IGR_Stream* result = nullptr;
+			auto strm = new DF::FileStream(new std::ifstream(filename, std::ios::binary), true);
+			return DF::Stream::bridge_stream(new DF::PrefetchStream(strm, true), true, &result);
+		} },
+		{ "MappedFileStream", [](const std::string& filename) {
+			IGR_Stream* result = nullptr;
+			return DF::Stream::bridge_stream(new DF::MappedFileStream(filename, DF::MappedFileStream::AccessHint::Random), true, &result);
+		} },
+		{ "AsyncFileStream", [](const std::string& filename) {
+			IGR_Stream* result = nullptr;
+			return DF::Stream::bridge_stream(new DF::AsyncFileStream(filename), true, &result);
+		} },
+	};
+}
+
+std::vector<source_t> make_concurrent_sources()
+{
+	return {
+		{ "bridge_file", [](const std::string& filename) {
+			IGR_Stream* result = nullptr;
+			FILE* file = fopen(filename.c_str(), "rb");
+			if (file == nullptr)
+				throw std::runtime_error("Failed to open " + filename);
+			return DF::Stream::bridge_file(file, true, &result);
+		} },
+		{ "AsyncFileStream", [](const std::string& filename) {
+			IGR_Stream* result = nullptr;
+			return DF::Stream::bridge_stream(new DF::AsyncFileStream(filename), true, &result);
+		} },
+	};
+}
+
+void print_result(const std::string& test, const std::string& source, const std::vector<double>& samples, uint64_t bytes)
+{
+	auto sorted = samples;
+	std::sort(sorted.begin(), sorted.end());
+	double median = sorted[sorted.size() / 2];
+	double mbps = median > 0 ? (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (median / 1000.0) : 0;
+
+	std::cout << "  " << std::left << std::setw(12) << test
+		<< std::setw(28) << source
+		<< std::right << std::fixed << std::setprecision(2)
+		<< std::setw(10) << median << " ms (median)"
+		<< std::setw(10) << sorted.front() << " ms (min)"
+		<< std::setw(10) << mbps << " MB/s" << std::endl;
+}
+
+uint64_t read_sequential(IGR_Stream* stream, size_t read_size)
+{
+	std::vector<uint8_t> buffer(read_size);
+	uint64_t total = 0;
+	stream->Seek(stream, 0, 0);
+	for (;;)
+	{
+		auto got = stream->Read(stream, buffer.data(), static_cast<IGR_ULONG>(buffer.size()));
+		if (got == 0)
+			break;
+		total += got;
+	}
+	return total;
+}
+
+uint64_t read_random(IGR_Stream* stream, size_t count, size_t read_size, uint32_t seed)
+{
+	std::vector<uint8_t> buffer(read_size);
+	std::mt19937_64 rng(seed);
+	auto size = static_cast<uint64_t>(stream->Seek(stream, 0, 2));
+	uint64_t total = 0;
+	if (size == 0)
+		return 0;
+
+	std::uniform_int_distribution<uint64_t> dist(0, size - 1);
+	for (size_t i = 0; i < count; ++i)
+	{
+		stream->Seek(stream, static_cast<IGR_LONGLONG>(dist(rng)), 0);
+		total += stream->Read(stream, buffer.data(), static_cast<IGR_ULONG>(buffer.size()));
+	}
+	return total;
+}
+
+uint64_t extract_text(DF::Extractor& doc)
+{
+	uint64_t total = 0;
+	doc.Open(DF::OpenMode::Text, IGR_BODY_AND_META);
+	while (!doc.getEOF())
+		total += doc.getText(4096).size();
+	return total;
+}
+
+template<typename Func>
+double time_ms(Func&& func)
+{
+	auto start = clock_type::now();
+	func();
+	return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+// Reads `documents` streams front to back, spread over one worker thread per core. Each worker interleaves
+// reads across its share of the documents, the way a worker serving many extractions at once would.
+uint64_t read_concurrent(const source_t& source, const std::vector<std::string>& filenames, size_t documents, size_t read_size)
+{
+	size_t workers = std::min<size_t>(documents, std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<uint64_t> totals(workers);
+	std::vector<std::thread> threads;
+
+	for (size_t w = 0; w < workers; ++w)
+	{
+		threads.emplace_back([&, w] {
+			std::vector<IGR_Stream*> streams;
+			for (size_t d = w; d < documents; d += workers)
+				streams.push_back(source.make(filenames[d % filenames.size()]));
+
+			std::vector<uint8_t> buffer(read_size);
+			while (!streams.empty())
+			{
+				for (size_t i = 0; i < streams.size();)
+				{
+					auto got = streams[i]->Read(streams[i], buffer.data(), static_cast<IGR_ULONG>(buffer.size()));
+					totals[w] += got;
+					if (got == 0)
+					{
+						streams[i]->Close(streams[i]);
+						streams.erase(streams.begin() + static_cast<std::ptrdiff_t>(i));
+					}
+					else
+						++i;
+				}
+			}
+		});
+	}
+	for (auto&& thread : threads)
+		thread.join();
+
+	uint64_t total = 0;
+	for (auto&& bytes : totals)
+		total += bytes;
+	return total;
+}
+
+void process_concurrent(const options_t& options)
+{
+	std::cout << "concurrent reads (" << (DF::AsyncFileStream::isAvailable() ? "io_uring" : "io_uring unavailable, positional reads") << ")" << std::endl;
+
+	for (auto&& documents : options.concurrency)
+	{
+		for (auto&& source : make_concurrent_sources())
+		{
+			std::vector<double> samples;
+			uint64_t bytes = 0;
+			for (int i = 0; i < options.iterations; ++i)
+				samples.push_back(time_ms([&] { bytes = read_concurrent(source, options.filenames, documents, options.read_size); }));
+			print_result("x" + std::to_string(documents), source.name, samples, bytes);
+		}
+	}
+	std::cout << std::endl;
+}
+
+void process_file(DF::Api& api, const options_t& options, const std::string& filename)
+{
+	auto sources = make_sources();
+
+	std::cout << filename << std::endl;
+
+	for (auto&& source : sources)
+	{
+		std::vector<double> seq, rnd;
+		uint64_t seq_bytes = 0, rnd_bytes = 0;
+
+		for (int i = 0; i < options.iterations; ++i)
+		{
+			IGR_Stream* stream = source.make(filename);
+			seq.push_back(time_ms([&] { seq_bytes = read_sequential(stream, options.read_size); }));
+			rnd.push_back(time_ms([&] { rnd_bytes = read_random(stream, options.random_reads, options.read_size, static_cast<uint32_t>(i)); }));
+			stream->Close(stream);
+		}
+		print_result("sequential", source.name, seq, seq_bytes);
+		print_result("random", source.name, rnd, rnd_bytes);
+	}
+
+	if (options.skip_extract)
+		return;
+
+	for (auto&& source : sources)
+	{
+		std::vector<double> samples;
+		uint64_t chars = 0;
+
+		for (int i = 0; i < options.iterations; ++i)
+		{
+			samples.push_back(time_ms([&] {
+				auto&& doc = api.GetExtractor(source.make(filename));
+				chars = extract_text(doc);
+			}));
+		}
+		print_result("extract", source.name, samples, chars * sizeof(wchar_t));
+	}
+	std::cout << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	CLI::App app("Hyland Document Filters: BenchmarkFileStreams");
+
+	try {
+		options_t options;
+
+		app.add_option("filename", options.filenames, "Files to read")->required();
+		app.add_option("-l,--license", options.license_key, "License key for Document Filters");
+		app.add_option("-i,--iterations", options.iterations, "Number of timed iterations per test");
+		app.add_option("-r,--random-reads", options.random_reads, "Number of reads in the random access test");
+		app.add_option("-b,--read-size", options.read_size, "Size of each read in bytes");
+		app.add_flag("--skip-extract", options.skip_extract, "Only time raw stream reads, skip text extraction");
+		app.add_option("-c,--concurrency", options.concurrency, "Numbers of documents read at once in the concurrent test, 0 to skip it");
+		app.parse(argc, argv);
+
+		if (options.iterations < 1 || options.read_size == 0)
+			throw std::invalid_argument("iterations and read-size must be positive");
+		options.concurrency.erase(std::remove(options.concurrency.begin(), options.concurrency.end(), 0), options.concurrency.end());
+
+		DF::Api api(DocumentFiltersSamples::get_license_key(options.license_key), ".");
+		for (auto&& filename : options.filenames)
+			process_file(api, options, filename);
+		if (!options.concurrency.empty())
+			process_concurrent(options);
+	}
+	catch (const CLI::ParseError& e) {
+		return app.exit(e);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,386 @@
+/*
+(c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/****************************************************************************
+* Document Filters Example - Benchmark the string conversion functions and
+* Extractor::SaveTo in each code page
+****************************************************************************/
+
+#include <DocumentFiltersObjects.h>
+#include <DocumentFiltersSamples.h>
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace DF = Hyland::DocFilters;
+
+struct options_t
+{
+	std::vector<std::string> filenames;
+	std::string license_key;
+	size_t length = 1 << 20;
+	int iterations = 20;
+};
+
+typedef std::chrono::steady_clock clock_type;
+
+// One code unit at a time with push_back, the way the conversions were written before they were
+// vectorized. Kept here so the numbers have something to be compared with.
+namespace baseline
+{
+	std::string u16_to_u8(const std::u16string& str)
+	{
+		std::string result;
+		for (size_t i = 0; i < str.size(); ++i)
+		{
+			uint32_t ch = str[i];
+			if (ch >= 0xD800 && ch <= 0xDBFF && i + 1 < str.size() && str[i + 1] >= 0xDC00 && str[i + 1] <= 0xDFFF)
+				ch = ((ch - 0xD800) << 10) + (str[++i] - 0xDC00) + 0x10000;
+			if (ch <= 0x7F)
+				result.push_back(static_cast<char>(ch));
+			else if (ch <= 0x7FF)
+			{
+				result.push_back(static_cast<char>(0xC0 | (ch >> 6)));
+				result.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+			}
+			else if (ch <= 0xFFFF)
+			{
+				result.push_back(static_cast<char>(0xE0 | (ch >> 12)));
+				result.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+				result.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+			}
+			else
+			{
+				result.push_back(static_cast<char>(0xF0 | (ch >> 18)));
+				result.push_back(static_cast<char>(0x80 | ((ch >> 12) & 0x3F)));
+				result.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+				result.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+			}
+		}
+		return result;
+	}
+
+	template <typename T>
+	T u8_to_uX(const std::string& str)
+	{
+		T result;
+		for (size_t i = 0; i < str.size(); ++i)
+		{
+			unsigned char ch = str[i];
+			if (ch <= 0x7F)
+				result.push_back(static_cast<typename T::value_type>(ch));
+			else if (ch <= 0xDF && i + 1 < str.size())
+			{
+				result.push_back(static_cast<typename T::value_type>(((ch & 0x1F) << 6) | (str[i + 1] & 0x3F)));
+				i += 1;
+			}
+			else if (ch <= 0xEF && i + 2 < str.size())
+			{
+				result.push_back(static_cast<typename T::value_type>(((ch & 0x0F) << 12) | ((str[i + 1] & 0x3F) << 6) | (str[i + 2] & 0x3F)));
+				i += 2;
+			}
+			else if (ch <= 0xF7 && i + 3 < str.size())
+			{
+				uint32_t codepoint = ((ch & 0x07) << 18) | ((str[i + 1] & 0x3F) << 12) | ((str[i + 2] & 0x3F) << 6) | (str[i + 3] & 0x3F);
+				if (sizeof(typename T::value_type) == 4 || codepoint <= 0xFFFF)
+					result.push_back(static_cast<typename T::value_type>(codepoint));
+				else
+				{
+					result.push_back(static_cast<typename T::value_type>(0xD800 + ((codepoint - 0x10000) >> 10)));
+					result.push_back(static_cast<typename T::value_type>(0xDC00 + ((codepoint - 0x10000) & 0x3FF)));
+				}
+				i += 3;
+			}
+		}
+		return result;
+	}
+
+	std::wstring u16_to_w(const std::u16string& str)
+	{
+		std::wstring result;
+		for (size_t i = 0; i < str.size(); ++i)
+		{
+			uint32_t ch = str[i];
+			if (sizeof(wchar_t) == 4 && ch >= 0xD800 && ch <= 0xDBFF && i + 1 < str.size() && str[i + 1] >= 0xDC00 && str[i + 1] <= 0xDFFF)
+				ch = ((ch - 0xD800) << 10) + (str[++i] - 0xDC00) + 0x10000;
+			result.push_back(static_cast<wchar_t>(ch));
+		}
+		return result;
+	}
+
+	std::u16string w_to_u16(const std::wstring& str)
+	{
+		std::u16string result;
+		for (wchar_t wch : str)
+		{
+			auto ch = static_cast<uint32_t>(wch);
+			if (ch <= 0xFFFF)
+				result.push_back(static_cast<char16_t>(ch));
+			else
+			{
+				result.push_back(static_cast<char16_t>(0xD800 + ((ch - 0x10000) >> 10)));
+				result.push_back(static_cast<char16_t>(0xDC00 + ((ch - 0x10000) & 0x3FF)));
+			}
+		}
+		return result;
+	}
+
+	std::u32string w_to_u32(const std::wstring& str)
+	{
+		std::u32string result;
+		for (size_t i = 0; i < str.size(); ++i)
+		{
+			uint32_t ch = static_cast<uint32_t>(str[i]);
+			if (sizeof(wchar_t) == 2 && ch >= 0xD800 && ch <= 0xDBFF && i + 1 < str.size() && str[i + 1] >= 0xDC00 && str[i + 1] <= 0xDFFF)
+				ch = ((ch - 0xD800) << 10) + (str[++i] - 0xDC00) + 0x10000;
+			result.push_back(static_cast<char32_t>(ch));
+		}
+		return result;
+	}
+
+	template <typename T>
+	void swap_bytes(T& str)
+	{
+		for (auto&& ch : str)
+		{
+			auto unit = static_cast<uint32_t>(ch);
+			ch = static_cast<typename T::value_type>(sizeof(ch) == 2 ? ((unit >> 8) | (unit << 8)) & 0xFFFF
+				: (unit >> 24) | ((unit >> 8) & 0xFF00) | ((unit << 8) & 0xFF0000) | (unit << 24));
+		}
+	}
+
+	// SaveTo as it was: 4096 characters at a time through a wide string, converted and written per block
+	void save_to(DF::Extractor& doc, std::ostream& stream, int code_page, bool strip_control_chars)
+	{
+		const uint16_t probe = 1;
+		const bool little_endian = *reinterpret_cast<const uint8_t*>(&probe) == 1;
+		while (!doc.getEOF())
+		{
+			std::wstring text = doc.getText(4096, strip_control_chars);
+			if (text.empty())
+				break;
+			if (code_page == 1200 || code_page == 1201)
+			{
+				auto utf16 = w_to_u16(text);
+				if ((code_page == 1200) != little_endian)
+					swap_bytes(utf16);
+				stream.write(reinterpret_cast<const char*>(utf16.data()), static_cast<std::streamsize>(utf16.size() * sizeof(char16_t)));
+			}
+			else if (code_page == 12000 || code_page == 12001)
+			{
+				auto utf32 = w_to_u32(text);
+				if ((code_page == 12000) != little_endian)
+					swap_bytes(utf32);
+				stream.write(reinterpret_cast<const char*>(utf32.data()), static_cast<std::streamsize>(utf32.size() * sizeof(char32_t)));
+			}
+			else
+			{
+				auto utf8 = u16_to_u8(w_to_u16(text));
+				stream.write(utf8.data(), static_cast<std::streamsize>(utf8.size()));
+			}
+		}
+	}
+} // namespace baseline
+
+// Builds `length` code points of text drawn from the given ranges; `ascii_share` of them are plain ASCII
+// letters and spaces, as in mixed-script documents.
+std::u32string make_text(size_t length, std::vector<std::pair<char32_t, char32_t>> ranges, double ascii_share)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<double> share(0.0, 1.0);
+	std::u32string result;
+	result.reserve(length);
+	for (size_t i = 0; i < length; ++i)
+	{
+		if (ranges.empty() || share(rng) < ascii_share)
+			result.push_back(rng() % 6 == 0 ? U' ' : static_cast<char32_t>(U'a' + rng() % 26));
+		else
+		{
+			auto& range = ranges[rng() % ranges.size()];
+			result.push_back(range.first + static_cast<char32_t>(rng() % (range.second - range.first + 1)));
+		}
+	}
+	return result;
+}
+
+std::u16string to_u16(const std::u32string& text)
+{
+	std::u16string result;
+	for (char32_t ch : text)
+	{
+		if (ch <= 0xFFFF)
+			result.push_back(static_cast<char16_t>(ch));
+		else
+		{
+			result.push_back(static_cast<char16_t>(0xD800 + ((ch - 0x10000) >> 10)));
+			result.push_back(static_cast<char16_t>(0xDC00 + ((ch - 0x10000) & 0x3FF)));
+		}
+	}
+	return result;
+}
+
+// Returns the best time over the iterations in milliseconds; `sink` keeps the result from being optimized away
+double best_ms(int iterations, const std::function<size_t()>& func, size_t& sink)
+{
+	double best = 0;
+	for (int i = 0; i < iterations; ++i)
+	{
+		auto start = clock_type::now();
+		sink += func();
+		double ms = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+		if (i == 0 || ms < best)
+			best = ms;
+	}
+	return best;
+}
+
+void run(const options_t& options, const std::string& name, const std::u32string& text)
+{
+	std::u16string u16 = to_u16(text);
+	std::string u8 = DF::u16_to_u8(u16);
+	std::wstring w = DF::u16_to_w(u16);
+	size_t sink = 0;
+
+	struct test_t
+	{
+		const char* name;
+		size_t input_bytes;
+		std::function<size_t()> current;
+		std::function<size_t()> previous;
+	};
+	std::vector<test_t> tests = {
+		{ "u16_to_u8", u16.size() * 2, [&] { return DF::u16_to_u8(u16).size(); }, [&] { return baseline::u16_to_u8(u16).size(); } },
+		{ "u8_to_u16", u8.size(), [&] { return DF::u8_to_u16(u8).size(); }, [&] { return baseline::u8_to_uX<std::u16string>(u8).size(); } },
+		{ "u8_to_w", u8.size(), [&] { return DF::u8_to_w(u8).size(); }, [&] { return baseline::u8_to_uX<std::wstring>(u8).size(); } },
+		{ "u16_to_w", u16.size() * 2, [&] { return DF::u16_to_w(u16).size(); }, [&] { return baseline::u16_to_w(u16).size(); } },
+		{ "w_to_u16", w.size() * sizeof(wchar_t), [&] { return DF::w_to_u16(w).size(); }, [&] { return baseline::w_to_u16(w).size(); } },
+	};
+
+	std::cout << name << " (" << text.size() << " code points, " << u8.size() << " UTF-8 bytes)" << std::endl;
+	for (auto&& test : tests)
+	{
+		double current = best_ms(options.iterations, test.current, sink);
+		double previous = best_ms(options.iterations, test.previous, sink);
+		auto mb_per_s = [&](double ms) { return ms > 0 ? static_cast<double>(test.input_bytes) / (ms * 1000.0) : 0.0; };
+
+		std::cout << "  " << std::left << std::setw(10) << test.name << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(10) << mb_per_s(current) << " MB/s" << std::setw(10) << mb_per_s(previous) << " MB/s (per code unit)"
+			<< std::setw(8) << std::setprecision(2) << (current > 0 ? previous / current : 0.0) << "x" << std::endl;
+	}
+	if (sink == 0)
+		std::cout << std::endl;
+}
+
+// Discards what is written to it, counting the bytes
+class null_buffer_t : public std::streambuf
+{
+public:
+	size_t bytes = 0;
+
+protected:
+	int_type overflow(int_type ch) override
+	{
+		++bytes;
+		return traits_type::not_eof(ch);
+	}
+
+	std::streamsize xsputn(const char*, std::streamsize count) override
+	{
+		bytes += static_cast<size_t>(count);
+		return count;
+	}
+};
+
+// Times SaveTo against the block-at-a-time conversion it replaced, for each code page with and without
+// stripping control characters. Both include the time spent extracting the text.
+void run_document(DF::Api& api, const options_t& options, const std::string& filename)
+{
+	static const std::vector<std::pair<int, const char*>> code_pages = {
+		{ 65001, "UTF-8" }, { 1200, "UTF-16LE" }, { 1201, "UTF-16BE" }, { 12000, "UTF-32LE" }, { 12001, "UTF-32BE" },
+	};
+	size_t sink = 0;
+
+	std::cout << filename << std::endl;
+	for (auto&& code_page : code_pages)
+	{
+		for (bool strip : { false, true })
+		{
+			size_t bytes = 0;
+			auto save = [&](bool previous) {
+				auto&& doc = api.GetExtractor(filename);
+				doc.Open(DF::OpenMode::Text, IGR_BODY_AND_META);
+				null_buffer_t buffer;
+				std::ostream stream(&buffer);
+				if (previous)
+					baseline::save_to(doc, stream, code_page.first, strip);
+				else
+					doc.SaveTo(stream, code_page.first, strip);
+				bytes = buffer.bytes;
+				return bytes;
+			};
+			double current = best_ms(options.iterations, [&] { return save(false); }, sink);
+			double previous = best_ms(options.iterations, [&] { return save(true); }, sink);
+			auto mb_per_s = [&](double ms) { return ms > 0 ? static_cast<double>(bytes) / (ms * 1000.0) : 0.0; };
+
+			std::cout << "  " << std::left << std::setw(10) << code_page.second << std::setw(7) << (strip ? "strip" : "") << std::right
+				<< std::setw(12) << bytes << " bytes" << std::fixed << std::setprecision(1)
+				<< std::setw(10) << mb_per_s(current) << " MB/s" << std::setw(10) << mb_per_s(previous) << " MB/s (per block)"
+				<< std::setw(8) << std::setprecision(2) << (current > 0 ? previous / current : 0.0) << "x" << std::endl;
+		}
+	}
+	if (sink == 0)
+		std::cout << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	CLI::App app("Hyland Document Filters: BenchmarkStrings");
+
+	try {
+		options_t options;
+
+		app.add_option("filename", options.filenames, "Documents to time Extractor::SaveTo with, in each code page");
+		app.add_option("-l,--license", options.license_key, "License key for Document Filters");
+		app.add_option("-n,--length", options.length, "Number of code points in each test string");
+		app.add_option("-i,--iterations", options.iterations, "Number of timed iterations per test");
+		app.parse(argc, argv);
+
+		if (options.iterations < 1 || options.length == 0)
+			throw std::invalid_argument("iterations and length must be positive");
+
+		run(options, "ASCII", make_text(options.length, {}, 1.0));
+		run(options, "Latin-1", make_text(options.length, { { 0xC0, 0xFF } }, 0.85));
+		run(options, "CJK", make_text(options.length, { { 0x4E00, 0x9FFF }, { 0x3040, 0x30FF } }, 0.05));
+		run(options, "Emoji", make_text(options.length, { { 0x1F300, 0x1F64F }, { 0x1F900, 0x1F9FF } }, 0.5));
+
+		if (!options.filenames.empty())
+		{
+			DF::Api api(DocumentFiltersSamples::get_license_key(options.license_key), ".");
+			for (auto&& filename : options.filenames)
+				run_document(api, options, filename);
+		}
+	}
+	catch (const CLI::ParseError& e) {
+		return app.exit(e);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
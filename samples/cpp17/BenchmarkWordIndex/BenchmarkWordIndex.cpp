@@ -0,0 +1,276 @@
+/*
+(c) 2024 Hyland Software, Inc. and its affiliates. All rights reserved.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/****************************************************************************
+* Document Filters Example - Benchmark region and nearest word queries on
+* WordIndex against a scan of every word on the page
+****************************************************************************/
+
+#include <DocumentFiltersObjects.h>
+#include <DocumentFiltersSamples.h>
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace DF = Hyland::DocFilters;
+
+struct options_t
+{
+	std::vector<std::string> filenames;
+	std::string license_key;
+	std::vector<size_t> word_counts = { 1000, 10000, 100000 };
+	int queries = 1000;
+	int iterations = 5;
+};
+
+typedef std::chrono::steady_clock clock_type;
+
+// The boxes of a page, column by column, as WordTable keeps them
+struct page_words_t
+{
+	std::vector<int32_t> x, y, width, height;
+	int32_t page_width = 0;
+	int32_t page_height = 0;
+
+	size_t size() const { return x.size(); }
+};
+
+// Checking every word, which is what finding words in an area costs without an index
+namespace baseline
+{
+	size_t words_in_rect(const page_words_t& words, const DF::RectI32& rect, std::vector<size_t>& result)
+	{
+		result.clear();
+		for (size_t i = 0; i < words.size(); ++i)
+		{
+			if (words.x[i] < rect.right && words.x[i] + std::max(words.width[i], 1) > rect.left
+				&& words.y[i] < rect.bottom && words.y[i] + std::max(words.height[i], 1) > rect.top)
+				result.push_back(i);
+		}
+		return result.size();
+	}
+
+	size_t nearest_word(const page_words_t& words, int32_t x, int32_t y)
+	{
+		size_t best = 0;
+		int64_t best_distance = -1;
+		for (size_t i = 0; i < words.size(); ++i)
+		{
+			int64_t right = static_cast<int64_t>(words.x[i]) + std::max(words.width[i], 1);
+			int64_t bottom = static_cast<int64_t>(words.y[i]) + std::max(words.height[i], 1);
+			int64_t dx = x < words.x[i] ? words.x[i] - x : (x >= right ? x - right + 1 : 0);
+			int64_t dy = y < words.y[i] ? words.y[i] - y : (y >= bottom ? y - bottom + 1 : 0);
+			int64_t distance = dx * dx + dy * dy;
+			if (best_distance < 0 || distance < best_distance)
+			{
+				best = i;
+				best_distance = distance;
+			}
+		}
+		return best;
+	}
+} // namespace baseline
+
+// Lays out `count` words in lines of text, the way a dense page of small print looks
+page_words_t make_page(size_t count)
+{
+	std::mt19937 rng(42);
+	page_words_t page;
+	const int32_t line_height = 24;
+	const int32_t gap = 8;
+	const auto line_width = static_cast<int32_t>(std::sqrt(static_cast<double>(count)) * 64.0) + 200;
+
+	int32_t x = 0, y = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto width = static_cast<int32_t>(12 + rng() % 60);
+		if (x > 0 && x + width > line_width)
+		{
+			x = 0;
+			y += line_height;
+		}
+		page.x.push_back(x);
+		page.y.push_back(y + 4);
+		page.width.push_back(width);
+		page.height.push_back(line_height - 8);
+		x += width + gap;
+	}
+	page.page_width = line_width;
+	page.page_height = y + line_height;
+	return page;
+}
+
+page_words_t from_table(const DF::WordTable& table, uint32_t page_width, uint32_t page_height)
+{
+	page_words_t page;
+	page.x.assign(table.getX().begin(), table.getX().end());
+	page.y.assign(table.getY().begin(), table.getY().end());
+	page.width.assign(table.getWidth().begin(), table.getWidth().end());
+	page.height.assign(table.getHeight().begin(), table.getHeight().end());
+	page.page_width = static_cast<int32_t>(std::max<uint32_t>(page_width, 1));
+	page.page_height = static_cast<int32_t>(std::max<uint32_t>(page_height, 1));
+	return page;
+}
+
+// Returns the best time over the iterations in milliseconds; `sink` keeps the result from being optimized away
+double best_ms(int iterations, const std::function<size_t()>& func, size_t& sink)
+{
+	double best = 0;
+	for (int i = 0; i < iterations; ++i)
+	{
+		auto start = clock_type::now();
+		sink += func();
+		double ms = std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+		if (i == 0 || ms < best)
+			best = ms;
+	}
+	return best;
+}
+
+void run(const options_t& options, const std::string& name, const page_words_t& page)
+{
+	size_t sink = 0;
+	std::vector<size_t> result;
+
+	DF::WordIndex index;
+	auto build = [&] {
+		index = DF::WordIndex({ page.x.data(), page.size() }, { page.y.data(), page.size() }, { page.width.data(), page.size() }, { page.height.data(), page.size() });
+		return index.size();
+	};
+	double build_ms = best_ms(options.iterations, build, sink);
+
+	// A word-sized area as for hit highlighting, a paragraph-sized area as for redaction, and a column
+	std::mt19937 rng(7);
+	auto make_rects = [&](int32_t width, int32_t height) {
+		std::vector<DF::RectI32> rects;
+		for (int i = 0; i < options.queries; ++i)
+		{
+			int32_t left = static_cast<int32_t>(rng() % static_cast<uint32_t>(std::max(page.page_width - width, 1)));
+			int32_t top = static_cast<int32_t>(rng() % static_cast<uint32_t>(std::max(page.page_height - height, 1)));
+			rects.push_back(DF::RectI32::xywh(left, top, width, height));
+		}
+		return rects;
+	};
+	std::vector<std::pair<std::string, std::vector<DF::RectI32>>> rect_sets = {
+		{ "word", make_rects(60, 24) },
+		{ "paragraph", make_rects(std::max(page.page_width / 4, 1), std::max(page.page_height / 20, 1)) },
+		{ "column", make_rects(std::max(page.page_width / 3, 1), page.page_height) },
+	};
+	std::vector<std::pair<int32_t, int32_t>> points;
+	for (int i = 0; i < options.queries; ++i)
+		points.emplace_back(static_cast<int32_t>(rng() % static_cast<uint32_t>(page.page_width)), static_cast<int32_t>(rng() % static_cast<uint32_t>(page.page_height)));
+
+	auto us_per_query = [&](double ms) { return ms * 1000.0 / options.queries; };
+	auto print = [&](const std::string& query, double current, double previous) {
+		std::cout << "  " << std::left << std::setw(10) << query << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(12) << us_per_query(current) << " us" << std::setw(12) << us_per_query(previous) << " us (scan)"
+			<< std::setw(10) << (current > 0 ? previous / current : 0.0) << "x" << std::endl;
+	};
+
+	std::cout << name << ": " << page.size() << " words, index built in " << std::fixed << std::setprecision(3) << build_ms << " ms" << std::endl;
+	for (auto&& rect_set : rect_sets)
+	{
+		auto&& rects = rect_set.second;
+		double current = best_ms(options.iterations, [&] {
+			size_t found = 0;
+			for (auto&& rect : rects)
+			{
+				index.wordsInRect(rect, result);
+				found += result.size();
+			}
+			return found;
+		}, sink);
+		double previous = best_ms(options.iterations, [&] {
+			size_t found = 0;
+			for (auto&& rect : rects)
+				found += baseline::words_in_rect(page, rect, result);
+			return found;
+		}, sink);
+		print(rect_set.first, current, previous);
+	}
+
+	double current = best_ms(options.iterations, [&] {
+		size_t found = 0;
+		for (auto&& point : points)
+			found += index.nearestWord(point.first, point.second).value_or(0);
+		return found;
+	}, sink);
+	double previous = best_ms(options.iterations, [&] {
+		size_t found = 0;
+		for (auto&& point : points)
+			found += baseline::nearest_word(page, point.first, point.second);
+		return found;
+	}, sink);
+	print("nearest", current, previous);
+
+	if (sink == 0)
+		std::cout << std::endl;
+}
+
+void run_document(DF::Api& api, const options_t& options, const std::string& filename)
+{
+	auto&& doc = api.GetExtractor(filename);
+	DocumentFiltersSamples::handle_password_prompt(doc);
+	doc.Open(DF::OpenMode::Paginated);
+
+	for (auto&& page : doc.pages())
+	{
+		auto&& table = page.getWordTable();
+		if (table.empty())
+			continue;
+		run(options, filename + " page " + std::to_string(page.getIndex() + 1), from_table(table, page.getWidth(), page.getHeight()));
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	CLI::App app("Hyland Document Filters: BenchmarkWordIndex");
+
+	try {
+		options_t options;
+
+		app.add_option("filename", options.filenames, "Documents whose pages are timed as well");
+		app.add_option("-l,--license", options.license_key, "License key for Document Filters");
+		app.add_option("-w,--words", options.word_counts, "Number of words on each generated page");
+		app.add_option("-q,--queries", options.queries, "Number of queries of each kind");
+		app.add_option("-i,--iterations", options.iterations, "Number of timed iterations per test");
+		app.parse(argc, argv);
+
+		if (options.iterations < 1 || options.queries < 1)
+			throw std::invalid_argument("iterations and queries must be positive");
+
+		for (auto count : options.word_counts)
+			run(options, "Generated", make_page(count));
+
+		if (!options.filenames.empty())
+		{
+			DF::Api api(DocumentFiltersSamples::get_license_key(options.license_key), ".");
+			for (auto&& filename : options.filenames)
+				run_document(api, options, filename);
+		}
+	}
+	catch (const CLI::ParseError& e) {
+		return app.exit(e);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
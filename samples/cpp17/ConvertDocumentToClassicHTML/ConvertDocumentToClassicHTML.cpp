@@ -41,9 +41,10 @@ void process_file(DF::Extractor& doc, const std::filesystem::path& out_filename)
 	std::cerr << " - Extracting HTML to " << out_filename << std::endl;
 
 	std::ofstream out_stream(out_filename, std::ios::binary);
+	std::string chunk;
 	while (!doc.getEOF())
 	{
-		auto chunk = DF::w_to_u8(doc.getText(chunk_size, true));
+		doc.getText(chunk, chunk_size, true);
 		out_stream.write(chunk.data(), chunk.size());
 	}
 
@@ -43,30 +43,35 @@ struct options_t
 };
 
 
-void process_file(DF::Api& api, const options_t& options, const std::filesystem::path& filename)
+// Builds the open options once; they are encoded a single time and shared by every file
+DF::OptionSet make_open_options(const options_t& options)
+{
+	DF::OptionSet result;
+	result.set(L"JSON_FORMAT_OUTPUT", options.format_json)
+		.set(L"JSON_INCLUDE_BOOKMARKS", options.include_bookmarks)
+		.set(L"JSON_INCLUDE_BOUNDS", options.include_bounds)
+		.set(L"JSON_INCLUDE_FORMS", options.include_forms)
+		.set(L"JSON_INCLUDE_IMAGEDATA", options.include_image_data)
+		.set(L"JSON_INCLUDE_IMAGES", options.include_images)
+		.set(L"JSON_INCLUDE_METADATA", options.include_metadata)
+		.set(L"JSON_INCLUDE_STYLES", options.include_styles)
+		.set(L"JSON_INCLUDE_WHITESPACE", options.include_whitespace)
+		.set(L"JSON_INCLUDE_WORDS", options.include_words);
+	return result;
+}
+
+void process_file(DF::Api& api, const options_t& options, const DF::OptionSet& open_options, const std::filesystem::path& filename)
 {
 	std::cerr << "Processing " << filename.string() << std::endl;
 	auto&& out_filename = (std::filesystem::path(options.output_dir) / (filename.filename().stem().string() + ".json")).string();
 
-	std::string optstring;
-	optstring += ";JSON_FORMAT_OUTPUT=" + std::string(options.format_json ? "on" : "off");
-	optstring += ";JSON_INCLUDE_BOOKMARKS=" + std::string(options.include_bookmarks ? "on" : "off");
-	optstring += ";JSON_INCLUDE_BOUNDS=" + std::string(options.include_bounds ? "on" : "off");
-	optstring += ";JSON_INCLUDE_FORMS=" + std::string(options.include_forms ? "on" : "off");
-	optstring += ";JSON_INCLUDE_IMAGEDATA=" + std::string(options.include_image_data ? "on" : "off");
-	optstring += ";JSON_INCLUDE_IMAGES=" + std::string(options.include_images ? "on" : "off");
-	optstring += ";JSON_INCLUDE_METADATA=" + std::string(options.include_metadata ? "on" : "off");
-	optstring += ";JSON_INCLUDE_STYLES=" + std::string(options.include_styles ? "on" : "off");
-	optstring += ";JSON_INCLUDE_WHITESPACE=" + std::string(options.include_whitespace ? "on" : "off");
-	optstring += ";JSON_INCLUDE_WORDS=" + std::string(options.include_words ? "on" : "off");
-
 	auto&& doc = api.GetExtractor(filename);
 
 	// Setup a password prompt handler...
 	DocumentFiltersSamples::handle_password_prompt(doc);
 
 	// Open the document...
-	doc.Open(DF::OpenMode::Paginated, IGR_BODY_AND_META, DF::u8_to_w(optstring));
+	doc.Open(DF::OpenMode::Paginated, IGR_BODY_AND_META, open_options);
 
 	// Create the output canvas...
 	auto&& canvas = api.MakeOutputCanvas(out_filename, DF::CanvasType::JSON);
@@ -103,9 +108,10 @@ int main(int argc, char* argv[])
 		app.parse(argc, argv);
 
 		DF::Api api(DocumentFiltersSamples::get_license_key(options.license_key), ".");
+		auto open_options = make_open_options(options);
 
 		for (auto&& filename : options.filenames)
-			process_file(api, options, filename);
+			process_file(api, options, open_options, filename);
 	}
 	catch (const CLI::ParseError& e) {
 		return app.exit(e);
@@ -79,23 +79,34 @@ static const std::map<std::string, options_t::table_style_t> table_style_map{
 	{"pipe_with_html", options_t::table_style_t::pipe_with_html},
 };
 
-void process_file(DF::Api& api, const options_t& options, const std::filesystem::path& filename)
+template <typename T>
+std::wstring name_of(const std::map<std::string, T>& map, T value)
 {
-	std::cerr << "Processing " << filename.string() << std::endl;
-	auto&& out_filename = (std::filesystem::path(options.output_dir) / (filename.filename().stem().string() + ".md")).string();
+	return DF::u8_to_w(std::find_if(map.begin(), map.end(), [&](const auto& p) { return p.second == value; })->first);
+}
 
-	std::string optstring;
+// Builds the open options once; they are encoded a single time and shared by every file
+DF::OptionSet make_open_options(const options_t& options)
+{
+	DF::OptionSet result;
 	if (options.metadata_format != options_t::metadata_format_t::none)
-		optstring += ";MARKDOWN_INCLUDE_METADATA=on";
-	optstring += ";MARKDOWN_METADATA_FORMAT=" + std::find_if(metadata_format_map.begin(), metadata_format_map.end(), [&](const auto& p) { return p.second == options.metadata_format; })->first;
-	optstring += ";MARKDOWN_HEADERS_STYLE=" + std::find_if(heading_style_map.begin(), heading_style_map.end(), [&](const auto& p) { return p.second == options.heading_style; })->first;
-	optstring += ";MARKDOWN_SIMPLE_TABLE_STYLE=" + std::find_if(table_style_map.begin(), table_style_map.end(), [&](const auto& p) { return p.second == options.simple_table_style; })->first;
-	optstring += ";MARKDOWN_COMPLEX_TABLE_STYLE=" + std::find_if(table_style_map.begin(), table_style_map.end(), [&](const auto& p) { return p.second == options.complex_table_style; })->first;
-	optstring += options.include_images ? ";MARKDOWN_INCLUDE_IMAGES=on" : ";MARKDOWN_INCLUDE_IMAGES=off";
-	optstring += options.include_fields ? ";MARKDOWN_INCLUDE_FIELDS=on" : ";MARKDOWN_INCLUDE_FIELDS=off";
-	optstring += options.include_headers ? ";MARKDOWN_INCLUDE_HEADERS=on" : ";MARKDOWN_INCLUDE_HEADERS=off";
-	optstring += options.include_footers ? ";MARKDOWN_INCLUDE_FOOTERS=on" : ";MARKDOWN_INCLUDE_FOOTERS=off";
-	optstring += options.include_bookmarks ? ";MARKDOWN_INCLUDE_BOOKMARKS=on" : ";MARKDOWN_INCLUDE_BOOKMARKS=off";
+		result.set(L"MARKDOWN_INCLUDE_METADATA", true);
+	result.set(L"MARKDOWN_METADATA_FORMAT", name_of(metadata_format_map, options.metadata_format))
+		.set(L"MARKDOWN_HEADERS_STYLE", name_of(heading_style_map, options.heading_style))
+		.set(L"MARKDOWN_SIMPLE_TABLE_STYLE", name_of(table_style_map, options.simple_table_style))
+		.set(L"MARKDOWN_COMPLEX_TABLE_STYLE", name_of(table_style_map, options.complex_table_style))
+		.set(L"MARKDOWN_INCLUDE_IMAGES", options.include_images)
+		.set(L"MARKDOWN_INCLUDE_FIELDS", options.include_fields)
+		.set(L"MARKDOWN_INCLUDE_HEADERS", options.include_headers)
+		.set(L"MARKDOWN_INCLUDE_FOOTERS", options.include_footers)
+		.set(L"MARKDOWN_INCLUDE_BOOKMARKS", options.include_bookmarks);
+	return result;
+}
+
+void process_file(DF::Api& api, const options_t& options, const DF::OptionSet& open_options, const std::filesystem::path& filename)
+{
+	std::cerr << "Processing " << filename.string() << std::endl;
+	auto&& out_filename = (std::filesystem::path(options.output_dir) / (filename.filename().stem().string() + ".md")).string();
 
 	auto&& doc = api.GetExtractor(filename);
 
@@ -103,7 +114,7 @@ void process_file(DF::Api& api, const options_t& options, const std::filesystem:
 	DocumentFiltersSamples::handle_password_prompt(doc);
 
 	// Open the document...
-	doc.Open(DF::OpenMode::Paginated, IGR_BODY_AND_META, DF::u8_to_w(optstring));
+	doc.Open(DF::OpenMode::Paginated, IGR_BODY_AND_META, open_options);
 
 	// Create the output canvas...
 	auto&& canvas = api.MakeOutputCanvas(out_filename, DF::CanvasType::MARKDOWN);
@@ -154,9 +165,10 @@ int main(int argc, char* argv[])
 		app.parse(argc, argv);
 
 		DF::Api api(DocumentFiltersSamples::get_license_key(options.license_key), ".");
+		auto open_options = make_open_options(options);
 
 		for (auto&& filename : options.filenames)
-			process_file(api, options, filename);
+			process_file(api, options, open_options, filename);
 	}
 	catch (const CLI::ParseError& e) {
 		return app.exit(e);
@@ -21,6 +21,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <DocumentFiltersSamples.h>
 #include <CLI/CLI.hpp>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 
 namespace DF = Hyland::DocFilters;
@@ -44,7 +45,8 @@ void process_file(DF::Api& api, const options_t& options, const std::filesystem:
 	// Open the document...
 	doc.Open(DF::OpenMode::Paginated);
 
-	DF::VectorStream stream;
+	// A segmented stream grows without reallocating, which matters for large multi-page output
+	DF::SegmentedStream stream;
 
 	DF::Canvas canvas = api.MakeOutputCanvas(stream, DF::CanvasType::TIF);
 	for (auto&& page : doc.pages())
@@ -53,8 +55,13 @@ void process_file(DF::Api& api, const options_t& options, const std::filesystem:
 	}
 	canvas.Close();
 
-	// stream is now populated with the TIFF data
-	std::cerr << stream.size() << " bytes written";
+	// stream is now populated with the TIFF data, write it out segment by segment
+	auto output = std::filesystem::path(options.output_dir) / filename.filename().replace_extension(".tif");
+	std::ofstream dest(output, std::ios::binary | std::ios::out);
+	for (auto&& segment : stream.getSegments())
+		dest.write(reinterpret_cast<const char*>(segment.data), static_cast<std::streamsize>(segment.size));
+
+	std::cerr << stream.size() << " bytes written to " << output.string() << std::endl;
 }
 
 int main(int argc, char* argv[])
@@ -45,9 +45,10 @@ void process_file(DF::Extractor& doc, const options_t& options, std::ostream& de
 	doc.Open(DF::OpenMode::Text, IGR_BODY_AND_META, L"OCR=ON;OCR_REORIENT_PAGES=ON");
 
 	// Extract the text...
+	std::string chunk;
 	while (!doc.getEOF())
 	{
-		auto chunk = DF::w_to_u8(doc.getText(chunk_size, !options.keep_control_codes));
+		doc.getText(chunk, chunk_size, !options.keep_control_codes);
 		dest.write(chunk.data(), chunk.size());
 	}
 
@@ -90,36 +90,8 @@ namespace DocumentFiltersSamples
 
     Hyland::DocFilters::CanvasType extension_to_canvas(std::string ext)
     {
-        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-        if (ext == ".pdf") return Hyland::DocFilters::CanvasType::PDF;
-        if (ext == ".ps") return Hyland::DocFilters::CanvasType::PS;
-        if (ext == ".tif" || ext == ".tiff") return Hyland::DocFilters::CanvasType::TIF;
-        if (ext == ".xml") return Hyland::DocFilters::CanvasType::XML;
-        if (ext == ".html" || ext == ".htm") return Hyland::DocFilters::CanvasType::HTML;
-        if (ext == ".bmp") return Hyland::DocFilters::CanvasType::BMP;
-        if (ext == ".brk") return Hyland::DocFilters::CanvasType::BRK;
-        if (ext == ".dcx") return Hyland::DocFilters::CanvasType::DCX;
-        if (ext == ".eps") return Hyland::DocFilters::CanvasType::EPS;
-        if (ext == ".gif") return Hyland::DocFilters::CanvasType::GIF;
-        if (ext == ".html") return Hyland::DocFilters::CanvasType::HTML;
-        if (ext == ".jpk") return Hyland::DocFilters::CanvasType::JPEG2000;
-        if (ext == ".jpg" || ext == ".jpeg") return Hyland::DocFilters::CanvasType::JPG;
-        if (ext == ".json") return Hyland::DocFilters::CanvasType::JSON;
-        if (ext == ".markdown" || ext == ".md") return Hyland::DocFilters::CanvasType::MARKDOWN;
-        if (ext == ".pbm") return Hyland::DocFilters::CanvasType::PBM;
-        if (ext == ".pcx") return Hyland::DocFilters::CanvasType::PCX;
-        if (ext == ".pdf") return Hyland::DocFilters::CanvasType::PDF;
-        if (ext == ".pgm") return Hyland::DocFilters::CanvasType::PGM;
-        if (ext == ".png") return Hyland::DocFilters::CanvasType::PNG;
-        if (ext == ".ppm") return Hyland::DocFilters::CanvasType::PPM;
-        if (ext == ".ps") return Hyland::DocFilters::CanvasType::PS;
-        if (ext == ".svg") return Hyland::DocFilters::CanvasType::SVG;
-        if (ext == ".tga") return Hyland::DocFilters::CanvasType::TGA;
-        if (ext == ".tif") return Hyland::DocFilters::CanvasType::TIF;
-        if (ext == ".webp") return Hyland::DocFilters::CanvasType::WEBP;
-        if (ext == ".websafe") return Hyland::DocFilters::CanvasType::WEBSAFE;
-        if (ext == ".xml") return Hyland::DocFilters::CanvasType::XML;
-        if (ext == ".xps") return Hyland::DocFilters::CanvasType::XPS;
+        if (auto type = Hyland::DocFilters::Registry::findCanvasType(ext))
+            return *type;
 
         throw std::invalid_argument("Unknown format " + ext);
     }